@@ -0,0 +1,114 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+// Cost of Buffer::update() per BufferUpdate strategy. Each operation
+// replaces a whole 256 KiB vertex buffer and draws a point from it, so that
+// the next update overlaps a draw that may still be reading the buffer. The
+// unsynchronized strategies do not wait for that draw, as their callers
+// would with a Fence, the results only measure the cost of the upload.
+//
+//   benchBufferUpdate [mesa] [null]
+
+#include "nDjinnBench.hpp"
+
+#include "nDjinnBindor.hpp"
+#include "nDjinnBuffer.hpp"
+#include "nDjinnFunctions.hpp"
+#include "nDjinnShaderProgram.hpp"
+#include "nDjinnVertexArray.hpp"
+#include "nDjinnVertexAttribArrayEnabler.hpp"
+
+namespace {
+
+char const* const VERTEX_SOURCE =
+  "#version 430 core\n"
+  "layout(location = 0) in vec4 position;\n"
+  "void main() { gl_Position = position; }\n";
+
+char const* const FRAGMENT_SOURCE =
+  "#version 430 core\n"
+  "out vec4 color;\n"
+  "void main() { color = vec4(1.0); }\n";
+
+struct Strategy {
+  char const* name;
+  ndj::BufferUpdate value;
+};
+
+Strategy const STRATEGIES[] = {
+  { "sub_data", ndj::BUFFER_UPDATE_SUB_DATA },
+  { "orphan", ndj::BUFFER_UPDATE_ORPHAN },
+  { "invalidate", ndj::BUFFER_UPDATE_INVALIDATE },
+  { "unsynchronized", ndj::BUFFER_UPDATE_UNSYNCHRONIZED },
+  { "flush", ndj::BUFFER_UPDATE_FLUSH }
+};
+
+void run(ndj::bench::BackendScope const& scope, ndj::bench::Report& report) {
+  using namespace ndj;
+  std::size_t const iterations = 2000;
+  std::size_t const vertexCount = 256 * 1024 / (4 * sizeof(GLfloat));
+  GLsizeiptr const size = vertexCount * 4 * sizeof(GLfloat);
+  bench::Backend const backend = scope.backend();
+
+  // Two sets of vertices, alternated so that every update changes the
+  // contents.
+  std::vector<GLfloat> vertices[2] = {
+    std::vector<GLfloat>(vertexCount * 4, 0.f),
+    std::vector<GLfloat>(vertexCount * 4, 0.5f)
+  };
+
+  VertexShader vs(VERTEX_SOURCE);
+  FragmentShader fs(FRAGMENT_SOURCE);
+  ShaderProgram program(vs, fs);
+  VertexArray vertexArray;
+  ArrayBuffer buffer(size, &vertices[0][0], GL_STREAM_DRAW);
+  GLuint const handle = buffer.handle();
+
+  Bindor<ShaderProgram> const programBindor(program);
+  Bindor<VertexArray> const vertexArrayBindor(vertexArray);
+  {
+    Bindor<ArrayBuffer> const bufferBindor(buffer);
+    vertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, nullptr);
+  }
+  VertexAttribArrayEnabler const enabler(0);
+
+  report.add(backend, "update256KiB", "raw", iterations,
+    bench::measure(scope, [&](std::size_t const i) {
+      bench::raw().NamedBufferSubDataEXT(handle, 0, size,
+                                         &vertices[i % 2][0]);
+      bench::raw().DrawArrays(GL_POINTS, 0, 1);
+    }, iterations));
+  for (std::size_t s = 0; s < sizeof(STRATEGIES) / sizeof(Strategy); ++s) {
+    BufferUpdate const strategy = STRATEGIES[s].value;
+    report.add(backend, "update256KiB", STRATEGIES[s].name, iterations,
+      bench::measure(scope, [&](std::size_t const i) {
+        buffer.update(0, size, &vertices[i % 2][0], strategy);
+        drawArrays(GL_POINTS, 0, 1);
+      }, iterations));
+    syncError(STRATEGIES[s].name);
+  }
+}
+
+} // Namespace.
+
+int main(int argc, char** argv) {
+  try {
+    std::vector<ndj::bench::Backend> const backends =
+      ndj::bench::parseBackends(argc, argv);
+    ndj::bench::Report report("buffer_update");
+    for (std::size_t i = 0; i < backends.size(); ++i) {
+      ndj::bench::BackendScope const scope(backends[i]);
+      run(scope, report);
+    }
+    std::cout << report.json();
+  }
+  catch (ndj::Exception const& ex) {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,108 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+// Per-call cost of the error checking policy. Built once per policy, see
+// CMakeLists.txt, each binary reports its own policy as the variant next to
+// raw calls through the same dispatch table.
+//
+//   benchErrorCheckAlways [mesa] [null]
+
+#include "nDjinnBench.hpp"
+
+#include "nDjinnBuffer.hpp"
+#include "nDjinnError.hpp"
+#include "nDjinnShaderProgram.hpp"
+
+namespace {
+
+char const* policyName() {
+#if NDJINN_ERROR_CHECK == NDJINN_ERROR_CHECK_ALWAYS
+  return "always";
+#elif NDJINN_ERROR_CHECK == NDJINN_ERROR_CHECK_SYNC
+  return "sync";
+#elif NDJINN_ERROR_CHECK == NDJINN_ERROR_CHECK_NEVER
+  return "never";
+#else
+  return "debug_output";
+#endif
+}
+
+char const* const VERTEX_SOURCE =
+  "#version 430 core\n"
+  "layout(location = 0) uniform float u;\n"
+  "void main() { gl_Position = vec4(u); }\n";
+
+char const* const FRAGMENT_SOURCE =
+  "#version 430 core\n"
+  "out vec4 color;\n"
+  "void main() { color = vec4(1.0); }\n";
+
+void run(ndj::bench::BackendScope const& scope, ndj::bench::Report& report) {
+  using namespace ndj;
+  std::size_t const iterations = 200000;
+  bench::Backend const backend = scope.backend();
+  char const* const policy = policyName();
+
+  ArrayBuffer buffer(64, nullptr, GL_DYNAMIC_DRAW);
+  GLuint const handle = buffer.handle();
+  report.add(backend, "isBuffer", "raw", iterations,
+    bench::measure(scope, [&](std::size_t) {
+      bench::raw().IsBuffer(handle);
+    }, iterations));
+  report.add(backend, "isBuffer", policy, iterations,
+    bench::measure(scope, [&](std::size_t) {
+      detail::isBuffer(handle);
+    }, iterations));
+  syncError("isBuffer");
+
+  VertexShader vs(VERTEX_SOURCE);
+  FragmentShader fs(FRAGMENT_SOURCE);
+  ShaderProgram program(vs, fs);
+  GLuint const programHandle = program.handle();
+  report.add(backend, "programUniform1f", "raw", iterations,
+    bench::measure(scope, [&](std::size_t const i) {
+      bench::raw().ProgramUniform1f(programHandle, 0,
+                                    static_cast<GLfloat>(i));
+    }, iterations));
+  report.add(backend, "programUniform1f", policy, iterations,
+    bench::measure(scope, [&](std::size_t const i) {
+      detail::programUniform1<GLfloat>(programHandle, 0,
+                                       static_cast<GLfloat>(i));
+    }, iterations));
+  syncError("programUniform1f");
+
+  GLfloat const data[4] = { 1.f, 2.f, 3.f, 4.f };
+  report.add(backend, "namedBufferSubData16", "raw", iterations,
+    bench::measure(scope, [&](std::size_t const i) {
+      bench::raw().NamedBufferSubDataEXT(handle, (i % 4) * 16, 16, data);
+    }, iterations));
+  report.add(backend, "namedBufferSubData16", policy, iterations,
+    bench::measure(scope, [&](std::size_t const i) {
+      detail::namedBufferSubData(handle, (i % 4) * 16, 16, data);
+    }, iterations));
+  syncError("namedBufferSubData16");
+}
+
+} // Namespace.
+
+int main(int argc, char** argv) {
+  try {
+    std::vector<ndj::bench::Backend> const backends =
+      ndj::bench::parseBackends(argc, argv);
+    ndj::bench::Report report("error_check");
+    for (std::size_t i = 0; i < backends.size(); ++i) {
+      ndj::bench::BackendScope const scope(backends[i]);
+      run(scope, report);
+    }
+    std::cout << report.json();
+  }
+  catch (ndj::Exception const& ex) {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
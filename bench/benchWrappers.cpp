@@ -0,0 +1,262 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+// Per-call cost of the wrappers on the hot paths, each case next to the
+// equivalent raw calls through the same dispatch table. Binding cases are
+// also run with a StateCache current ("ndj_cached"), where redundant calls
+// are skipped.
+//
+//   benchWrappers [mesa] [null]
+
+#include "nDjinnBench.hpp"
+
+#include "nDjinnBindor.hpp"
+#include "nDjinnBuffer.hpp"
+#include "nDjinnEnabler.hpp"
+#include "nDjinnFramebuffer.hpp"
+#include "nDjinnRenderbuffer.hpp"
+#include "nDjinnShaderProgram.hpp"
+#include "nDjinnStateCache.hpp"
+#include "nDjinnTexture2D.hpp"
+
+namespace {
+
+char const* const VERTEX_SOURCE =
+  "#version 430 core\n"
+  "uniform vec4 u;\n"
+  "void main() { gl_Position = u; }\n";
+
+char const* const FRAGMENT_SOURCE =
+  "#version 430 core\n"
+  "out vec4 color;\n"
+  "void main() { color = vec4(1.0); }\n";
+
+//! Makes a StateCache current for its life-time.
+class CacheScope {
+public:
+  CacheScope()
+    : _previous(ndj::StateCache::setCurrent(&_cache))
+  {}
+
+  ~CacheScope() {
+    ndj::StateCache::setCurrent(_previous);
+  }
+
+private:
+  CacheScope(CacheScope const&); //!< Disabled copy.
+  CacheScope& operator=(CacheScope const&); //!< Disabled assign.
+
+  ndj::StateCache _cache;
+  ndj::StateCache* _previous;
+};
+
+void benchUniforms(ndj::bench::BackendScope const& scope,
+                   ndj::bench::Report& report) {
+  using namespace ndj;
+  std::size_t const iterations = 200000;
+  bench::Backend const backend = scope.backend();
+
+  VertexShader vs(VERTEX_SOURCE);
+  FragmentShader fs(FRAGMENT_SOURCE);
+  ShaderProgram program(vs, fs);
+  GLuint const handle = program.handle();
+  // The null backend reflects no uniforms, location -1 is ignored by
+  // OpenGL.
+  Uniform const* const found = program.queryActiveUniform("u");
+  Uniform uniform = Uniform();
+  uniform.location = -1;
+  if (found != nullptr) {
+    uniform = *found;
+  }
+  GLint const location = uniform.location;
+
+  report.add(backend, "setUniform4", "raw", iterations,
+    bench::measure(scope, [&](std::size_t const i) {
+      GLfloat const v = static_cast<GLfloat>(i);
+      bench::raw().ProgramUniform4f(handle, location, v, v, v, 1.f);
+    }, iterations));
+  report.add(backend, "setUniform4", "ndj", iterations,
+    bench::measure(scope, [&](std::size_t const i) {
+      GLfloat const v = static_cast<GLfloat>(i);
+      program.setUniform4<GLfloat>(uniform, v, v, v, 1.f);
+    }, iterations));
+  syncError("setUniform4");
+}
+
+void benchBuffers(ndj::bench::BackendScope const& scope,
+                  ndj::bench::Report& report) {
+  using namespace ndj;
+  std::size_t const iterations = 100000;
+  bench::Backend const backend = scope.backend();
+
+  GLfloat const data[16] = {};
+  ArrayBuffer buffer(1024, nullptr, GL_DYNAMIC_DRAW);
+  GLuint const handle = buffer.handle();
+
+  report.add(backend, "setSubData64", "raw", iterations,
+    bench::measure(scope, [&](std::size_t const i) {
+      bench::raw().NamedBufferSubDataEXT(handle, (i % 16) * 64, 64, data);
+    }, iterations));
+  report.add(backend, "setSubData64", "ndj", iterations,
+    bench::measure(scope, [&](std::size_t const i) {
+      buffer.setSubData((i % 16) * 64, 64, data);
+    }, iterations));
+  syncError("setSubData64");
+
+  report.add(backend, "mapUnmap", "raw", iterations,
+    bench::measure(scope, [&](std::size_t const i) {
+      GLfloat* const ptr = static_cast<GLfloat*>(
+        bench::raw().MapNamedBufferEXT(handle, GL_WRITE_ONLY));
+      ptr[i % 256] = 1.f;
+      bench::raw().UnmapNamedBufferEXT(handle);
+    }, iterations));
+  report.add(backend, "mapUnmap", "ndj", iterations,
+    bench::measure(scope, [&](std::size_t const i) {
+      GLfloat* const ptr = buffer.map<GLfloat>(GL_WRITE_ONLY);
+      ptr[i % 256] = 1.f;
+      buffer.unmap();
+    }, iterations));
+  syncError("mapUnmap");
+}
+
+void benchTextures(ndj::bench::BackendScope const& scope,
+                   ndj::bench::Report& report) {
+  using namespace ndj;
+  std::size_t const iterations = 20000;
+  bench::Backend const backend = scope.backend();
+
+  std::vector<GLubyte> const pixels(16 * 16 * 4, 255);
+  Texture2D texture(GL_TEXTURE_2D, 64, 64);
+  GLuint const handle = texture.handle();
+
+  report.add(backend, "setSubImage16x16", "raw", iterations,
+    bench::measure(scope, [&](std::size_t const i) {
+      GLint const x = static_cast<GLint>(i % 4) * 16;
+      bench::raw().TextureSubImage2DEXT(handle, GL_TEXTURE_2D, 0, x, x,
+                                        16, 16, GL_RGBA, GL_UNSIGNED_BYTE,
+                                        &pixels[0]);
+    }, iterations));
+  report.add(backend, "setSubImage16x16", "ndj", iterations,
+    bench::measure(scope, [&](std::size_t const i) {
+      GLint const x = static_cast<GLint>(i % 4) * 16;
+      texture.setSubImage(GL_TEXTURE_2D, 0, x, x, 16, 16,
+                          GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+    }, iterations));
+  syncError("setSubImage16x16");
+}
+
+void benchBindings(ndj::bench::BackendScope const& scope,
+                   ndj::bench::Report& report) {
+  using namespace ndj;
+  std::size_t const iterations = 200000;
+  bench::Backend const backend = scope.backend();
+
+  ArrayBuffer buffer(64, nullptr, GL_STATIC_DRAW);
+  GLuint const bufferHandle = buffer.handle();
+  report.add(backend, "bindor", "raw", iterations,
+    bench::measure(scope, [&](std::size_t) {
+      bench::raw().BindBuffer(GL_ARRAY_BUFFER, bufferHandle);
+      bench::raw().BindBuffer(GL_ARRAY_BUFFER, 0);
+    }, iterations));
+  report.add(backend, "bindor", "ndj", iterations,
+    bench::measure(scope, [&](std::size_t) {
+      Bindor<ArrayBuffer> const bindor(buffer);
+    }, iterations));
+  {
+    CacheScope const cache;
+    report.add(backend, "bindor", "ndj_cached", iterations,
+      bench::measure(scope, [&](std::size_t) {
+        Bindor<ArrayBuffer> const bindor(buffer);
+      }, iterations));
+  }
+  syncError("bindor");
+
+  report.add(backend, "enabler", "raw", iterations,
+    bench::measure(scope, [&](std::size_t) {
+      bench::raw().Enable(GL_BLEND);
+      bench::raw().Disable(GL_BLEND);
+    }, iterations));
+  report.add(backend, "enabler", "ndj", iterations,
+    bench::measure(scope, [&](std::size_t) {
+      Enabler const enabler(GL_BLEND);
+    }, iterations));
+  {
+    CacheScope const cache;
+    report.add(backend, "enabler", "ndj_cached", iterations,
+      bench::measure(scope, [&](std::size_t) {
+        Enabler const enabler(GL_BLEND);
+      }, iterations));
+  }
+  syncError("enabler");
+
+  Renderbuffer color0(GL_RGBA8, 16, 16);
+  Renderbuffer color1(GL_RGBA8, 16, 16);
+  Framebuffer framebuffers[2];
+  framebuffers[0].attachRenderbuffer(GL_COLOR_ATTACHMENT0, color0.handle());
+  framebuffers[1].attachRenderbuffer(GL_COLOR_ATTACHMENT0, color1.handle());
+  GLuint const handles[2] =
+    { framebuffers[0].handle(), framebuffers[1].handle() };
+
+  // Alternating between two framebuffers, every bind changes state.
+  report.add(backend, "framebufferBind", "raw", iterations,
+    bench::measure(scope, [&](std::size_t const i) {
+      bench::raw().BindFramebuffer(GL_FRAMEBUFFER, handles[i % 2]);
+    }, iterations));
+  report.add(backend, "framebufferBind", "ndj", iterations,
+    bench::measure(scope, [&](std::size_t const i) {
+      framebuffers[i % 2].bind(GL_FRAMEBUFFER);
+    }, iterations));
+  {
+    CacheScope const cache;
+    report.add(backend, "framebufferBind", "ndj_cached", iterations,
+      bench::measure(scope, [&](std::size_t const i) {
+        framebuffers[i % 2].bind(GL_FRAMEBUFFER);
+      }, iterations));
+  }
+
+  // Binding the same framebuffer again, e.g. once per draw.
+  report.add(backend, "framebufferRebind", "raw", iterations,
+    bench::measure(scope, [&](std::size_t) {
+      bench::raw().BindFramebuffer(GL_FRAMEBUFFER, handles[0]);
+    }, iterations));
+  report.add(backend, "framebufferRebind", "ndj", iterations,
+    bench::measure(scope, [&](std::size_t) {
+      framebuffers[0].bind(GL_FRAMEBUFFER);
+    }, iterations));
+  {
+    CacheScope const cache;
+    report.add(backend, "framebufferRebind", "ndj_cached", iterations,
+      bench::measure(scope, [&](std::size_t) {
+        framebuffers[0].bind(GL_FRAMEBUFFER);
+      }, iterations));
+  }
+  framebuffers[0].release(GL_FRAMEBUFFER);
+  syncError("framebufferBind");
+}
+
+} // Namespace.
+
+int main(int argc, char** argv) {
+  try {
+    std::vector<ndj::bench::Backend> const backends =
+      ndj::bench::parseBackends(argc, argv);
+    ndj::bench::Report report("wrappers");
+    for (std::size_t i = 0; i < backends.size(); ++i) {
+      ndj::bench::BackendScope const scope(backends[i]);
+      benchUniforms(scope, report);
+      benchBuffers(scope, report);
+      benchTextures(scope, report);
+      benchBindings(scope, report);
+    }
+    std::cout << report.json();
+  }
+  catch (ndj::Exception const& ex) {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,198 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+#ifndef NDJINN_BENCH_HPP_INCLUDED
+#define NDJINN_BENCH_HPP_INCLUDED
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "nDjinnDispatch.hpp"
+#include "nDjinnHeadlessContext.hpp"
+#include "nDjinnNamespace.hpp"
+
+#ifdef NDJINN_DISABLE_DISPATCH
+#error "benchmarks need the dispatch table, for the null backend"
+#endif
+
+NDJINN_BEGIN_NAMESPACE
+
+namespace bench {
+
+//! Where the measured calls go.
+enum Backend {
+  //! Mesa through a HeadlessContext, i.e. llvmpipe on machines without a
+  //! GPU.
+  BACKEND_MESA,
+  //! nullDispatch(), measures the CPU cost of the wrappers alone.
+  BACKEND_NULL
+};
+
+inline char const* backendName(Backend const backend) {
+  return backend == BACKEND_MESA ? "mesa" : "null";
+}
+
+//! Backends named on the command line, "mesa" and/or "null". Both if none
+//! are given.
+inline std::vector<Backend> parseBackends(int const argc, char** argv) {
+  std::vector<Backend> backends;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "mesa") == 0) {
+      backends.push_back(BACKEND_MESA);
+    }
+    else if (std::strcmp(argv[i], "null") == 0) {
+      backends.push_back(BACKEND_NULL);
+    }
+  }
+  if (backends.empty()) {
+    backends.push_back(BACKEND_MESA);
+    backends.push_back(BACKEND_NULL);
+  }
+  return backends;
+}
+
+//! Makes a backend current for its life-time. The Mesa backend renders to
+//! a HeadlessContext, whose state cache is disabled so that every call
+//! reaches the driver, as with raw OpenGL.
+class BackendScope {
+public:
+  explicit BackendScope(Backend const backend)
+    : _backend(backend)
+    , _previous(backend == BACKEND_NULL ? setDispatch(&nullDispatch())
+                                        : nullptr)
+  {
+    if (backend == BACKEND_MESA) {
+      _context.reset(new HeadlessContext(256, 256));
+      StateCache::setCurrent(nullptr);
+    }
+  }
+
+  ~BackendScope() {
+    _context.reset();
+    if (_backend == BACKEND_NULL) {
+      setDispatch(_previous);
+    }
+  }
+
+  Backend backend() const {
+    return _backend;
+  }
+
+  //! Wait for OpenGL to finish queued work, so that it is included in
+  //! measurements.
+  void finish() const {
+    if (_backend == BACKEND_MESA) {
+      glFinish();
+    }
+  }
+
+private:
+  BackendScope(BackendScope const&); //!< Disabled copy.
+  BackendScope& operator=(BackendScope const&); //!< Disabled assign.
+
+  Backend _backend;
+  Dispatch const* _previous;
+  std::unique_ptr<HeadlessContext> _context;
+};
+
+//! Calls through the current dispatch table without a wrapper, i.e. raw
+//! OpenGL on the Mesa backend. Used as the baseline for each case.
+inline Dispatch const& raw() {
+  return detail::dispatch();
+}
+
+//! Nanoseconds per call of @a op, the fastest of @a repetitions runs of
+//! @a iterations calls each. Queued OpenGL work is waited for at the end of
+//! each run.
+template <typename Op>
+double measure(BackendScope const& scope, Op op,
+               std::size_t const iterations,
+               std::size_t const repetitions = 5) {
+  for (std::size_t i = 0; i < iterations / 10 + 1; ++i) {
+    op(i);
+  }
+  scope.finish();
+
+  double best = 0.0;
+  for (std::size_t r = 0; r < repetitions; ++r) {
+    std::chrono::steady_clock::time_point const begin =
+      std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+      op(i);
+    }
+    scope.finish();
+    double const ns = std::chrono::duration<double, std::nano>(
+      std::chrono::steady_clock::now() - begin).count() / iterations;
+    best = r == 0 ? ns : std::min(best, ns);
+  }
+  return best;
+}
+
+//! Results of a benchmark program, written as a JSON array with one object
+//! per case and variant.
+class Report {
+public:
+  explicit Report(std::string const& suite)
+    : _suite(suite)
+  {}
+
+  void add(Backend const backend,
+           std::string const& name,
+           std::string const& variant,
+           std::size_t const iterations,
+           double const nsPerOp) {
+    Result const result =
+      { backendName(backend), name, variant, iterations, nsPerOp };
+    _results.push_back(result);
+  }
+
+  std::string json() const {
+    std::stringstream ss;
+    ss << "[";
+    for (std::size_t i = 0; i < _results.size(); ++i) {
+      Result const& result = _results[i];
+      ss << (i > 0 ? ",\n " : "")
+         << "{\"suite\": \"" << _suite << "\""
+         << ", \"backend\": \"" << result.backend << "\""
+         << ", \"case\": \"" << result.name << "\""
+         << ", \"variant\": \"" << result.variant << "\""
+         << ", \"iterations\": " << result.iterations
+         << ", \"ns_per_op\": " << result.nsPerOp << "}";
+    }
+    ss << "]\n";
+    return ss.str();
+  }
+
+private:
+  struct Result {
+    std::string backend;
+    std::string name;
+    std::string variant;
+    std::size_t iterations;
+    double nsPerOp;
+  };
+
+  std::string _suite;
+  std::vector<Result> _results;
+};
+
+} // Namespace: bench.
+
+NDJINN_END_NAMESPACE
+
+#endif // NDJINN_BENCH_HPP_INCLUDED
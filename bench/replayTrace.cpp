@@ -0,0 +1,46 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+// Replays a trace written by TraceDispatch against Mesa and prints the time
+// spent per entry point. Names are not remapped, and the HeadlessContext
+// generates a framebuffer and two renderbuffers before the replay starts,
+// so traces are best recorded on a HeadlessContext as well.
+//
+//   replayTrace <trace> [width height]
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "nDjinnHeadlessContext.hpp"
+#include "nDjinnTrace.hpp"
+
+int main(int argc, char** argv) {
+  if (argc != 2 && argc != 4) {
+    std::cerr << "usage: " << argv[0] << " <trace> [width height]"
+              << std::endl;
+    return 2;
+  }
+  try {
+    GLsizei const width = argc == 4 ? std::atoi(argv[2]) : 256;
+    GLsizei const height = argc == 4 ? std::atoi(argv[3]) : 256;
+    std::vector<unsigned char> const trace = ndj::loadTrace(argv[1]);
+    ndj::HeadlessContext const context(width, height);
+    ndj::ReplayReport const report = ndj::replayTrace(trace);
+    glFinish();
+    std::cout << report;
+  }
+  catch (ndj::Exception const& ex) {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -8,25 +8,40 @@
 #ifndef NDJINN_HPP_INCLUDED
 #define NDJINN_HPP_INCLUDED
 
+#include "nDjinnAsyncReadback.hpp"
 #include "nDjinnBindor.hpp"
 #include "nDjinnBuffer.hpp"
+#include "nDjinnBufferArena.hpp"
 #include "nDjinnCamera.hpp"
+#include "nDjinnDebug.hpp"
+#include "nDjinnDeletionQueue.hpp"
 #include "nDjinnDisabler.hpp"
+#include "nDjinnDispatch.hpp"
+#include "nDjinnDrawQueue.hpp"
 #include "nDjinnEnabler.hpp"
 #include "nDjinnError.hpp"
 #include "nDjinnException.hpp"
 #include "nDjinnFramebuffer.hpp"
 #include "nDjinnFunctions.hpp"
 #include "nDjinnGLTypeEnum.hpp"
+#include "nDjinnHandlePool.hpp"
+#include "nDjinnPackedBlock.hpp"
+#include "nDjinnPipelineState.hpp"
 #include "nDjinnQuery.hpp"
-#include "nDjinnRenderBuffer.hpp"
+#include "nDjinnRenderbuffer.hpp"
 #include "nDjinnSampler.hpp"
 #include "nDjinnShader.hpp"
 #include "nDjinnShaderProgram.hpp"
+#include "nDjinnStateCache.hpp"
+#include "nDjinnStats.hpp"
+#include "nDjinnStreamBuffer.hpp"
+#include "nDjinnSync.hpp"
 #include "nDjinnTexture.hpp"
 #include "nDjinnTexture1D.hpp"
 #include "nDjinnTexture2D.hpp"
 #include "nDjinnTexture3D.hpp"
+#include "nDjinnTrace.hpp"
+#include "nDjinnTypedBuffer.hpp"
 #include "nDjinnVertexArray.hpp"
 #include "nDjinnVertexAttribArrayEnabler.hpp"
 #include "nDjinnVertexAttribType.hpp"
@@ -0,0 +1,195 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+#ifndef NDJINN_ASYNC_READBACK_HPP_INCLUDED
+#define NDJINN_ASYNC_READBACK_HPP_INCLUDED
+
+#include <cstddef>
+#include <vector>
+
+#include "nDjinnBuffer.hpp"
+#include "nDjinnBufferArena.hpp"
+#include "nDjinnException.hpp"
+#include "nDjinnGL.hpp"
+#include "nDjinnNamespace.hpp"
+#include "nDjinnSync.hpp"
+
+NDJINN_BEGIN_NAMESPACE
+
+//! Reads buffer contents back without stalling. read() copies a range into
+//! a persistently mapped staging buffer on the GPU and fences the copy.
+//! The result can be polled with ready() and is read straight from the
+//! mapping, typically a frame or two later, at which point wait() does not
+//! block. Staging memory is held until release().
+class AsyncReadback {
+public:
+  typedef std::size_t Id;
+
+  //! CTOR. Allocate @a capacity bytes of staging memory, shared by all
+  //! pending reads. Throws if @a alignment is not positive. May throw.
+  explicit AsyncReadback(GLsizeiptr const capacity,
+                         GLsizeiptr const alignment = 64)
+    : _staging(checkedCapacity(capacity, alignment), nullptr,
+               ImmutableStorage(FLAGS))
+    , _data(static_cast<unsigned char const*>(detail::mapNamedBufferRange(
+        _staging.handle(), 0, capacity, FLAGS)))
+    , _alignment(alignment)
+    , _allocator(static_cast<std::size_t>(capacity / alignment))
+  {
+    if (_data == nullptr) {
+      NDJINN_THROW("could not map readback buffer: " << _staging.handle());
+    }
+  }
+
+  //! DTOR
+  ~AsyncReadback() {
+    for (std::size_t id = 0; id < _reads.size(); ++id) {
+      if (_reads[id].fence != nullptr) {
+        detail::deleteSync(_reads[id].fence);
+      }
+    }
+    _staging.unmap();
+  }
+
+  //! Start reading @a size bytes at @a offset of @a buffer. Throws if
+  //! @a size is not positive or the staging memory is full.
+  Id read(GLuint const buffer, GLintptr const offset, GLsizeiptr const size) {
+    if (size <= 0) {
+      NDJINN_THROW("invalid readback size: " << size);
+    }
+    std::size_t const units =
+      static_cast<std::size_t>((size + _alignment - 1) / _alignment);
+    std::size_t const unit = _allocator.allocate(units);
+    if (unit == detail::TlsfAllocator::NONE) {
+      NDJINN_THROW("readback staging memory full: " << size
+                   << " bytes requested");
+    }
+    GLintptr const stagingOffset = static_cast<GLintptr>(unit) * _alignment;
+    GLsync fence = nullptr;
+    try {
+      detail::namedCopyBufferSubData(buffer, _staging.handle(), offset,
+                                     stagingOffset, size);
+      fence = detail::fenceSync();
+    }
+    catch (...) {
+      _allocator.free(unit);
+      throw;
+    }
+    Read const read = { fence, unit, size, true };
+
+    if (!_freeIds.empty()) {
+      Id const id = _freeIds.back();
+      _freeIds.pop_back();
+      _reads[id] = read;
+      return id;
+    }
+    _reads.push_back(read);
+    return _reads.size() - 1;
+  }
+
+  //! Convenience.
+  template <GLenum TargetT>
+  Id read(Buffer<TargetT> const& buffer, GLintptr const offset,
+          GLsizeiptr const size) {
+    return read(buffer.handle(), offset, size);
+  }
+
+  //! True if the data has arrived, never blocks. May throw.
+  bool ready(Id const id) {
+    Read& read = liveRead(id);
+    if (read.fence != nullptr && detail::waitSync(read.fence, 0)) {
+      signaled(read);
+    }
+    return read.fence == nullptr;
+  }
+
+  //! Block until the data has arrived and return it, valid until
+  //! release(). May throw.
+  void const* wait(Id const id) {
+    Read& read = liveRead(id);
+    if (read.fence != nullptr) {
+      while (!detail::waitSync(read.fence, 1000000000)) {
+      }
+      signaled(read);
+    }
+    return _data + static_cast<GLintptr>(read.unit) * _alignment;
+  }
+
+  //! Convenience.
+  template <typename E>
+  E const* wait(Id const id) {
+    return static_cast<E const*>(wait(id));
+  }
+
+  //! Number of bytes read.
+  GLsizeiptr size(Id const id) const {
+    return const_cast<AsyncReadback*>(this)->liveRead(id).size;
+  }
+
+  //! Free the staging memory of a read, the id may be reused. A read can
+  //! be released before it has arrived.
+  void release(Id const id) {
+    Read& read = liveRead(id);
+    if (read.fence != nullptr) {
+      detail::deleteSync(read.fence);
+    }
+    _allocator.free(read.unit);
+    read.fence = nullptr;
+    read.live = false;
+    _freeIds.push_back(id);
+  }
+
+  //! Number of reads not yet released.
+  std::size_t pendingCount() const {
+    return _reads.size() - _freeIds.size();
+  }
+
+private:
+  AsyncReadback(AsyncReadback const&); //!< Disabled copy.
+  AsyncReadback& operator=(AsyncReadback const&); //!< Disabled assign.
+
+  static GLbitfield const FLAGS =
+    GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+  struct Read {
+    GLsync fence; //!< Null once signaled.
+    std::size_t unit; //!< Staging offset in units of the alignment.
+    GLsizeiptr size;
+    bool live;
+  };
+
+  Read& liveRead(Id const id) {
+    if (id >= _reads.size() || !_reads[id].live) {
+      NDJINN_THROW("invalid readback: " << id);
+    }
+    return _reads[id];
+  }
+
+  static GLsizeiptr checkedCapacity(GLsizeiptr const capacity,
+                                    GLsizeiptr const alignment) {
+    if (alignment <= 0) {
+      NDJINN_THROW("invalid readback alignment: " << alignment);
+    }
+    return capacity;
+  }
+
+  static void signaled(Read& read) {
+    detail::deleteSync(read.fence);
+    read.fence = nullptr;
+  }
+
+  Buffer<GL_COPY_WRITE_BUFFER> _staging;
+  unsigned char const* const _data; //!< Persistently mapped staging memory.
+  GLsizeiptr const _alignment;
+  detail::TlsfAllocator _allocator; //!< In units of the alignment.
+  std::vector<Read> _reads; //!< By id.
+  std::vector<Id> _freeIds;
+};
+
+NDJINN_END_NAMESPACE
+
+#endif // NDJINN_ASYNC_READBACK_HPP_INCLUDED
@@ -1,6 +1,6 @@
 //------------------------------------------------------------------------------
 //
-// Contributors: 
+// Contributors:
 //             1) Tommy Hinks
 //
 //------------------------------------------------------------------------------
@@ -8,13 +8,238 @@
 #ifndef NDJINN_BINDOR_HPP_INCLUDED
 #define NDJINN_BINDOR_HPP_INCLUDED
 
+#include <iterator>
+#include <vector>
+
+#include "nDjinnBuffer.hpp"
+#include "nDjinnFramebuffer.hpp"
 #include "nDjinnGL.hpp"
 #include "nDjinnNamespace.hpp"
+#include "nDjinnRenderbuffer.hpp"
 #include "nDjinnSampler.hpp"
+#include "nDjinnShaderProgram.hpp"
+#include "nDjinnStateCache.hpp"
 #include "nDjinnTexture.hpp"
+#include "nDjinnVertexArray.hpp"
 
 NDJINN_BEGIN_NAMESPACE
 
+namespace detail {
+
+//! A place an object can be bound to, e.g. GL_ARRAY_BUFFER or texture
+//! unit 3's GL_TEXTURE_2D.
+struct BindingPoint {
+  enum Kind {
+    BUFFER,
+    FRAMEBUFFER,
+    PROGRAM,
+    RENDERBUFFER,
+    SAMPLER,
+    TEXTURE,
+    VERTEX_ARRAY
+  };
+
+  BindingPoint(Kind const kind, GLenum const target = 0, GLuint const unit = 0)
+    : kind(kind)
+    , target(target)
+    , unit(unit)
+  {}
+
+  bool operator==(BindingPoint const& rhs) const {
+    return kind == rhs.kind && target == rhs.target && unit == rhs.unit;
+  }
+
+  //! Texture unit of texture bindings made on the active unit.
+  enum : GLuint { ACTIVE_UNIT = ~0u };
+
+  Kind kind;
+  GLenum target; //!< Buffer, framebuffer or texture target.
+  GLuint unit; //!< Sampler or texture unit index, or ACTIVE_UNIT.
+};
+
+inline BindingPoint bindingPoint(ShaderProgram const&)
+{
+  return BindingPoint(BindingPoint::PROGRAM);
+}
+
+inline BindingPoint bindingPoint(Renderbuffer const&)
+{
+  return BindingPoint(BindingPoint::RENDERBUFFER, GL_RENDERBUFFER);
+}
+
+inline BindingPoint bindingPoint(VertexArray const&)
+{
+  return BindingPoint(BindingPoint::VERTEX_ARRAY);
+}
+
+template <GLenum TargetT> inline
+BindingPoint bindingPoint(Buffer<TargetT> const&)
+{
+  return BindingPoint(BindingPoint::BUFFER, TargetT);
+}
+
+//! Object bound by a Bindor that is still alive.
+struct StackedBinding {
+  BindingPoint point;
+  GLuint name;
+  void const* owner; //!< The Bindor.
+};
+
+//! Client-side stack of the bindings made by the Bindors alive on the
+//! calling thread, innermost last.
+inline std::vector<StackedBinding>& bindingStack()
+{
+  static thread_local std::vector<StackedBinding> stack;
+  return stack;
+}
+
+inline void pushBinding(BindingPoint const& point, GLuint const name,
+                        void const* owner)
+{
+  StackedBinding const binding = { point, name, owner };
+  bindingStack().push_back(binding);
+}
+
+//! Bindors normally go out of scope in reverse order, but need not.
+inline void popBinding(void const* owner)
+{
+  std::vector<StackedBinding>& stack = bindingStack();
+  for (auto iter = stack.rbegin(); iter != stack.rend(); ++iter) {
+    if (iter->owner == owner) {
+      stack.erase(std::next(iter).base());
+      return;
+    }
+  }
+}
+
+//! Sets @a name to the object currently bound to @a point, as far as known
+//! without asking OpenGL. The current StateCache knows about all bindings
+//! of the kinds it tracks, otherwise the innermost Bindor for @a point is
+//! used. Returns false if the binding is unknown, e.g. a texture or a
+//! buffer bound directly while no cache is current.
+inline bool boundName(BindingPoint const& point, GLuint& name)
+{
+  StateCache const* const cache = StateCache::current();
+  if (cache != nullptr) {
+    CachedState<GLuint> const* binding = nullptr;
+    switch (point.kind) {
+    case BindingPoint::BUFFER: {
+      auto const iter = cache->bufferBindings.find(point.target);
+      if (iter != cache->bufferBindings.end()) {
+        name = iter->second;
+        return true;
+      }
+      break;
+    }
+    case BindingPoint::FRAMEBUFFER:
+      binding = point.target == GL_READ_FRAMEBUFFER ?
+        &cache->readFramebuffer : &cache->drawFramebuffer;
+      break;
+    case BindingPoint::PROGRAM:
+      binding = &cache->program;
+      break;
+    case BindingPoint::VERTEX_ARRAY:
+      binding = &cache->vertexArray;
+      break;
+    default:
+      break;
+    }
+    if (binding != nullptr && binding->valid()) {
+      name = binding->value();
+      return true;
+    }
+  }
+
+  std::vector<StackedBinding> const& stack = bindingStack();
+  for (auto iter = stack.rbegin(); iter != stack.rend(); ++iter) {
+    if (iter->point == point) {
+      name = iter->name;
+      return true;
+    }
+  }
+  return false;
+}
+
+//! Bind @a name to @a point. May throw.
+inline void bindName(BindingPoint const& point, GLuint const name)
+{
+  switch (point.kind) {
+  case BindingPoint::BUFFER:
+    bindBuffer(point.target, name);
+    break;
+  case BindingPoint::FRAMEBUFFER:
+    bindFramebuffer(point.target, name);
+    break;
+  case BindingPoint::PROGRAM:
+    useProgram(name);
+    break;
+  case BindingPoint::RENDERBUFFER:
+    bindRenderbuffer(point.target, name);
+    break;
+  case BindingPoint::SAMPLER:
+    bindSampler(point.unit, name);
+    break;
+  case BindingPoint::TEXTURE:
+    if (point.unit == BindingPoint::ACTIVE_UNIT) {
+      bindTexture(point.target, name);
+    }
+    else {
+      bindMultiTexture(GL_TEXTURE0 + point.unit, point.target, name);
+    }
+    break;
+  case BindingPoint::VERTEX_ARRAY:
+    bindVertexArray(name);
+    break;
+  }
+}
+
+//! Remembers what was bound to a binding point and restores it when
+//! destroyed, the common part of the Bindors below. Never queries OpenGL,
+//! if the previous binding is unknown the binding point is reset to zero.
+class SavedBinding {
+public:
+  explicit SavedBinding(BindingPoint const& point)
+    : _point(point)
+    , _previous(0)
+    , _pushed(false)
+  {
+    boundName(point, _previous); // Stays zero if unknown.
+  }
+
+  ~SavedBinding()
+  {
+    if (_pushed) {
+      popBinding(this);
+      bindName(_point, _previous);
+    }
+  }
+
+  //! Call after binding @a name to the binding point.
+  void push(GLuint const name) {
+    pushBinding(_point, name, this);
+    _pushed = true;
+  }
+
+private:
+  SavedBinding(SavedBinding const&); //!< Disabled copy.
+  SavedBinding& operator=(SavedBinding const&); //!< Disabled assign.
+
+  BindingPoint const _point;
+  GLuint _previous;
+  bool _pushed;
+};
+
+} // Namespace: detail.
+
+//! Binds a resource for the life-time of the Bindor, then restores
+//! whatever was bound before, so Bindors nest. Works for buffers, vertex
+//! arrays, shader programs and renderbuffers. The previous binding is taken
+//! from the current StateCache or from enclosing Bindors, OpenGL is never
+//! queried. Objects bound directly, i.e. not through a Bindor, are only
+//! known while a StateCache is current, and renderbuffers and samplers
+//! only through enclosing Bindors. An unknown previous binding is
+//! restored as zero.
+//!
 //! Resource must not be destroyed during the life-time of a Bindor instance.
 template <class R>
 class Bindor
@@ -23,21 +248,17 @@ public:
   typedef R Resource;
 
   explicit Bindor(R const& resource)
-      : _resource(resource)
-  {
-    _resource.bind();
-  }
-
-  ~Bindor()
+    : _saved(detail::bindingPoint(resource))
   {
-    _resource.release();
+    resource.bind();
+    _saved.push(resource.handle());
   }
 
 private:
   Bindor(Bindor const&); //!< Disabled copy.
   Bindor& operator=(Bindor const&); //!< Disabled assign.
 
-  R const& _resource;
+  detail::SavedBinding _saved;
 };
 
 //! Specialization for Sampler.
@@ -46,47 +267,82 @@ class Bindor<Sampler>
 {
 public:
   Bindor(Sampler const& sampler, GLuint const unit = 0)
-    : _sampler(sampler)
-    , _unit(unit)
+    : _saved(detail::BindingPoint(detail::BindingPoint::SAMPLER, 0, unit))
   {
-    _sampler.bind(_unit);
+    sampler.bind(unit);
+    _saved.push(sampler.handle());
   }
 
-  ~Bindor()
+private:
+  Bindor(Bindor<Sampler> const&); //!< Disabled copy.
+  Bindor<Sampler>& operator=(Bindor<Sampler> const&); //!< Disabled assign.
+
+  detail::SavedBinding _saved;
+};
+
+//! Specialization for Framebuffer. Binding to GL_FRAMEBUFFER saves and
+//! restores both the draw and the read binding.
+template <>
+class Bindor<Framebuffer>
+{
+public:
+  explicit Bindor(Framebuffer const& framebuffer,
+                  GLenum const target = GL_FRAMEBUFFER)
+    : _draw(detail::BindingPoint(detail::BindingPoint::FRAMEBUFFER,
+                                 GL_DRAW_FRAMEBUFFER))
+    , _read(detail::BindingPoint(detail::BindingPoint::FRAMEBUFFER,
+                                 GL_READ_FRAMEBUFFER))
   {
-    _sampler.release(_unit);
+    framebuffer.bind(target);
+    if (target != GL_READ_FRAMEBUFFER) {
+      _draw.push(framebuffer.handle());
+    }
+    if (target != GL_DRAW_FRAMEBUFFER) {
+      _read.push(framebuffer.handle());
+    }
   }
 
 private:
-  Bindor(Bindor<Sampler> const&); //!< Disabled copy.
-  Bindor<Sampler>& operator=(Bindor<Sampler> const&); //!< Disabled assign.
+  Bindor(Bindor<Framebuffer> const&); //!< Disabled copy.
+  Bindor<Framebuffer>& operator=(Bindor<Framebuffer> const&); //!< Disabled assign.
 
-  Sampler const& _sampler;
-  GLuint const _unit;
+  detail::SavedBinding _draw;
+  detail::SavedBinding _read;
 };
 
+//! Binds a texture to @a target for the life-time of the Bindor, then
+//! restores the previous binding, see Bindor. Textures are not tracked by
+//! the StateCache, so the previous binding is only known through an
+//! enclosing TextureBindor for the same target and unit, otherwise zero
+//! is bound when the TextureBindor is destroyed.
 template <typename T>
 class TextureBindor
 {
 public:
+  //! Bind to the active texture unit, which must not change during the
+  //! life-time of the Bindor.
   TextureBindor(GLenum const target, T const& texture)
-    : _texture(texture)
-    , _target(target)
+    : _saved(detail::BindingPoint(detail::BindingPoint::TEXTURE, target,
+                                  detail::BindingPoint::ACTIVE_UNIT))
   {
-    bindTexture(_target, _texture);
+    detail::bindTexture(target, texture.handle());
+    _saved.push(texture.handle());
   }
 
-  ~TextureBindor()
+  //! Bind to texture @a unit (an index, not GL_TEXTUREi). The active
+  //! texture unit is not changed.
+  TextureBindor(GLenum const target, T const& texture, GLuint const unit)
+    : _saved(detail::BindingPoint(detail::BindingPoint::TEXTURE, target, unit))
   {
-    releaseTexture(_target);
+    detail::bindMultiTexture(GL_TEXTURE0 + unit, target, texture.handle());
+    _saved.push(texture.handle());
   }
 
 private:
   TextureBindor(TextureBindor<T> const&); //!< Disabled copy.
   TextureBindor<T>& operator=(TextureBindor<T> const&); //!< Disabled assign.
 
-  T const& _texture;
-  GLenum const _target;
+  detail::SavedBinding _saved;
 };
 
 NDJINN_END_NAMESPACE
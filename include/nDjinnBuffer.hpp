@@ -8,12 +8,19 @@
 #ifndef NDJINN_BUFFER_HPP_INCLUDED
 #define NDJINN_BUFFER_HPP_INCLUDED
 
+#include <array>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 #include <string>
 
+#include "nDjinnDeletionQueue.hpp"
+#include "nDjinnDispatch.hpp"
 #include "nDjinnError.hpp"
 #include "nDjinnException.hpp"
+#include "nDjinnHandlePool.hpp"
 #include "nDjinnNamespace.hpp"
+#include "nDjinnStateCache.hpp"
 
 NDJINN_BEGIN_NAMESPACE
 
@@ -21,28 +28,39 @@ namespace detail {
 
 //! Generate @a n buffer handles. May throw.
 inline void genBuffers(GLsizei const n, GLuint *buffers) { 
-  glGenBuffers(n, buffers); 
+  NDJINN_GL(GenBuffers)(n, buffers); 
   checkError("glGenBuffers"); 
 }
 
 //! Free handle resources. May throw.
 inline void deleteBuffers(GLsizei const n, GLuint const* buffers) {
-  glDeleteBuffers(n, buffers); 
+  NDJINN_GL(DeleteBuffers)(n, buffers); 
   checkError("glDeleteBuffers");
+  uncacheDeleted(&StateCache::bufferBindings, n, buffers);
+  uncacheDeletedElementArrayBuffers(n, buffers);
 }
 
 //! Make buffer the currently bound buffer. May throw.
 inline void bindBuffer(GLenum const target, GLuint const buffer) {
-  glBindBuffer(target, buffer); 
+  if (skipState(&StateCache::bufferBindings, target, buffer,
+                DispatchIndex::BindBuffer)) {
+    return;
+  }
+  NDJINN_GL(BindBuffer)(target, buffer); 
   checkError("glBindBuffer"); 
+  cacheState(&StateCache::bufferBindings, target, buffer);
+  if (target == GL_ELEMENT_ARRAY_BUFFER) {
+    cacheElementArrayBuffer(buffer);
+  }
 }
 
 //! glBindBufferBase wrapper. May throw.
 inline void bindBufferBase(GLenum const target,
                            GLuint const index,
                            GLuint const buffer) {
-  glBindBufferBase(target, index, buffer);
+  NDJINN_GL(BindBufferBase)(target, index, buffer);
   checkError("glBindBufferBase");
+  cacheState(&StateCache::bufferBindings, target, buffer); // Generic binding.
 }
 
 //! glBindBufferRange wrapper. May throw.
@@ -51,13 +69,36 @@ inline void bindBufferRange(GLenum const target,
                             GLuint const buffer,
                             GLintptr const offset,
                             GLsizeiptr const size) {
-  glBindBufferRange(target, index, buffer, offset, size);
+  NDJINN_GL(BindBufferRange)(target, index, buffer, offset, size);
   checkError("glBindBufferRange");
+  cacheState(&StateCache::bufferBindings, target, buffer); // Generic binding.
+}
+
+//! glBindBuffersBase wrapper. Unlike glBindBufferBase the generic binding
+//! is left unchanged. Null @a buffers unbinds the range. May throw.
+inline void bindBuffersBase(GLenum const target,
+                            GLuint const first,
+                            GLsizei const count,
+                            GLuint const* buffers) {
+  NDJINN_GL(BindBuffersBase)(target, first, count, buffers);
+  checkError("glBindBuffersBase");
+}
+
+//! glBindBuffersRange wrapper. Unlike glBindBufferRange the generic binding
+//! is left unchanged. Null @a buffers unbinds the range. May throw.
+inline void bindBuffersRange(GLenum const target,
+                             GLuint const first,
+                             GLsizei const count,
+                             GLuint const* buffers,
+                             GLintptr const* offsets,
+                             GLsizeiptr const* sizes) {
+  NDJINN_GL(BindBuffersRange)(target, first, count, buffers, offsets, sizes);
+  checkError("glBindBuffersRange");
 }
 
 //! glIsBuffer wrapper. May throw.
 inline GLboolean isBuffer(GLuint const buffer) {
-  GLboolean const isBuffer = glIsBuffer(buffer);
+  GLboolean const isBuffer = NDJINN_GL(IsBuffer)(buffer);
   checkError("glIsBuffer"); 
   return isBuffer;
 }
@@ -70,39 +111,105 @@ inline void namedBufferData(GLuint const buffer,
                             GLsizeiptr const size,
                             GLvoid const* data,
                             GLenum const usage) {
-  glNamedBufferDataEXT(buffer, size, data, usage);
+  NDJINN_GL(NamedBufferDataEXT)(buffer, size, data, usage);
   checkError("glNamedBufferDataEXT");
 }
 
+//! glNamedBufferStorage wrapper, allocates immutable storage. May throw.
+inline void namedBufferStorage(GLuint const buffer,
+                               GLsizeiptr const size,
+                               GLvoid const* data,
+                               GLbitfield const flags) {
+  NDJINN_GL(NamedBufferStorageEXT)(buffer, size, data, flags);
+  checkError("glNamedBufferStorageEXT");
+}
+
 //! glNamedBufferSubData wrapper. May throw.
 inline void namedBufferSubData(GLuint const buffer,
                                GLintptr const offset,
                                GLsizeiptr const size,
                                GLvoid const* data) {
-  glNamedBufferSubDataEXT(buffer, offset, size, data);
+  NDJINN_GL(NamedBufferSubDataEXT)(buffer, offset, size, data);
   checkError("glNamedBufferSubDataEXT");
 }
 
+//! glNamedCopyBufferSubData wrapper. May throw.
+inline void namedCopyBufferSubData(GLuint const readBuffer,
+                                   GLuint const writeBuffer,
+                                   GLintptr const readOffset,
+                                   GLintptr const writeOffset,
+                                   GLsizeiptr const size) {
+  NDJINN_GL(NamedCopyBufferSubDataEXT)(readBuffer, writeBuffer,
+                                       readOffset, writeOffset, size);
+  checkError("glNamedCopyBufferSubDataEXT");
+}
+
 //! glGetNamedBuffersSubData wrapper. May throw.
 inline void getNamedBufferSubData(GLuint const buffer,
                                   GLintptr const offset,
                                   GLsizeiptr const size,
                                   GLvoid* data) {
-  glGetNamedBufferSubDataEXT(buffer, offset, size, data);
+  NDJINN_GL(GetNamedBufferSubDataEXT)(buffer, offset, size, data);
   checkError("glGetNamedBufferSubDataEXT");
 }
 
 //! glMapNamedBuffer wrapper. May throw.
 inline GLvoid* mapNamedBuffer(GLuint const buffer,
                               GLenum const access) {
-  GLvoid* ptr = glMapNamedBufferEXT(buffer, access);
+  GLvoid* ptr = NDJINN_GL(MapNamedBufferEXT)(buffer, access);
   checkError("glMapNamedBufferEXT");
   return ptr;
 }
 
+//! glMapNamedBufferRange wrapper. May throw.
+inline GLvoid* mapNamedBufferRange(GLuint const buffer,
+                                   GLintptr const offset,
+                                   GLsizeiptr const length,
+                                   GLbitfield const access) {
+  GLvoid* ptr = NDJINN_GL(MapNamedBufferRangeEXT)(buffer, offset, length,
+                                                  access);
+  checkError("glMapNamedBufferRangeEXT");
+  return ptr;
+}
+
+//! glFlushMappedNamedBufferRange wrapper. May throw.
+inline void flushMappedNamedBufferRange(GLuint const buffer,
+                                        GLintptr const offset,
+                                        GLsizeiptr const length) {
+  NDJINN_GL(FlushMappedNamedBufferRangeEXT)(buffer, offset, length);
+  checkError("glFlushMappedNamedBufferRangeEXT");
+}
+
+//! glClearNamedBufferSubData wrapper. May throw.
+inline void clearNamedBufferSubData(GLuint const buffer,
+                                    GLenum const internalformat,
+                                    GLsizeiptr const offset,
+                                    GLsizeiptr const size,
+                                    GLenum const format,
+                                    GLenum const type,
+                                    GLvoid const* data) {
+  NDJINN_GL(ClearNamedBufferSubDataEXT)(buffer, internalformat, offset, size,
+                                        format, type, data);
+  checkError("glClearNamedBufferSubDataEXT");
+}
+
+//! glInvalidateBufferData wrapper. May throw.
+inline void invalidateBufferData(GLuint const buffer) {
+  NDJINN_GL(InvalidateBufferData)(buffer);
+  checkError("glInvalidateBufferData");
+}
+
+//! glInvalidateBufferSubData wrapper. May throw.
+inline void invalidateBufferSubData(GLuint const buffer,
+                                    GLintptr const offset,
+                                    GLsizeiptr const length) {
+  NDJINN_GL(InvalidateBufferSubData)(buffer, offset, length);
+  checkError("glInvalidateBufferSubData");
+}
+
 //! glUnmapNamedBuffer wrapper. May throw.
 inline GLboolean unmapNamedBuffer(GLuint const buffer) {
-  GLboolean const mapped = glUnmapNamedBufferEXT(buffer);
+  GLboolean const mapped = NDJINN_GL(UnmapNamedBufferEXT)(buffer);
   checkError("glUnmapNamedBufferEXT");
   return mapped;
 }
@@ -111,7 +218,7 @@ inline GLboolean unmapNamedBuffer(GLuint const buffer) {
 inline void getNamedBufferParameteriv(GLuint const buffer,
                                       GLenum const pname,
                                       GLint* params) {
-  glGetNamedBufferParameterivEXT(buffer, pname, params);
+  NDJINN_GL(GetNamedBufferParameterivEXT)(buffer, pname, params);
   checkError("glGetNamedBufferParameterivEXT");
 }
 
@@ -119,12 +226,16 @@ inline void getNamedBufferParameteriv(GLuint const buffer,
 inline void getNamedBufferPointerv(GLuint const buffer,
                                    GLenum const pname,
                                    GLvoid** params) {
-  glGetNamedBufferPointervEXT(buffer, pname, params);
+  NDJINN_GL(GetNamedBufferPointervEXT)(buffer, pname, params);
   checkError("glGetNamedBufferPointervEXT");
 }
 
 //! Convenience, generate a single buffer handle and return it. May throw.
 inline GLuint genBuffer() {
+  HandlePools* const pools = HandlePools::current();
+  if (pools != nullptr) {
+    return pools->buffers.acquire(&genBuffers, &deleteBuffers);
+  }
   GLuint handle = 0;
   genBuffers(1, &handle);
   return handle;
@@ -132,9 +243,63 @@ inline GLuint genBuffer() {
 
 //! Convenience.
 inline void deleteBuffer(GLuint const handle) {
+  HandlePools* const pools = HandlePools::current();
+  if (pools != nullptr) {
+    pools->buffers.release(handle, &deleteBuffers);
+    return;
+  }
+  DeletionQueue* const queue = DeletionQueue::current();
+  if (queue != nullptr) {
+    queue->push(&deleteBuffers, handle);
+    return;
+  }
   deleteBuffers(1, &handle);
 }
 
+//! Formats that make glClearBufferSubData repeat a single value of type T.
+template <typename T>
+struct ClearFormat;
+
+//! Specialization.
+template <>
+struct ClearFormat<GLubyte> {
+  static GLenum const internalFormat = GL_R8UI;
+  static GLenum const format = GL_RED_INTEGER;
+  static GLenum const type = GL_UNSIGNED_BYTE;
+};
+
+//! Specialization.
+template <>
+struct ClearFormat<GLushort> {
+  static GLenum const internalFormat = GL_R16UI;
+  static GLenum const format = GL_RED_INTEGER;
+  static GLenum const type = GL_UNSIGNED_SHORT;
+};
+
+//! Specialization.
+template <>
+struct ClearFormat<GLuint> {
+  static GLenum const internalFormat = GL_R32UI;
+  static GLenum const format = GL_RED_INTEGER;
+  static GLenum const type = GL_UNSIGNED_INT;
+};
+
+//! Specialization.
+template <>
+struct ClearFormat<GLint> {
+  static GLenum const internalFormat = GL_R32I;
+  static GLenum const format = GL_RED_INTEGER;
+  static GLenum const type = GL_INT;
+};
+
+//! Specialization.
+template <>
+struct ClearFormat<GLfloat> {
+  static GLenum const internalFormat = GL_R32F;
+  static GLenum const format = GL_RED;
+  static GLenum const type = GL_FLOAT;
+};
+
 #if 0 // Where to put this stuff?
 template<GLenum T>
 struct BufferBinding;
@@ -205,6 +370,37 @@ inline std::string bufferUsageToString(GLenum const usage) {
 
 } // Namespace: detail.
 
+//! How Buffer::update() replaces a range that OpenGL may still be reading,
+//! e.g. vertices drawn in the previous frame. Which is fastest depends on
+//! the driver and the size of the update.
+enum BufferUpdate {
+  //! glNamedBufferSubData, the driver copies the data or waits.
+  BUFFER_UPDATE_SUB_DATA,
+  //! Reallocate the whole buffer with the same size and usage before
+  //! uploading, so that the driver can hand out new memory while the old
+  //! is still in use. The rest of the buffer is lost. Mutable storage only.
+  BUFFER_UPDATE_ORPHAN,
+  //! glInvalidateBufferSubData on the range, then upload.
+  BUFFER_UPDATE_INVALIDATE,
+  //! Map the range with GL_MAP_UNSYNCHRONIZED_BIT and
+  //! GL_MAP_INVALIDATE_RANGE_BIT and copy. Never waits, the caller must
+  //! ensure that OpenGL is not reading the range, e.g. with a Fence.
+  BUFFER_UPDATE_UNSYNCHRONIZED,
+  //! Map the range unsynchronized with GL_MAP_FLUSH_EXPLICIT_BIT, copy and
+  //! flush it explicitly.
+  BUFFER_UPDATE_FLUSH
+};
+
+//! Selects the Buffer constructor that allocates immutable storage, with
+//! glBufferStorage flags, e.g. GL_MAP_WRITE_BIT | GL_DYNAMIC_STORAGE_BIT.
+struct ImmutableStorage {
+  explicit ImmutableStorage(GLbitfield const flags = 0)
+    : flags(flags)
+  {}
+
+  GLbitfield flags;
+};
+
 //! DOCS
 template<GLenum TargetT>
 class Buffer {
@@ -215,6 +411,10 @@ public:
   //! are allocated.
   Buffer()
     : _handle(detail::genBuffer())
+    , _size(0)
+    , _usage(GL_STATIC_DRAW)
+    , _storageFlags(0)
+    , _immutable(false)
   {
     throwIfInvalidHandle();
   }
@@ -225,14 +425,64 @@ public:
          GLvoid const* ptr,
          GLenum const usage = GL_STATIC_DRAW)
     : _handle(detail::genBuffer())
+    , _size(0)
+    , _usage(GL_STATIC_DRAW)
+    , _storageFlags(0)
+    , _immutable(false)
   {
     //throwIfInvalidHandle();
     setData(size, ptr, usage);
   }
 
+  //! CTOR. Construct a buffer with immutable storage, its size can not
+  //! change and setData() throws. Unless storage.flags has
+  //! GL_DYNAMIC_STORAGE_BIT the contents can only be changed by OpenGL
+  //! or through mapping. May throw.
+  Buffer(GLsizeiptr const size,
+         GLvoid const* ptr,
+         ImmutableStorage const& storage)
+    : _handle(detail::genBuffer())
+    , _size(0)
+    , _usage(GL_DYNAMIC_DRAW) // As reported by OpenGL for immutable storage.
+    , _storageFlags(storage.flags)
+    , _immutable(true)
+  {
+    detail::namedBufferStorage(_handle, size, ptr, storage.flags);
+    _size = size;
+  }
+
   //! DTOR
   ~Buffer() {
-    detail::deleteBuffer(_handle);
+    if (_handle != 0) {
+      detail::deleteBuffer(_handle);
+    }
+  }
+
+  //! Move CTOR, @a rhs is left empty, i.e. with a zero handle.
+  Buffer(Buffer<TargetT>&& rhs) noexcept
+    : _handle(rhs._handle)
+    , _size(rhs._size)
+    , _usage(rhs._usage)
+    , _storageFlags(rhs._storageFlags)
+    , _immutable(rhs._immutable)
+  {
+    rhs.reset();
+  }
+
+  //! Move assign, the current buffer is deleted and @a rhs left empty.
+  Buffer& operator=(Buffer<TargetT>&& rhs) noexcept {
+    if (this != &rhs) {
+      if (_handle != 0) {
+        detail::releaseNoThrow(&detail::deleteBuffer, _handle);
+      }
+      _handle = rhs._handle;
+      _size = rhs._size;
+      _usage = rhs._usage;
+      _storageFlags = rhs._storageFlags;
+      _immutable = rhs._immutable;
+      rhs.reset();
+    }
+    return *this;
   }
 
   //! Expose resource handle.
@@ -275,11 +525,16 @@ public:
 
   //! Upload data to GPU memory. If data is null, memory gets allocated but
   //! nothing gets transferred. This is useful for populating a VBO from
-  //! several sub-buffers.
+  //! several sub-buffers. Throws if storage is immutable.
   void setData(GLsizeiptr const sizeInBytes,
                GLvoid const* ptr = 0,
                GLenum const usage = GL_STATIC_DRAW) {
+    if (_immutable) {
+      NDJINN_THROW("cannot reallocate immutable buffer storage: " << _handle);
+    }
     detail::namedBufferData(_handle, sizeInBytes, ptr, usage);
+    _size = sizeInBytes;
+    _usage = usage;
   }
 
   //! Upload data to GPU memory. Size of buffer remains constant.
@@ -289,38 +544,147 @@ public:
     detail::namedBufferSubData(_handle, offset, size, ptr);
   }
 
+  //! Replace @a size bytes at @a offset using @a strategy, see
+  //! BufferUpdate. May throw.
+  void update(GLintptr const offset,
+              GLsizeiptr const size,
+              GLvoid const* ptr,
+              BufferUpdate const strategy = BUFFER_UPDATE_SUB_DATA) {
+    switch (strategy) {
+    case BUFFER_UPDATE_SUB_DATA:
+      break;
+    case BUFFER_UPDATE_ORPHAN:
+      setData(_size, nullptr, _usage);
+      break;
+    case BUFFER_UPDATE_INVALIDATE:
+      invalidateSubData(offset, size);
+      break;
+    case BUFFER_UPDATE_UNSYNCHRONIZED:
+    case BUFFER_UPDATE_FLUSH: {
+      GLbitfield const access = strategy == BUFFER_UPDATE_FLUSH
+        ? GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+          GL_MAP_FLUSH_EXPLICIT_BIT
+        : GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+          GL_MAP_INVALIDATE_RANGE_BIT;
+      void* const dst = mapRange<void>(offset, size, access);
+      if (dst == nullptr) {
+        NDJINN_THROW("could not map buffer range: " << _handle);
+      }
+      std::memcpy(dst, ptr, static_cast<std::size_t>(size));
+      if (strategy == BUFFER_UPDATE_FLUSH) {
+        flushMappedRange(0, size);
+      }
+      if (!unmap()) {
+        NDJINN_THROW("buffer contents lost while mapped: " << _handle);
+      }
+      return;
+    }
+    }
+    detail::namedBufferSubData(_handle, offset, size, ptr);
+  }
+
+  //! Copy @a size bytes from @a src on the GPU. @a src may be this buffer
+  //! if the ranges do not overlap. May throw.
+  template <GLenum SrcTargetT>
+  void copyFrom(Buffer<SrcTargetT> const& src,
+                GLintptr const srcOffset,
+                GLintptr const dstOffset,
+                GLsizeiptr const size) {
+    detail::namedCopyBufferSubData(src.handle(), _handle, srcOffset, dstOffset,
+                                   size);
+  }
+
+  //! Fill the buffer with zeros on the GPU. May throw.
+  void clear() {
+    clearSubData(0, _size, GLubyte(0));
+  }
+
+  //! Fill the buffer with copies of @a pattern, e.g. a GLuint, on the GPU.
+  //! The size must be a multiple of the pattern size. May throw.
+  template <typename T>
+  void clear(T const pattern) {
+    clearSubData(0, _size, pattern);
+  }
+
+  //! Fill @a size bytes at @a offset with copies of @a pattern. Both must
+  //! be multiples of the pattern size. May throw.
+  template <typename T>
+  void clearSubData(GLintptr const offset,
+                    GLsizeiptr const size,
+                    T const pattern) {
+    detail::clearNamedBufferSubData(_handle,
+                                    detail::ClearFormat<T>::internalFormat,
+                                    offset, size,
+                                    detail::ClearFormat<T>::format,
+                                    detail::ClearFormat<T>::type, &pattern);
+  }
+
+  //! Discard the contents of the whole buffer, e.g. before rewriting it, so
+  //! that OpenGL need not preserve them. May throw.
+  void invalidate() {
+    detail::invalidateBufferData(_handle);
+  }
+
+  //! Discard the contents of a range, e.g. before rewriting it, so that
+  //! OpenGL need not preserve them. May throw.
+  void invalidateSubData(GLintptr const offset, GLsizeiptr const length) {
+    detail::invalidateBufferSubData(_handle, offset, length);
+  }
+
   //! DOCS
   template <typename E>
   E* map(GLenum const access) {
     return reinterpret_cast<E*>(detail::mapNamedBuffer(_handle, access));
   }
 
+  //! Map @a length bytes at @a offset, @a access is a combination of
+  //! GL_MAP_*_BIT flags. May throw.
+  template <typename E>
+  E* mapRange(GLintptr const offset,
+              GLsizeiptr const length,
+              GLbitfield const access) {
+    return reinterpret_cast<E*>(
+      detail::mapNamedBufferRange(_handle, offset, length, access));
+  }
+
+  //! Make writes to a range mapped with GL_MAP_FLUSH_EXPLICIT_BIT visible
+  //! to OpenGL, @a offset is relative to the mapped range. May throw.
+  void flushMappedRange(GLintptr const offset, GLsizeiptr const length) {
+    detail::flushMappedNamedBufferRange(_handle, offset, length);
+  }
+
   //! DOCS
   bool unmap() {
-    return detail::unmapNamedBuffer() == GL_TRUE;
+    return detail::unmapNamedBuffer(_handle) == GL_TRUE;
   }
 
-  // The following functions retrieve buffer parameters from the driver.
-  // There may be a performance penalty involved, so use with caution.
+  //! Return buffer size in bytes, as allocated through this object.
+  GLsizeiptr sizeInBytes() const {
+    return _size;
+  }
+
+  //! Return buffer usage mode, GL_DYNAMIC_DRAW for immutable storage.
+  GLenum usage() const {
+    return _usage;
+  }
 
-  //! Return buffer size in bytes. May throw.
-  GLint sizeInBytes() const {
-    GLint size = -1;
-    detail::getNamedBufferParameteriv(_handle, GL_BUFFER_SIZE, &size);
-    return size;
+  //! True if storage was allocated with ImmutableStorage.
+  bool immutable() const {
+    return _immutable;
   }
 
-  //! Return buffer usage mode.
-  GLint usage() const {
-    GLint usage = -1;
-    detail::getNamedBufferParameteriv(TARGET, GL_BUFFER_USAGE, &usage);
-    return usage;
+  //! Flags immutable storage was allocated with, zero if mutable.
+  GLbitfield storageFlags() const {
+    return _storageFlags;
   }
 
+  // The following functions retrieve buffer parameters from the driver.
+  // There may be a performance penalty involved, so use with caution.
+
   //! Return true if this buffer is currently mapped, otherwise false.
   bool mapped() const {
     GLint mapped = -1;
-    detail::getNamedBufferParameteriv(TARGET, GL_BUFFER_MAPPED, &mapped);
+    detail::getNamedBufferParameteriv(_handle, GL_BUFFER_MAPPED, &mapped);
     return mapped == GL_TRUE;
   }
 
@@ -328,22 +692,69 @@ private:
   Buffer(Buffer<TargetT> const&); //!< Disabled copy.
   Buffer& operator=(Buffer<TargetT> const&); //!< Disabled assign.
 
+  //! Forget the resource without deleting it.
+  void reset() {
+    _handle = 0;
+    _size = 0;
+    _usage = GL_STATIC_DRAW;
+    _storageFlags = 0;
+    _immutable = false;
+  }
+
   void throwIfInvalidHandle() {
     if (detail::isBuffer(_handle) == GL_FALSE) {
       NDJINN_THROW("invalid buffer handle: " << _handle);
     }
   }
 
-  GLuint const _handle; //!< Resource handle.
+  GLuint _handle; //!< Resource handle.
+  GLsizeiptr _size; //!< Cached, avoids querying GL_BUFFER_SIZE.
+  GLenum _usage;
+  GLbitfield _storageFlags;
+  bool _immutable;
 };
 
 typedef Buffer<GL_ARRAY_BUFFER> ArrayBuffer;
 typedef Buffer<GL_ELEMENT_ARRAY_BUFFER> ElementArrayBuffer;
 typedef Buffer<GL_UNIFORM_BUFFER> UniformBuffer;
 
+//! Number of elements of type E that fit in @a buffer, from the cached
+//! size. See TypedBuffer for buffers that know their element type.
 template<typename E, typename Size, GLenum Target> inline
 Size elementCount(Buffer<Target> const& buffer) {
-  return static_cast<Size>(buffer.size() / sizeof(E));
+  return static_cast<Size>(buffer.sizeInBytes() /
+                           static_cast<GLsizeiptr>(sizeof(E)));
+}
+
+//! Bind whole @a buffers to the indexed binding points of @a target
+//! starting at @a first, e.g. uniform blocks, with a single call. Zero
+//! handles unbind. May throw.
+template <std::size_t N> inline
+void bindBuffersBase(GLenum const target, GLuint const first,
+                     std::array<GLuint, N> const& buffers)
+{
+  detail::bindBuffersBase(target, first, static_cast<GLsizei>(N),
+                          buffers.data());
+}
+
+//! Bind ranges of @a buffers to the indexed binding points of @a target
+//! starting at @a first with a single call. May throw.
+template <std::size_t N> inline
+void bindBuffersRange(GLenum const target, GLuint const first,
+                      std::array<GLuint, N> const& buffers,
+                      std::array<GLintptr, N> const& offsets,
+                      std::array<GLsizeiptr, N> const& sizes)
+{
+  detail::bindBuffersRange(target, first, static_cast<GLsizei>(N),
+                           buffers.data(), offsets.data(), sizes.data());
+}
+
+//! Release @a count indexed binding points of @a target starting at
+//! @a first. May throw.
+inline void releaseBuffers(GLenum const target, GLuint const first,
+                           GLsizei const count)
+{
+  detail::bindBuffersBase(target, first, count, nullptr);
 }
 
 NDJINN_END_NAMESPACE
@@ -359,6 +770,8 @@ ostream& operator<<(ostream& os, ndj::Buffer<TargetT> const& buf)
      << "  Handle: " << buf.handle() << endl
      << "  Size: " << buf.sizeInBytes() << " [bytes]" << endl
      << "  Usage: " << ndj::detail::bufferUsageToString(buf.usage()) << endl
+     << "  Immutable: " << buf.immutable() << endl
+     << "  Storage flags: " << buf.storageFlags() << endl
      << "  Mapped: " << buf.mapped() << endl
      << "  " << endl;
   return os;
@@ -0,0 +1,591 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+#ifndef NDJINN_BUFFER_ARENA_HPP_INCLUDED
+#define NDJINN_BUFFER_ARENA_HPP_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "nDjinnBuffer.hpp"
+#include "nDjinnException.hpp"
+#include "nDjinnGL.hpp"
+#include "nDjinnNamespace.hpp"
+
+NDJINN_BEGIN_NAMESPACE
+
+namespace detail {
+
+inline std::size_t floorLog2(std::size_t value)
+{
+  std::size_t log2 = 0;
+  while (value >>= 1) {
+    ++log2;
+  }
+  return log2;
+}
+
+//! Index of the lowest set bit, @a bits must not be zero.
+inline std::size_t lowestBit(std::uint64_t const bits)
+{
+  std::size_t index = 0;
+  while ((bits & (std::uint64_t(1) << index)) == 0) {
+    ++index;
+  }
+  return index;
+}
+
+//! Two-level segregated fit allocator for a range of abstract units, e.g.
+//! aligned chunks of a buffer. Free blocks are kept in size classes, the
+//! first level a power of two, the second level SL_COUNT linear steps
+//! within it, so that finding a block large enough only takes a couple of
+//! bitmap lookups. Adjacent free blocks are merged on free().
+class TlsfAllocator {
+public:
+  // Enumerators, so that they need no definition when bound to a
+  // reference, e.g. by std::array::fill().
+  enum : std::size_t {
+    SL_LOG2 = 4,
+    SL_COUNT = std::size_t(1) << SL_LOG2,
+    FL_COUNT = 64 - SL_LOG2,
+    NONE = static_cast<std::size_t>(-1)
+  };
+
+  //! A block, free or allocated.
+  struct Block {
+    std::size_t size;
+    bool free;
+    std::size_t prevFree; //!< Offset, NONE at the head of a free list.
+    std::size_t nextFree; //!< Offset, NONE at the tail of a free list.
+  };
+
+  typedef std::map<std::size_t, Block> BlockMap; //!< By offset.
+
+  explicit TlsfAllocator(std::size_t const size = 0)
+    : _size(size)
+    , _used(0)
+    , _freeBlockCount(0)
+    , _flBitmap(0)
+  {
+    _slBitmaps.fill(0);
+    for (std::size_t fl = 0; fl < FL_COUNT; ++fl) {
+      _heads[fl].fill(NONE);
+    }
+    if (size > 0) {
+      Block const block = { size, true, NONE, NONE };
+      insertFree(_blocks.insert(std::make_pair(0, block)).first);
+    }
+  }
+
+  //! Returns the offset of @a size units, or NONE if there is no free
+  //! block large enough.
+  std::size_t allocate(std::size_t size) {
+    if (size == 0) {
+      size = 1;
+    }
+    std::size_t fl = 0;
+    std::size_t sl = 0;
+    std::size_t const offset =
+      findFree(size, &fl, &sl) ? _heads[fl][sl] : findInClass(size);
+    if (offset == NONE) {
+      return NONE;
+    }
+    BlockMap::iterator const iter = _blocks.find(offset);
+    removeFree(iter);
+    Block& block = iter->second;
+    if (block.size > size) {
+      Block const rest = { block.size - size, true, NONE, NONE };
+      block.size = size;
+      insertFree(_blocks.insert(
+        std::make_pair(iter->first + size, rest)).first);
+    }
+    block.free = false;
+    _used += size;
+    return iter->first;
+  }
+
+  //! Release the block at @a offset, as returned by allocate().
+  void free(std::size_t const offset) {
+    BlockMap::iterator iter = _blocks.find(offset);
+    if (iter == _blocks.end() || iter->second.free) {
+      NDJINN_THROW("invalid arena offset: " << offset);
+    }
+    _used -= iter->second.size;
+    iter->second.free = true;
+
+    BlockMap::iterator const next = std::next(iter);
+    if (next != _blocks.end() && next->second.free) {
+      removeFree(next);
+      iter->second.size += next->second.size;
+      _blocks.erase(next);
+    }
+    if (iter != _blocks.begin()) {
+      BlockMap::iterator const prev = std::prev(iter);
+      if (prev->second.free) {
+        removeFree(prev);
+        prev->second.size += iter->second.size;
+        _blocks.erase(iter);
+        iter = prev;
+      }
+    }
+    insertFree(iter);
+  }
+
+  std::size_t size() const {
+    return _size;
+  }
+
+  //! Units allocated.
+  std::size_t used() const {
+    return _used;
+  }
+
+  std::size_t freeBlockCount() const {
+    return _freeBlockCount;
+  }
+
+  //! Size of the largest free block.
+  std::size_t largestFree() const {
+    if (_flBitmap == 0) {
+      return 0;
+    }
+    std::size_t fl = FL_COUNT - 1;
+    while ((_flBitmap & (std::uint64_t(1) << fl)) == 0) {
+      --fl;
+    }
+    std::size_t sl = SL_COUNT - 1;
+    while ((_slBitmaps[fl] & (1u << sl)) == 0) {
+      --sl;
+    }
+    std::size_t largest = 0;
+    for (std::size_t offset = _heads[fl][sl]; offset != NONE;) {
+      Block const& block = _blocks.find(offset)->second;
+      largest = std::max(largest, block.size);
+      offset = block.nextFree;
+    }
+    return largest;
+  }
+
+  BlockMap const& blocks() const {
+    return _blocks;
+  }
+
+private:
+  //! Size class of a block of @a size units.
+  static void mapping(std::size_t const size, std::size_t* fl,
+                      std::size_t* sl) {
+    if (size < SL_COUNT) {
+      *fl = 0;
+      *sl = size;
+    }
+    else {
+      std::size_t const log2 = floorLog2(size);
+      *fl = log2 - SL_LOG2 + 1;
+      *sl = (size >> (log2 - SL_LOG2)) - SL_COUNT;
+    }
+  }
+
+  //! Finds the first non-empty size class whose blocks all hold at least
+  //! @a size units.
+  bool findFree(std::size_t size, std::size_t* fl, std::size_t* sl) const {
+    if (size >= SL_COUNT) {
+      size += (std::size_t(1) << (floorLog2(size) - SL_LOG2)) - 1;
+    }
+    mapping(size, fl, sl);
+    if (*fl >= FL_COUNT) {
+      return false;
+    }
+    std::uint32_t slBits = _slBitmaps[*fl] & (~0u << *sl);
+    if (slBits == 0) {
+      std::uint64_t const flBits = *fl + 1 < FL_COUNT ?
+        _flBitmap & (~std::uint64_t(0) << (*fl + 1)) : 0;
+      if (flBits == 0) {
+        return false;
+      }
+      *fl = lowestBit(flBits);
+      slBits = _slBitmaps[*fl];
+    }
+    *sl = lowestBit(slBits);
+    return true;
+  }
+
+  //! Blocks in the size class of @a size may be smaller, which findFree()
+  //! avoids by looking in the next class. Search the class itself when
+  //! that fails, e.g. for the last allocation that fits.
+  std::size_t findInClass(std::size_t const size) const {
+    std::size_t fl = 0;
+    std::size_t sl = 0;
+    mapping(size, &fl, &sl);
+    if (fl >= FL_COUNT) {
+      return NONE;
+    }
+    for (std::size_t offset = _heads[fl][sl]; offset != NONE;) {
+      Block const& block = _blocks.find(offset)->second;
+      if (block.size >= size) {
+        return offset;
+      }
+      offset = block.nextFree;
+    }
+    return NONE;
+  }
+
+  void insertFree(BlockMap::iterator const iter) {
+    Block& block = iter->second;
+    std::size_t fl = 0;
+    std::size_t sl = 0;
+    mapping(block.size, &fl, &sl);
+    std::size_t& head = _heads[fl][sl];
+    block.free = true;
+    block.prevFree = NONE;
+    block.nextFree = head;
+    if (head != NONE) {
+      _blocks.find(head)->second.prevFree = iter->first;
+    }
+    head = iter->first;
+    _slBitmaps[fl] |= 1u << sl;
+    _flBitmap |= std::uint64_t(1) << fl;
+    ++_freeBlockCount;
+  }
+
+  void removeFree(BlockMap::iterator const iter) {
+    Block& block = iter->second;
+    std::size_t fl = 0;
+    std::size_t sl = 0;
+    mapping(block.size, &fl, &sl);
+    if (block.prevFree != NONE) {
+      _blocks.find(block.prevFree)->second.nextFree = block.nextFree;
+    }
+    else {
+      _heads[fl][sl] = block.nextFree;
+    }
+    if (block.nextFree != NONE) {
+      _blocks.find(block.nextFree)->second.prevFree = block.prevFree;
+    }
+    if (_heads[fl][sl] == NONE) {
+      _slBitmaps[fl] &= ~(1u << sl);
+      if (_slBitmaps[fl] == 0) {
+        _flBitmap &= ~(std::uint64_t(1) << fl);
+      }
+    }
+    block.prevFree = NONE;
+    block.nextFree = NONE;
+    --_freeBlockCount;
+  }
+
+  std::size_t _size;
+  std::size_t _used;
+  std::size_t _freeBlockCount;
+  BlockMap _blocks;
+  std::uint64_t _flBitmap; //!< Bit set for first levels with free blocks.
+  std::array<std::uint32_t, FL_COUNT> _slBitmaps;
+  std::array<std::array<std::size_t, SL_COUNT>, FL_COUNT> _heads;
+};
+
+} // Namespace: detail.
+
+//! Memory use of a BufferArena, in bytes.
+struct BufferArenaStats {
+  BufferArenaStats()
+    : pageCount(0)
+    , allocationCount(0)
+    , freeBlockCount(0)
+    , capacity(0)
+    , used(0)
+    , largestFree(0)
+  {}
+
+  GLsizeiptr free() const {
+    return capacity - used;
+  }
+
+  //! Zero when free space is a single block, approaching one as it is split
+  //! into many small blocks.
+  double fragmentation() const {
+    return free() > 0 ?
+      1. - static_cast<double>(largestFree) / static_cast<double>(free()) : 0.;
+  }
+
+  std::size_t pageCount;
+  std::size_t allocationCount;
+  std::size_t freeBlockCount;
+  GLsizeiptr capacity;
+  GLsizeiptr used; //!< Including alignment padding.
+  GLsizeiptr largestFree; //!< Largest allocation that fits without a new page.
+};
+
+//! Sub-allocates many small ranges, e.g. meshes, from a few large buffers,
+//! the pages, so that they can be drawn with base vertex or multi-draw
+//! calls without rebinding. Pages have immutable storage of @a pageSize
+//! bytes, larger allocations get a page of their own.
+//!
+//! Allocations are referred to by id, since defragment() moves them. Look up
+//! the current buffer and offset with range(), or the first element for
+//! base vertex and indirect draws with firstElement().
+template <GLenum TargetT>
+class BufferArena {
+public:
+  static GLenum const TARGET = TargetT;
+
+  typedef std::size_t Id;
+
+  //! Where an allocation currently lives.
+  struct Range {
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr size; //!< As requested.
+  };
+
+  //! CTOR. Allocation offsets are multiples of @a alignment, e.g. the
+  //! vertex size or GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT. No pages are
+  //! allocated until needed.
+  explicit BufferArena(GLsizeiptr const pageSize,
+                       GLsizeiptr const alignment = 64)
+    : _pageSize(pageSize)
+    , _alignment(alignment)
+  {}
+
+  //! Allocate @a size bytes, adding a page if no page has room. May throw.
+  Id allocate(GLsizeiptr const size) {
+    std::size_t const units = unitCount(size);
+    Page* page = nullptr;
+    std::size_t offset = detail::TlsfAllocator::NONE;
+    for (std::size_t i = 0;
+         i < _pages.size() && offset == detail::TlsfAllocator::NONE; ++i) {
+      page = _pages[i].get();
+      offset = page->allocator.allocate(units);
+    }
+    if (offset == detail::TlsfAllocator::NONE) {
+      page = addPage(std::max(unitCount(_pageSize), units));
+      offset = page->allocator.allocate(units);
+    }
+
+    Entry const entry = { page, offset, size };
+    if (!_freeIds.empty()) {
+      Id const id = _freeIds.back();
+      _freeIds.pop_back();
+      _entries[id] = entry;
+      return id;
+    }
+    _entries.push_back(entry);
+    return _entries.size() - 1;
+  }
+
+  //! Release an allocation, the id may be reused.
+  void free(Id const id) {
+    Entry& entry = liveEntry(id);
+    entry.page->allocator.free(entry.offset);
+    entry.page = nullptr;
+    _freeIds.push_back(id);
+  }
+
+  Range range(Id const id) const {
+    Entry const& entry = liveEntry(id);
+    Range const range = {
+      entry.page->buffer->handle(),
+      static_cast<GLintptr>(entry.offset) * _alignment,
+      entry.size };
+    return range;
+  }
+
+  //! Index of the first element of an allocation, in elements of
+  //! @a elementSize bytes from the start of its page. Use as base vertex
+  //! or first index when drawing meshes that share a page, e.g. with
+  //! drawElementsBaseVertex() or in a DrawElementsIndirectCommand. Throws
+  //! if the offset is not a multiple of @a elementSize, i.e. unless the
+  //! alignment is.
+  GLuint firstElement(Id const id, GLsizeiptr const elementSize) const {
+    GLintptr const offset = range(id).offset;
+    if (elementSize <= 0 || offset % elementSize != 0) {
+      NDJINN_THROW("arena offset " << offset
+                   << " is not a multiple of element size " << elementSize);
+    }
+    return static_cast<GLuint>(offset / elementSize);
+  }
+
+  //! Copy an allocation's worth of data from @a ptr. May throw.
+  void upload(Id const id, GLvoid const* ptr) {
+    Entry const& entry = liveEntry(id);
+    entry.page->buffer->setSubData(
+      static_cast<GLintptr>(entry.offset) * _alignment, entry.size, ptr);
+  }
+
+  //! Pack all allocations, in page and offset order, into as few new
+  //! pages as possible with glNamedCopyBufferSubDataEXT, then release the
+  //! old pages. Ranges change, ids do not. Needs memory for both the old
+  //! and the new pages while copying. Returns the number of pages released.
+  //! May throw, in which case the arena is left unchanged.
+  std::size_t defragment() {
+    std::map<Page const*, std::size_t> pageOrder;
+    for (std::size_t i = 0; i < _pages.size(); ++i) {
+      pageOrder[_pages[i].get()] = i;
+    }
+    std::map<std::pair<std::size_t, std::size_t>, Entry*> live;
+    for (std::size_t id = 0; id < _entries.size(); ++id) {
+      Entry& entry = _entries[id];
+      if (entry.page != nullptr) {
+        live[std::make_pair(pageOrder[entry.page], entry.offset)] = &entry;
+      }
+    }
+
+    // Entries are only moved once all copies are done.
+    std::vector<std::unique_ptr<Page>> pages;
+    std::vector<std::pair<Entry*, Entry>> moved;
+    moved.reserve(live.size());
+    CopyRun run = { nullptr, nullptr, 0, 0, 0 };
+    for (auto iter = live.begin(); iter != live.end(); ++iter) {
+      Entry const& entry = *iter->second;
+      std::size_t const units =
+        entry.page->allocator.blocks().find(entry.offset)->second.size;
+      std::size_t offset = pages.empty() ?
+        detail::TlsfAllocator::NONE : pages.back()->allocator.allocate(units);
+      if (offset == detail::TlsfAllocator::NONE) {
+        pages.push_back(makePage(std::max(unitCount(_pageSize), units)));
+        offset = pages.back()->allocator.allocate(units);
+      }
+
+      // Copy contiguous allocations with a single call.
+      if (run.units > 0 &&
+          (run.src != entry.page || run.dst != pages.back().get() ||
+           run.srcOffset + run.units != entry.offset ||
+           run.dstOffset + run.units != offset)) {
+        copy(run);
+        run.units = 0;
+      }
+      if (run.units == 0) {
+        CopyRun const next =
+          { entry.page, pages.back().get(), entry.offset, offset, 0 };
+        run = next;
+      }
+      run.units += units;
+
+      Entry const placed = { pages.back().get(), offset, entry.size };
+      moved.push_back(std::make_pair(iter->second, placed));
+    }
+    if (run.units > 0) {
+      copy(run);
+    }
+
+    for (std::size_t i = 0; i < moved.size(); ++i) {
+      *moved[i].first = moved[i].second;
+    }
+
+    std::size_t const released = _pages.size() - pages.size();
+    _pages.swap(pages);
+    return released;
+  }
+
+  BufferArenaStats stats() const {
+    BufferArenaStats stats;
+    stats.pageCount = _pages.size();
+    stats.allocationCount = _entries.size() - _freeIds.size();
+    for (std::size_t i = 0; i < _pages.size(); ++i) {
+      detail::TlsfAllocator const& allocator = _pages[i]->allocator;
+      stats.freeBlockCount += allocator.freeBlockCount();
+      stats.capacity += static_cast<GLsizeiptr>(allocator.size()) * _alignment;
+      stats.used += static_cast<GLsizeiptr>(allocator.used()) * _alignment;
+      stats.largestFree = std::max(stats.largestFree,
+        static_cast<GLsizeiptr>(allocator.largestFree()) * _alignment);
+    }
+    return stats;
+  }
+
+private:
+  BufferArena(BufferArena<TargetT> const&); //!< Disabled copy.
+  BufferArena& operator=(BufferArena<TargetT> const&); //!< Disabled assign.
+
+  struct Page {
+    std::unique_ptr<Buffer<TargetT>> buffer;
+    detail::TlsfAllocator allocator; //!< In units of the alignment.
+  };
+
+  struct Entry {
+    Page* page; //!< Null if free.
+    std::size_t offset; //!< In units of the alignment.
+    GLsizeiptr size;
+  };
+
+  std::size_t unitCount(GLsizeiptr const size) const {
+    return static_cast<std::size_t>((size + _alignment - 1) / _alignment);
+  }
+
+  //! Allocations copied by defragment(), in units of the alignment.
+  struct CopyRun {
+    Page const* src;
+    Page const* dst;
+    std::size_t srcOffset;
+    std::size_t dstOffset;
+    std::size_t units;
+  };
+
+  std::unique_ptr<Page> makePage(std::size_t const units) const {
+    std::unique_ptr<Page> page(new Page);
+    page->buffer.reset(new Buffer<TargetT>(
+      static_cast<GLsizeiptr>(units) * _alignment, nullptr,
+      ImmutableStorage(GL_DYNAMIC_STORAGE_BIT)));
+    page->allocator = detail::TlsfAllocator(units);
+    return page;
+  }
+
+  Page* addPage(std::size_t const units) {
+    _pages.push_back(makePage(units));
+    return _pages.back().get();
+  }
+
+  Entry& liveEntry(Id const id) {
+    if (id >= _entries.size() || _entries[id].page == nullptr) {
+      NDJINN_THROW("invalid arena allocation: " << id);
+    }
+    return _entries[id];
+  }
+
+  Entry const& liveEntry(Id const id) const {
+    return const_cast<BufferArena*>(this)->liveEntry(id);
+  }
+
+  void copy(CopyRun const& run) const {
+    detail::namedCopyBufferSubData(
+      run.src->buffer->handle(), run.dst->buffer->handle(),
+      static_cast<GLintptr>(run.srcOffset) * _alignment,
+      static_cast<GLintptr>(run.dstOffset) * _alignment,
+      static_cast<GLsizeiptr>(run.units) * _alignment);
+  }
+
+  GLsizeiptr const _pageSize;
+  GLsizeiptr const _alignment;
+  std::vector<std::unique_ptr<Page>> _pages;
+  std::vector<Entry> _entries; //!< By id.
+  std::vector<Id> _freeIds;
+};
+
+NDJINN_END_NAMESPACE
+
+namespace std {
+
+inline
+ostream& operator<<(ostream& os, ndj::BufferArenaStats const& stats)
+{
+  os << "BufferArenaStats" << endl
+     << "  Pages: " << stats.pageCount << endl
+     << "  Allocations: " << stats.allocationCount << endl
+     << "  Capacity: " << stats.capacity << " [bytes]" << endl
+     << "  Used: " << stats.used << " [bytes]" << endl
+     << "  Free: " << stats.free() << " [bytes]" << endl
+     << "  Largest free: " << stats.largestFree << " [bytes]" << endl
+     << "  Free blocks: " << stats.freeBlockCount << endl
+     << "  Fragmentation: " << stats.fragmentation() << endl;
+  return os;
+}
+
+} // Namespace: std.
+
+#endif // NDJINN_BUFFER_ARENA_HPP_INCLUDED
@@ -0,0 +1,273 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+#ifndef NDJINN_DEBUG_HPP_INCLUDED
+#define NDJINN_DEBUG_HPP_INCLUDED
+
+#include <string>
+
+#include "nDjinnDispatch.hpp"
+#include "nDjinnError.hpp"
+#include "nDjinnException.hpp"
+#include "nDjinnFunctions.hpp"
+#include "nDjinnGL.hpp"
+#include "nDjinnNamespace.hpp"
+
+NDJINN_BEGIN_NAMESPACE
+
+// Resource classes that can be labeled, see objectLabel below.
+template <GLenum TargetT> class Buffer;
+class Framebuffer;
+class IndexedQuery;
+class Query;
+class Renderbuffer;
+class Sampler;
+template <GLenum Type> class Shader;
+class ShaderProgram;
+class Texture2D;
+class VertexArray;
+
+namespace detail {
+
+//! glDebugMessageCallback wrapper. May throw.
+inline void debugMessageCallback(GLDEBUGPROC const callback,
+                                 void const* userParam)
+{
+  NDJINN_GL(DebugMessageCallback)(callback, userParam);
+  checkError("glDebugMessageCallback");
+}
+
+//! glDebugMessageControl wrapper. May throw.
+inline void debugMessageControl(GLenum const source, GLenum const type,
+                                GLenum const severity, GLsizei const count,
+                                GLuint const* ids, GLboolean const enabled)
+{
+  NDJINN_GL(DebugMessageControl)(source, type, severity, count, ids, enabled);
+  checkError("glDebugMessageControl");
+}
+
+//! glPushDebugGroup wrapper. May throw.
+inline void pushDebugGroup(GLenum const source, GLuint const id,
+                           GLsizei const length, GLchar const* message)
+{
+  NDJINN_GL(PushDebugGroup)(source, id, length, message);
+  checkError("glPushDebugGroup");
+}
+
+//! glPopDebugGroup wrapper. May throw.
+inline void popDebugGroup()
+{
+  NDJINN_GL(PopDebugGroup)();
+  checkError("glPopDebugGroup");
+}
+
+//! glObjectLabel wrapper. May throw.
+inline void objectLabel(GLenum const identifier, GLuint const name,
+                        GLsizei const length, GLchar const* label)
+{
+  NDJINN_GL(ObjectLabel)(identifier, name, length, label);
+  checkError("glObjectLabel");
+}
+
+//! glGetObjectLabel wrapper. May throw.
+inline void getObjectLabel(GLenum const identifier, GLuint const name,
+                           GLsizei const bufSize, GLsizei* length,
+                           GLchar* label)
+{
+  NDJINN_GL(GetObjectLabel)(identifier, name, bufSize, length, label);
+  checkError("glGetObjectLabel");
+}
+
+//! Callback installed by DebugOutput. Must not throw since it is called
+//! from inside the driver, messages are queued and reported by the next
+//! checkError call, i.e. by the wrapper that triggered them. When the
+//! policy is NDJINN_ERROR_CHECK_NEVER nothing reports the queue, messages
+//! are passed to the sink right away without a caller name instead.
+inline void GLAPIENTRY debugCallback(GLenum const source, GLenum const type,
+                                     GLuint const id, GLenum const severity,
+                                     GLsizei const length,
+                                     GLchar const* message,
+                                     void const* userParam)
+{
+  (void)userParam;
+  try {
+    DebugMessage msg;
+    msg.source = source;
+    msg.type = type;
+    msg.id = id;
+    msg.severity = severity;
+    msg.error = (type == GL_DEBUG_TYPE_ERROR);
+    if (message != nullptr) {
+      msg.text = length < 0 ? std::string(message)
+                            : std::string(message, length);
+    }
+#if NDJINN_ERROR_CHECK == NDJINN_ERROR_CHECK_NEVER
+    DebugSink const& sink = debugSink();
+    if (sink) {
+      sink("", msg);
+    }
+#else
+    pendingDebugMessages().push_back(msg);
+#endif
+  }
+  catch (...) {
+    // Exceptions must not propagate through the driver, drop the message.
+  }
+}
+
+//! Object identifier used for labeling, specialized per resource class.
+template <class R>
+struct ObjectIdentifier;
+
+template <GLenum TargetT>
+struct ObjectIdentifier<Buffer<TargetT>> {
+  static GLenum const value = GL_BUFFER;
+};
+
+template <>
+struct ObjectIdentifier<Framebuffer> {
+  static GLenum const value = GL_FRAMEBUFFER;
+};
+
+template <>
+struct ObjectIdentifier<IndexedQuery> {
+  static GLenum const value = GL_QUERY;
+};
+
+template <>
+struct ObjectIdentifier<Query> {
+  static GLenum const value = GL_QUERY;
+};
+
+template <>
+struct ObjectIdentifier<Renderbuffer> {
+  static GLenum const value = GL_RENDERBUFFER;
+};
+
+template <>
+struct ObjectIdentifier<Sampler> {
+  static GLenum const value = GL_SAMPLER;
+};
+
+template <GLenum Type>
+struct ObjectIdentifier<Shader<Type>> {
+  static GLenum const value = GL_SHADER;
+};
+
+template <>
+struct ObjectIdentifier<ShaderProgram> {
+  static GLenum const value = GL_PROGRAM;
+};
+
+template <>
+struct ObjectIdentifier<Texture2D> {
+  static GLenum const value = GL_TEXTURE;
+};
+
+template <>
+struct ObjectIdentifier<VertexArray> {
+  static GLenum const value = GL_VERTEX_ARRAY;
+};
+
+} // Namespace: detail.
+
+//! Installs a synchronous debug output callback for the current context.
+//! Messages are attributed to the wrapper that triggered them and routed to
+//! @a sink, or thrown as exceptions if they report errors and no sink is
+//! given. Works with any error policy, combine with
+//! NDJINN_ERROR_CHECK_DEBUG_OUTPUT to stop polling glGetError altogether.
+//! With NDJINN_ERROR_CHECK_NEVER messages only reach the sink, nothing is
+//! thrown. Notifications are disabled since most drivers use them for
+//! chatty performance hints.
+class DebugOutput {
+public:
+  explicit DebugOutput(DebugSink const& sink = DebugSink())
+  {
+    detail::debugSink() = sink;
+    detail::pendingDebugMessages().clear();
+    enable(GL_DEBUG_OUTPUT);
+    enable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    detail::debugMessageControl(GL_DONT_CARE, GL_DONT_CARE,
+                                GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr,
+                                GL_FALSE);
+    detail::debugMessageCallback(&detail::debugCallback, nullptr);
+  }
+
+  //! DTOR. Errors while turning debug output off are ignored, the
+  //! context may already be gone.
+  ~DebugOutput()
+  {
+    try {
+      detail::debugMessageCallback(nullptr, nullptr);
+      disable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+      disable(GL_DEBUG_OUTPUT);
+    }
+    catch (...) {
+    }
+    detail::debugSink() = DebugSink();
+    detail::pendingDebugMessages().clear();
+  }
+
+private:
+  DebugOutput(DebugOutput const&); //!< Disabled copy.
+  DebugOutput& operator=(DebugOutput const&); //!< Disabled assign.
+};
+
+//! Scoped debug group, shows up in debug messages and in tools such as
+//! RenderDoc and apitrace.
+class DebugGroup {
+public:
+  explicit DebugGroup(std::string const& name, GLuint const id = 0)
+  {
+    detail::pushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, id,
+                           static_cast<GLsizei>(name.size()), name.c_str());
+  }
+
+  //! DTOR. Errors are ignored, destructors must not throw.
+  ~DebugGroup()
+  {
+    try {
+      detail::popDebugGroup();
+    }
+    catch (...) {
+    }
+  }
+
+private:
+  DebugGroup(DebugGroup const&); //!< Disabled copy.
+  DebugGroup& operator=(DebugGroup const&); //!< Disabled assign.
+};
+
+//! Attach a human readable label to a resource. May throw.
+template <class R> inline
+void setObjectLabel(R const& resource, std::string const& label)
+{
+  detail::objectLabel(detail::ObjectIdentifier<R>::value, resource.handle(),
+                      static_cast<GLsizei>(label.size()), label.c_str());
+}
+
+//! Returns the label attached to a resource. May throw.
+template <class R> inline
+std::string objectLabel(R const& resource)
+{
+  GLenum const identifier = detail::ObjectIdentifier<R>::value;
+  GLsizei length = 0;
+  detail::getObjectLabel(identifier, resource.handle(), 0, &length, nullptr);
+  std::string str;
+  if (length > 0) {
+    str.resize(length + 1);
+    detail::getObjectLabel(identifier, resource.handle(),
+                           static_cast<GLsizei>(str.size()), &length,
+                           &str[0]);
+    str.resize(length);
+  }
+  return str;
+}
+
+NDJINN_END_NAMESPACE
+
+#endif // NDJINN_DEBUG_HPP_INCLUDED
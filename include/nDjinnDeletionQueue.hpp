@@ -0,0 +1,139 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+#ifndef NDJINN_DELETION_QUEUE_HPP_INCLUDED
+#define NDJINN_DELETION_QUEUE_HPP_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "nDjinnGL.hpp"
+#include "nDjinnNamespace.hpp"
+
+NDJINN_BEGIN_NAMESPACE
+
+//! Names of destroyed resources, waiting to be deleted by the thread that
+//! owns the context. Threads without a context, e.g. asset streaming
+//! threads, make the queue of the context current with setCurrent(), after
+//! which destroying a Buffer, Texture2D, ShaderProgram or any other
+//! resource on that thread pushes its name to the queue instead of calling
+//! glDelete*. Pushing is lock-free. The context thread calls drain() at a
+//! safe point, e.g. at the end of a frame, which deletes the names with a
+//! single glDelete* call per type.
+//!
+//! On the context thread, HandlePools take precedence over a current
+//! queue. A HeadlessContext owns a queue and drains it before the context
+//! is destroyed, threads still pushing to it must be stopped first.
+class DeletionQueue {
+public:
+  typedef void (*DeleteFunction)(GLsizei, GLuint const*);
+
+  DeletionQueue()
+    : _head(nullptr)
+  {}
+
+  //! DTOR. Names still queued are leaked, since there may be no context.
+  ~DeletionQueue() {
+    Node* node = _head.exchange(nullptr, std::memory_order_acquire);
+    while (node != nullptr) {
+      Node* const next = node->next;
+      delete node;
+      node = next;
+    }
+  }
+
+  //! The queue that destroyed resources go to on the calling thread, null
+  //! if they are deleted right away (default).
+  static DeletionQueue* current() {
+    return currentRef();
+  }
+
+  //! Make @a queue the queue of the calling thread, null deletes resources
+  //! right away. Returns the previous queue.
+  static DeletionQueue* setCurrent(DeletionQueue* queue) {
+    DeletionQueue* const previous = currentRef();
+    currentRef() = queue;
+    return previous;
+  }
+
+  //! Queue @a name to be deleted with @a del. Thread-safe and lock-free.
+  void push(DeleteFunction const del, GLuint const name) {
+    Node* const node = new Node;
+    node->del = del;
+    node->name = name;
+    node->next = _head.load(std::memory_order_relaxed);
+    while (!_head.compare_exchange_weak(node->next, node,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+  }
+
+  //! True if nothing is queued. Only a hint while other threads push.
+  bool empty() const {
+    return _head.load(std::memory_order_relaxed) == nullptr;
+  }
+
+  //! Delete all queued names, one call per type. Must be called with the
+  //! context current. Returns the number of names deleted. May throw.
+  std::size_t drain() {
+    Node* node = _head.exchange(nullptr, std::memory_order_acquire);
+    if (node == nullptr) {
+      return 0;
+    }
+
+    std::vector<Batch> batches;
+    std::size_t count = 0;
+    while (node != nullptr) {
+      std::size_t i = 0;
+      while (i < batches.size() && batches[i].del != node->del) {
+        ++i;
+      }
+      if (i == batches.size()) {
+        batches.push_back(Batch());
+        batches.back().del = node->del;
+      }
+      batches[i].names.push_back(node->name);
+      ++count;
+      Node* const next = node->next;
+      delete node;
+      node = next;
+    }
+
+    for (std::size_t i = 0; i < batches.size(); ++i) {
+      batches[i].del(static_cast<GLsizei>(batches[i].names.size()),
+                     &batches[i].names[0]);
+    }
+    return count;
+  }
+
+private:
+  DeletionQueue(DeletionQueue const&); //!< Disabled copy.
+  DeletionQueue& operator=(DeletionQueue const&); //!< Disabled assign.
+
+  struct Node {
+    DeleteFunction del;
+    GLuint name;
+    Node* next;
+  };
+
+  struct Batch {
+    DeleteFunction del;
+    std::vector<GLuint> names;
+  };
+
+  static DeletionQueue*& currentRef() {
+    static thread_local DeletionQueue* current = nullptr;
+    return current;
+  }
+
+  std::atomic<Node*> _head; //!< Most recently pushed first.
+};
+
+NDJINN_END_NAMESPACE
+
+#endif // NDJINN_DELETION_QUEUE_HPP_INCLUDED
@@ -0,0 +1,817 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+#ifndef NDJINN_DISPATCH_HPP_INCLUDED
+#define NDJINN_DISPATCH_HPP_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "nDjinnException.hpp"
+#include "nDjinnGL.hpp"
+#include "nDjinnNamespace.hpp"
+
+// Every OpenGL entry point used by nDjinn, grouped by family. Each entry is
+// X(Family, Name), where glName is the OpenGL function.
+#define NDJINN_GL_FUNCTIONS(X) \
+  X(Buffer, BindBuffer) \
+  X(Buffer, BindBufferBase) \
+  X(Buffer, BindBufferRange) \
+  X(Buffer, BindBuffersBase) \
+  X(Buffer, BindBuffersRange) \
+  X(Buffer, ClearNamedBufferSubDataEXT) \
+  X(Buffer, DeleteBuffers) \
+  X(Buffer, FlushMappedNamedBufferRangeEXT) \
+  X(Buffer, GenBuffers) \
+  X(Buffer, GetNamedBufferParameterivEXT) \
+  X(Buffer, GetNamedBufferPointervEXT) \
+  X(Buffer, GetNamedBufferSubDataEXT) \
+  X(Buffer, InvalidateBufferData) \
+  X(Buffer, InvalidateBufferSubData) \
+  X(Buffer, IsBuffer) \
+  X(Buffer, MapNamedBufferEXT) \
+  X(Buffer, MapNamedBufferRangeEXT) \
+  X(Buffer, NamedBufferDataEXT) \
+  X(Buffer, NamedBufferStorageEXT) \
+  X(Buffer, NamedBufferSubDataEXT) \
+  X(Buffer, NamedCopyBufferSubDataEXT) \
+  X(Buffer, UnmapNamedBufferEXT) \
+  X(Debug, DebugMessageCallback) \
+  X(Debug, DebugMessageControl) \
+  X(Debug, GetObjectLabel) \
+  X(Debug, ObjectLabel) \
+  X(Debug, PopDebugGroup) \
+  X(Debug, PushDebugGroup) \
+  X(Error, GetError) \
+  X(Framebuffer, BindFramebuffer) \
+  X(Framebuffer, CheckNamedFramebufferStatusEXT) \
+  X(Framebuffer, Clear) \
+  X(Framebuffer, ClearBufferfi) \
+  X(Framebuffer, ClearBufferfv) \
+  X(Framebuffer, ClearBufferiv) \
+  X(Framebuffer, ClearBufferuiv) \
+  X(Framebuffer, ClearColor) \
+  X(Framebuffer, ClearDepth) \
+  X(Framebuffer, ClearDepthf) \
+  X(Framebuffer, ClearStencil) \
+  X(Framebuffer, DeleteFramebuffers) \
+  X(Framebuffer, DrawBuffer) \
+  X(Framebuffer, DrawBuffers) \
+  X(Framebuffer, FramebufferRenderbuffer) \
+  X(Framebuffer, FramebufferTextureLayer) \
+  X(Framebuffer, GenFramebuffers) \
+  X(Framebuffer, GetNamedFramebufferAttachmentParameterivEXT) \
+  X(Framebuffer, IsFramebuffer) \
+  X(Framebuffer, NamedFramebufferRenderbufferEXT) \
+  X(Framebuffer, NamedFramebufferTexture1DEXT) \
+  X(Framebuffer, NamedFramebufferTexture2DEXT) \
+  X(Framebuffer, NamedFramebufferTexture3DEXT) \
+  X(Framebuffer, NamedFramebufferTextureEXT) \
+  X(Framebuffer, ReadBuffer) \
+  X(Framebuffer, ReadPixels) \
+  X(Program, AttachShader) \
+  X(Program, CreateProgram) \
+  X(Program, DeleteProgram) \
+  X(Program, DetachShader) \
+  X(Program, GetActiveAttrib) \
+  X(Program, GetActiveUniform) \
+  X(Program, GetActiveUniformBlockName) \
+  X(Program, GetActiveUniformBlockiv) \
+  X(Program, GetActiveUniformsiv) \
+  X(Program, GetAttribLocation) \
+  X(Program, GetProgramInfoLog) \
+  X(Program, GetProgramiv) \
+  X(Program, GetUniformBlockIndex) \
+  X(Program, GetUniformLocation) \
+  X(Program, GetUniformdv) \
+  X(Program, GetUniformfv) \
+  X(Program, GetUniformiv) \
+  X(Program, GetUniformuiv) \
+  X(Program, IsProgram) \
+  X(Program, LinkProgram) \
+  X(Program, ProgramUniform1f) \
+  X(Program, ProgramUniform1fv) \
+  X(Program, ProgramUniform1i) \
+  X(Program, ProgramUniform1iv) \
+  X(Program, ProgramUniform2f) \
+  X(Program, ProgramUniform2fv) \
+  X(Program, ProgramUniform2i) \
+  X(Program, ProgramUniform2iv) \
+  X(Program, ProgramUniform3f) \
+  X(Program, ProgramUniform3fv) \
+  X(Program, ProgramUniform3i) \
+  X(Program, ProgramUniform3iv) \
+  X(Program, ProgramUniform4f) \
+  X(Program, ProgramUniform4fv) \
+  X(Program, ProgramUniform4i) \
+  X(Program, ProgramUniform4iv) \
+  X(Program, ProgramUniformMatrix2fv) \
+  X(Program, ProgramUniformMatrix2x3fv) \
+  X(Program, ProgramUniformMatrix2x4fv) \
+  X(Program, ProgramUniformMatrix3fv) \
+  X(Program, ProgramUniformMatrix3x2fv) \
+  X(Program, ProgramUniformMatrix3x4fv) \
+  X(Program, ProgramUniformMatrix4fv) \
+  X(Program, ProgramUniformMatrix4x2fv) \
+  X(Program, ProgramUniformMatrix4x3fv) \
+  X(Program, UniformBlockBinding) \
+  X(Program, UseProgram) \
+  X(Program, ValidateProgram) \
+  X(Query, BeginQuery) \
+  X(Query, BeginQueryIndexed) \
+  X(Query, DeleteQueries) \
+  X(Query, EndQuery) \
+  X(Query, EndQueryIndexed) \
+  X(Query, GenQueries) \
+  X(Query, GetQueryIndexediv) \
+  X(Query, GetQueryObjecti64v) \
+  X(Query, GetQueryObjectiv) \
+  X(Query, GetQueryObjectui64v) \
+  X(Query, GetQueryObjectuiv) \
+  X(Query, GetQueryiv) \
+  X(Query, IsQuery) \
+  X(Query, QueryCounter) \
+  X(Renderbuffer, BindRenderbuffer) \
+  X(Renderbuffer, DeleteRenderbuffers) \
+  X(Renderbuffer, GenRenderbuffers) \
+  X(Renderbuffer, GetNamedRenderbufferParameterivEXT) \
+  X(Renderbuffer, IsRenderbuffer) \
+  X(Renderbuffer, NamedRenderbufferStorageMultisampleEXT) \
+  X(Sampler, BindSampler) \
+  X(Sampler, BindSamplers) \
+  X(Sampler, DeleteSamplers) \
+  X(Sampler, GenSamplers) \
+  X(Sampler, GetSamplerParameterfv) \
+  X(Sampler, GetSamplerParameteriv) \
+  X(Sampler, IsSampler) \
+  X(Sampler, SamplerParameterf) \
+  X(Sampler, SamplerParameterfv) \
+  X(Sampler, SamplerParameteri) \
+  X(Sampler, SamplerParameteriv) \
+  X(Shader, CompileShader) \
+  X(Shader, CreateShader) \
+  X(Shader, DeleteShader) \
+  X(Shader, GetShaderInfoLog) \
+  X(Shader, GetShaderSource) \
+  X(Shader, GetShaderiv) \
+  X(Shader, IsShader) \
+  X(Shader, ShaderSource) \
+  X(State, BlendColor) \
+  X(State, BlendEquation) \
+  X(State, BlendEquationSeparate) \
+  X(State, BlendEquationSeparatei) \
+  X(State, BlendEquationi) \
+  X(State, BlendFunc) \
+  X(State, BlendFuncSeparate) \
+  X(State, BlendFuncSeparatei) \
+  X(State, BlendFunci) \
+  X(State, ColorMask) \
+  X(State, ColorMaski) \
+  X(State, CullFace) \
+  X(State, DepthFunc) \
+  X(State, DepthMask) \
+  X(State, DepthRange) \
+  X(State, Disable) \
+  X(State, Enable) \
+  X(State, FrontFace) \
+  X(State, GetBooleanv) \
+  X(State, GetDoublev) \
+  X(State, GetFloatv) \
+  X(State, GetInteger64v) \
+  X(State, GetIntegerv) \
+  X(State, GetString) \
+  X(State, IsEnabled) \
+  X(State, LineWidth) \
+  X(State, PolygonOffset) \
+  X(State, StencilFuncSeparate) \
+  X(State, StencilMask) \
+  X(State, StencilMaskSeparate) \
+  X(State, StencilOpSeparate) \
+  X(State, Viewport) \
+  X(Sync, ClientWaitSync) \
+  X(Sync, DeleteSync) \
+  X(Sync, FenceSync) \
+  X(Texture, ActiveTexture) \
+  X(Texture, BindImageTextures) \
+  X(Texture, BindMultiTextureEXT) \
+  X(Texture, BindTexture) \
+  X(Texture, BindTextures) \
+  X(Texture, CompressedTextureImage2DEXT) \
+  X(Texture, CompressedTextureSubImage2DEXT) \
+  X(Texture, CopyTextureImage2DEXT) \
+  X(Texture, CopyTextureSubImage2DEXT) \
+  X(Texture, DeleteTextures) \
+  X(Texture, GenTextures) \
+  X(Texture, GetCompressedTextureImageEXT) \
+  X(Texture, GetTextureImageEXT) \
+  X(Texture, GetTextureLevelParameterfvEXT) \
+  X(Texture, GetTextureLevelParameterivEXT) \
+  X(Texture, GetTextureParameterIivEXT) \
+  X(Texture, GetTextureParameterIuivEXT) \
+  X(Texture, GetTextureParameterfvEXT) \
+  X(Texture, GetTextureParameterivEXT) \
+  X(Texture, IsTexture) \
+  X(Texture, TextureImage2DEXT) \
+  X(Texture, TextureParameterIivEXT) \
+  X(Texture, TextureParameterIuivEXT) \
+  X(Texture, TextureParameterfEXT) \
+  X(Texture, TextureParameterfvEXT) \
+  X(Texture, TextureParameteriEXT) \
+  X(Texture, TextureParameterivEXT) \
+  X(Texture, TextureSubImage2DEXT) \
+  X(VertexArray, BindVertexArray) \
+  X(VertexArray, DeleteVertexArrays) \
+  X(VertexArray, DisableVertexAttribArray) \
+  X(VertexArray, DrawArrays) \
+  X(VertexArray, DrawArraysInstanced) \
+  X(VertexArray, DrawElements) \
+  X(VertexArray, DrawElementsBaseVertex) \
+  X(VertexArray, DrawElementsInstanced) \
+  X(VertexArray, DrawElementsInstancedBaseVertex) \
+  X(VertexArray, DrawRangeElements) \
+  X(VertexArray, EnableVertexAttribArray) \
+  X(VertexArray, GenVertexArrays) \
+  X(VertexArray, IsVertexArray) \
+  X(VertexArray, MultiDrawArraysIndirect) \
+  X(VertexArray, MultiDrawElementsIndirect) \
+  X(VertexArray, VertexAttribDivisor) \
+  X(VertexArray, VertexAttribIPointer) \
+  X(VertexArray, VertexAttribLPointer) \
+  X(VertexArray, VertexAttribPointer)
+
+// Wrappers call OpenGL through NDJINN_GL(Name)(...). By default this goes
+// through the current dispatch table, which makes it possible to swap in
+// the null or recording backends below. Define NDJINN_DISABLE_DISPATCH to
+// call OpenGL directly instead.
+#ifdef NDJINN_DISABLE_DISPATCH
+#define NDJINN_GL_FUNCTION(NAME) gl##NAME
+#else
+#define NDJINN_GL_FUNCTION(NAME) ::ndj::detail::dispatch().NAME
+#endif
+
+// Define NDJINN_STATS to 1 to count calls and measure the time spent in
+// each entry point, see nDjinnStats.hpp. Compiled out by default.
+#ifndef NDJINN_STATS
+#define NDJINN_STATS 0
+#endif
+
+#if NDJINN_STATS
+#define NDJINN_GL(NAME) \
+  ::ndj::detail::statsCall< ::ndj::DispatchIndex::NAME>(NDJINN_GL_FUNCTION(NAME))
+#else
+#define NDJINN_GL(NAME) NDJINN_GL_FUNCTION(NAME)
+#endif
+
+NDJINN_BEGIN_NAMESPACE
+
+//! Table of OpenGL function pointers, one member per entry in
+//! NDJINN_GL_FUNCTIONS, named without the gl prefix.
+struct Dispatch {
+#define NDJINN_DISPATCH_MEMBER(FAMILY, NAME) \
+  std::decay<decltype(gl##NAME)>::type NAME;
+  NDJINN_GL_FUNCTIONS(NDJINN_DISPATCH_MEMBER)
+#undef NDJINN_DISPATCH_MEMBER
+};
+
+//! Index of each entry point in NDJINN_GL_FUNCTIONS, DispatchIndex::COUNT
+//! is the number of entry points.
+struct DispatchIndex {
+  enum {
+#define NDJINN_DISPATCH_INDEX(FAMILY, NAME) NAME,
+    NDJINN_GL_FUNCTIONS(NDJINN_DISPATCH_INDEX)
+#undef NDJINN_DISPATCH_INDEX
+    COUNT
+  };
+};
+
+//! Returns the OpenGL name, e.g. "glBindBuffer", of an entry point.
+inline char const* dispatchName(std::size_t const index)
+{
+  static char const* const names[] = {
+#define NDJINN_DISPATCH_NAME(FAMILY, NAME) "gl" #NAME,
+    NDJINN_GL_FUNCTIONS(NDJINN_DISPATCH_NAME)
+#undef NDJINN_DISPATCH_NAME
+  };
+  return index < DispatchIndex::COUNT ? names[index] : "";
+}
+
+//! Returns the family, e.g. "Buffer", of an entry point.
+inline char const* dispatchFamily(std::size_t const index)
+{
+  static char const* const families[] = {
+#define NDJINN_DISPATCH_FAMILY(FAMILY, NAME) #FAMILY,
+    NDJINN_GL_FUNCTIONS(NDJINN_DISPATCH_FAMILY)
+#undef NDJINN_DISPATCH_FAMILY
+  };
+  return index < DispatchIndex::COUNT ? families[index] : "";
+}
+
+//! Returns a table pointing to the OpenGL implementation. When using GLEW
+//! this must be called after glewInit().
+inline Dispatch realDispatch()
+{
+  Dispatch d;
+#define NDJINN_DISPATCH_REAL(FAMILY, NAME) d.NAME = gl##NAME;
+  NDJINN_GL_FUNCTIONS(NDJINN_DISPATCH_REAL)
+#undef NDJINN_DISPATCH_REAL
+  return d;
+}
+
+namespace detail {
+
+//! The real table, loaded on first use.
+inline Dispatch& realDispatchTable()
+{
+  static Dispatch table = realDispatch();
+  return table;
+}
+
+//! Table used by the wrappers on the calling thread, null means the real
+//! table. Per thread, so that a thread swapping tables, e.g. for the null
+//! backend, does not redirect the calls of other threads.
+inline Dispatch const*& currentDispatch()
+{
+  static thread_local Dispatch const* current = nullptr;
+  return current;
+}
+
+//! Table used by the wrappers.
+inline Dispatch const& dispatch()
+{
+  Dispatch const* const current = currentDispatch();
+  return current != nullptr ? *current : realDispatchTable();
+}
+
+// Null backend.
+
+//! Canned state so that resource classes behave sensibly without a context,
+//! e.g. generated names are unique and mapped buffers point to memory.
+struct NullState {
+  NullState()
+    : nextName(1)
+  {}
+
+  GLuint nextName;
+  std::map<GLuint, GLenum> shaderTypes;
+  std::map<GLuint, std::vector<unsigned char>> buffers;
+};
+
+//! Per thread, like the installed table, so that threads using the null
+//! backend do not race on it.
+inline NullState& nullState()
+{
+  static thread_local NullState state;
+  return state;
+}
+
+//! Default null implementation, does nothing and returns a value
+//! initialized result.
+template <typename F>
+struct NullStub;
+
+template <typename R, typename... A>
+struct NullStub<R (GLAPIENTRY*)(A...)> {
+  static R GLAPIENTRY call(A...) {
+    return R();
+  }
+};
+
+inline void GLAPIENTRY nullGenNames(GLsizei const n, GLuint* names)
+{
+  for (GLsizei i = 0; i < n; ++i) {
+    names[i] = nullState().nextName++;
+  }
+}
+
+inline void GLAPIENTRY nullDeleteBuffers(GLsizei const n,
+                                         GLuint const* buffers)
+{
+  for (GLsizei i = 0; i < n; ++i) {
+    nullState().buffers.erase(buffers[i]);
+  }
+}
+
+inline GLuint GLAPIENTRY nullCreateProgram()
+{
+  return nullState().nextName++;
+}
+
+inline GLuint GLAPIENTRY nullCreateShader(GLenum const type)
+{
+  GLuint const shader = nullState().nextName++;
+  nullState().shaderTypes[shader] = type;
+  return shader;
+}
+
+inline void GLAPIENTRY nullDeleteShader(GLuint const shader)
+{
+  nullState().shaderTypes.erase(shader);
+}
+
+inline GLboolean GLAPIENTRY nullIsName(GLuint const name)
+{
+  return name != 0 ? GL_TRUE : GL_FALSE;
+}
+
+inline GLenum GLAPIENTRY nullCheckNamedFramebufferStatus(GLuint, GLenum)
+{
+  return GL_FRAMEBUFFER_COMPLETE;
+}
+
+inline void GLAPIENTRY nullGetShaderiv(GLuint const shader, GLenum const pname,
+                                       GLint* params)
+{
+  switch (pname) {
+  case GL_SHADER_TYPE:
+    *params = static_cast<GLint>(nullState().shaderTypes[shader]);
+    break;
+  case GL_COMPILE_STATUS:
+    *params = GL_TRUE;
+    break;
+  default:
+    *params = 0;
+  }
+}
+
+inline void GLAPIENTRY nullGetProgramiv(GLuint, GLenum const pname,
+                                        GLint* params)
+{
+  switch (pname) {
+  case GL_LINK_STATUS:
+  case GL_VALIDATE_STATUS:
+    *params = GL_TRUE;
+    break;
+  default:
+    *params = 0;
+  }
+}
+
+inline void GLAPIENTRY nullNamedBufferData(GLuint const buffer,
+                                           GLsizeiptr const size,
+                                           GLvoid const*, GLenum)
+{
+  nullState().buffers[buffer].resize(static_cast<std::size_t>(size));
+}
+
+inline GLvoid* GLAPIENTRY nullMapNamedBuffer(GLuint const buffer, GLenum)
+{
+  std::vector<unsigned char>& store = nullState().buffers[buffer];
+  return store.empty() ? nullptr : &store[0];
+}
+
+inline void GLAPIENTRY nullNamedBufferStorage(GLuint const buffer,
+                                              GLsizeiptr const size,
+                                              GLvoid const*, GLbitfield)
+{
+  nullState().buffers[buffer].resize(static_cast<std::size_t>(size));
+}
+
+inline GLvoid* GLAPIENTRY nullMapNamedBufferRange(GLuint const buffer,
+                                                  GLintptr const offset,
+                                                  GLsizeiptr, GLbitfield)
+{
+  std::vector<unsigned char>& store = nullState().buffers[buffer];
+  return store.empty() ? nullptr : &store[static_cast<std::size_t>(offset)];
+}
+
+inline void GLAPIENTRY nullNamedCopyBufferSubData(GLuint const readBuffer,
+                                                  GLuint const writeBuffer,
+                                                  GLintptr const readOffset,
+                                                  GLintptr const writeOffset,
+                                                  GLsizeiptr const size)
+{
+  std::vector<unsigned char>& src = nullState().buffers[readBuffer];
+  std::vector<unsigned char>& dst = nullState().buffers[writeBuffer];
+  if (readOffset + size <= static_cast<GLintptr>(src.size()) &&
+      writeOffset + size <= static_cast<GLintptr>(dst.size())) {
+    std::copy(src.begin() + readOffset, src.begin() + readOffset + size,
+              dst.begin() + writeOffset);
+  }
+}
+
+inline GLboolean GLAPIENTRY nullUnmapNamedBuffer(GLuint)
+{
+  return GL_TRUE;
+}
+
+inline void GLAPIENTRY nullGetNamedBufferParameteriv(GLuint const buffer,
+                                                     GLenum const pname,
+                                                     GLint* params)
+{
+  *params = pname == GL_BUFFER_SIZE
+    ? static_cast<GLint>(nullState().buffers[buffer].size()) : 0;
+}
+
+//! Fences are never pending.
+inline GLsync GLAPIENTRY nullFenceSync(GLenum, GLbitfield)
+{
+  return reinterpret_cast<GLsync>(
+    static_cast<std::uintptr_t>(nullState().nextName++));
+}
+
+inline GLenum GLAPIENTRY nullClientWaitSync(GLsync, GLbitfield, GLuint64)
+{
+  return GL_ALREADY_SIGNALED;
+}
+
+inline GLubyte const* GLAPIENTRY nullGetString(GLenum)
+{
+  return reinterpret_cast<GLubyte const*>("nDjinn null backend");
+}
+
+// Recording backend.
+
+class RecordingDispatchBase {
+public:
+  //! The recording table currently receiving calls on the calling thread,
+  //! see RecordingDispatch.
+  static RecordingDispatchBase*& active() {
+    static thread_local RecordingDispatchBase* active = nullptr;
+    return active;
+  }
+
+  void record(std::size_t const index) {
+    ++_counts[index];
+  }
+
+  Dispatch const& target() const {
+    return _target;
+  }
+
+protected:
+  explicit RecordingDispatchBase(Dispatch const& target)
+    : _target(target)
+    , _counts(DispatchIndex::COUNT, 0)
+  {}
+
+  Dispatch _target;
+  std::vector<std::size_t> _counts;
+};
+
+//! Counts the call and forwards it to the target table.
+template <typename F, F Dispatch::*M, std::size_t I>
+struct RecordStub;
+
+template <typename R, typename... A, R (GLAPIENTRY* Dispatch::*M)(A...),
+          std::size_t I>
+struct RecordStub<R (GLAPIENTRY*)(A...), M, I> {
+  static R GLAPIENTRY call(A... args) {
+    RecordingDispatchBase* const recorder = RecordingDispatchBase::active();
+    recorder->record(I);
+    return (recorder->target().*M)(args...);
+  }
+};
+
+// Statistics, see NDJINN_STATS.
+
+//! Number of latency histogram buckets, bucket i counts calls that took
+//! [2^i, 2^(i+1)) nanoseconds.
+static std::size_t const STATS_HISTOGRAM_SIZE = 32;
+
+struct StatsCounter {
+  StatsCounter()
+    : calls(0)
+    , nanoseconds(0)
+  {
+    histogram.fill(0);
+  }
+
+  std::uint64_t calls;
+  std::uint64_t nanoseconds;
+  std::array<std::uint64_t, STATS_HISTOGRAM_SIZE> histogram;
+};
+
+//! One counter per entry point. Contexts are current on one thread at a
+//! time, so counters are per thread.
+inline std::vector<StatsCounter>& statsCounters()
+{
+  static thread_local std::vector<StatsCounter> counters(DispatchIndex::COUNT);
+  return counters;
+}
+
+//! Adds the life-time of the timer to the counter of an entry point.
+class StatsTimer {
+public:
+  explicit StatsTimer(std::size_t const index)
+    : _index(index)
+    , _begin(std::chrono::steady_clock::now())
+  {}
+
+  ~StatsTimer() {
+    std::uint64_t const ns = static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - _begin).count());
+    std::size_t bucket = 0;
+    while (bucket + 1 < STATS_HISTOGRAM_SIZE && (ns >> (bucket + 1)) != 0) {
+      ++bucket;
+    }
+    StatsCounter& counter = statsCounters()[_index];
+    ++counter.calls;
+    counter.nanoseconds += ns;
+    ++counter.histogram[bucket];
+  }
+
+private:
+  StatsTimer(StatsTimer const&); //!< Disabled copy.
+  StatsTimer& operator=(StatsTimer const&); //!< Disabled assign.
+
+  std::size_t _index;
+  std::chrono::steady_clock::time_point _begin;
+};
+
+//! Wraps an entry point so that calls are timed, see NDJINN_GL.
+template <std::size_t I, typename F>
+class StatsCall;
+
+template <std::size_t I, typename R, typename... A>
+class StatsCall<I, R (GLAPIENTRY*)(A...)> {
+public:
+  explicit StatsCall(R (GLAPIENTRY* function)(A...))
+    : _function(function)
+  {}
+
+  R operator()(A... args) const {
+    StatsTimer const timer(I);
+    return _function(args...);
+  }
+
+private:
+  R (GLAPIENTRY* _function)(A...);
+};
+
+template <std::size_t I, typename F> inline
+StatsCall<I, typename std::decay<F>::type> statsCall(F const& function)
+{
+  return StatsCall<I, typename std::decay<F>::type>(function);
+}
+
+} // Namespace: detail.
+
+//! Returns a table that never touches OpenGL. Generated names are unique,
+//! status queries report success and mapped buffers point to client memory,
+//! which is enough to exercise the resource classes without a context.
+inline Dispatch const& nullDispatch()
+{
+  struct Table {
+    Table() {
+#define NDJINN_DISPATCH_NULL(FAMILY, NAME) \
+      d.NAME = &detail::NullStub<decltype(d.NAME)>::call;
+      NDJINN_GL_FUNCTIONS(NDJINN_DISPATCH_NULL)
+#undef NDJINN_DISPATCH_NULL
+      d.GenBuffers = &detail::nullGenNames;
+      d.GenFramebuffers = &detail::nullGenNames;
+      d.GenQueries = &detail::nullGenNames;
+      d.GenRenderbuffers = &detail::nullGenNames;
+      d.GenSamplers = &detail::nullGenNames;
+      d.GenTextures = &detail::nullGenNames;
+      d.GenVertexArrays = &detail::nullGenNames;
+      d.DeleteBuffers = &detail::nullDeleteBuffers;
+      d.CreateProgram = &detail::nullCreateProgram;
+      d.CreateShader = &detail::nullCreateShader;
+      d.DeleteShader = &detail::nullDeleteShader;
+      d.IsBuffer = &detail::nullIsName;
+      d.IsFramebuffer = &detail::nullIsName;
+      d.IsProgram = &detail::nullIsName;
+      d.IsQuery = &detail::nullIsName;
+      d.IsRenderbuffer = &detail::nullIsName;
+      d.IsSampler = &detail::nullIsName;
+      d.IsShader = &detail::nullIsName;
+      d.IsTexture = &detail::nullIsName;
+      d.IsVertexArray = &detail::nullIsName;
+      d.CheckNamedFramebufferStatusEXT =
+        &detail::nullCheckNamedFramebufferStatus;
+      d.GetShaderiv = &detail::nullGetShaderiv;
+      d.GetProgramiv = &detail::nullGetProgramiv;
+      d.NamedBufferDataEXT = &detail::nullNamedBufferData;
+      d.NamedBufferStorageEXT = &detail::nullNamedBufferStorage;
+      d.MapNamedBufferEXT = &detail::nullMapNamedBuffer;
+      d.MapNamedBufferRangeEXT = &detail::nullMapNamedBufferRange;
+      d.NamedCopyBufferSubDataEXT = &detail::nullNamedCopyBufferSubData;
+      d.UnmapNamedBufferEXT = &detail::nullUnmapNamedBuffer;
+      d.GetNamedBufferParameterivEXT = &detail::nullGetNamedBufferParameteriv;
+      d.FenceSync = &detail::nullFenceSync;
+      d.ClientWaitSync = &detail::nullClientWaitSync;
+      d.GetString = &detail::nullGetString;
+    }
+    Dispatch d;
+  };
+  static Table const table;
+  return table.d;
+}
+
+//! Reload the real table, e.g. after creating a new context. When using
+//! GLEW this must be called after glewInit().
+inline void loadDispatch()
+{
+  detail::realDispatchTable() = realDispatch();
+}
+
+//! Install a table to be used by the wrappers on the calling thread, null
+//! restores the real table. The table must outlive its use. Returns the
+//! previous table.
+inline Dispatch const* setDispatch(Dispatch const* dispatch)
+{
+  Dispatch const* const previous = detail::currentDispatch();
+  detail::currentDispatch() = dispatch;
+  return previous;
+}
+
+//! Installs a table for the life-time of the scope.
+class DispatchScope {
+public:
+  explicit DispatchScope(Dispatch const& dispatch)
+    : _previous(setDispatch(&dispatch))
+  {}
+
+  ~DispatchScope() {
+    setDispatch(_previous);
+  }
+
+private:
+  DispatchScope(DispatchScope const&); //!< Disabled copy.
+  DispatchScope& operator=(DispatchScope const&); //!< Disabled assign.
+
+  Dispatch const* _previous;
+};
+
+//! Counts calls per entry point and forwards them to a target table,
+//! typically nullDispatch() to measure CPU-side wrapper throughput. Only
+//! one recording table may exist at a time per thread, and it must be used
+//! and destroyed on the thread that created it.
+class RecordingDispatch : public detail::RecordingDispatchBase {
+public:
+  typedef std::map<std::string, std::size_t> FamilyCounts;
+
+  explicit RecordingDispatch(Dispatch const& target = nullDispatch())
+    : detail::RecordingDispatchBase(target)
+  {
+    if (active() != nullptr) {
+      NDJINN_THROW("only one RecordingDispatch may exist per thread");
+    }
+    active() = this;
+#define NDJINN_DISPATCH_RECORD(FAMILY, NAME) \
+    _dispatch.NAME = &detail::RecordStub< \
+      decltype(Dispatch::NAME), &Dispatch::NAME, DispatchIndex::NAME>::call;
+    NDJINN_GL_FUNCTIONS(NDJINN_DISPATCH_RECORD)
+#undef NDJINN_DISPATCH_RECORD
+  }
+
+  ~RecordingDispatch() {
+    active() = nullptr;
+  }
+
+  //! Table to install, e.g. with a DispatchScope.
+  Dispatch const& dispatch() const {
+    return _dispatch;
+  }
+
+  //! Number of calls to the entry point with the given DispatchIndex.
+  std::size_t callCount(std::size_t const index) const {
+    return index < _counts.size() ? _counts[index] : 0;
+  }
+
+  //! Total number of calls.
+  std::size_t totalCallCount() const {
+    std::size_t total = 0;
+    for (auto iter = _counts.begin(); iter != _counts.end(); ++iter) {
+      total += *iter;
+    }
+    return total;
+  }
+
+  //! Number of calls per family, see NDJINN_GL_FUNCTIONS.
+  FamilyCounts familyCallCounts() const {
+    FamilyCounts counts;
+    for (std::size_t i = 0; i < _counts.size(); ++i) {
+      if (_counts[i] > 0) {
+        counts[dispatchFamily(i)] += _counts[i];
+      }
+    }
+    return counts;
+  }
+
+  void reset() {
+    std::fill(_counts.begin(), _counts.end(), 0);
+  }
+
+private:
+  RecordingDispatch(RecordingDispatch const&); //!< Disabled copy.
+  RecordingDispatch& operator=(RecordingDispatch const&); //!< Disabled assign.
+
+  Dispatch _dispatch;
+};
+
+NDJINN_END_NAMESPACE
+
+#endif // NDJINN_DISPATCH_HPP_INCLUDED
@@ -0,0 +1,470 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+#ifndef NDJINN_DRAW_QUEUE_HPP_INCLUDED
+#define NDJINN_DRAW_QUEUE_HPP_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "nDjinnException.hpp"
+#include "nDjinnFunctions.hpp"
+#include "nDjinnGL.hpp"
+#include "nDjinnNamespace.hpp"
+#include "nDjinnPipelineState.hpp"
+#include "nDjinnSampler.hpp"
+#include "nDjinnShaderProgram.hpp"
+#include "nDjinnTexture.hpp"
+#include "nDjinnVertexArray.hpp"
+
+NDJINN_BEGIN_NAMESPACE
+
+namespace detail {
+
+//! Textures and samplers of texture units 0 to count - 1.
+struct DrawTextureSet {
+  static std::size_t const MAX_UNITS = 16;
+
+  DrawTextureSet()
+    : count(0)
+  {
+    textures.fill(0);
+    samplers.fill(0);
+  }
+
+  bool operator==(DrawTextureSet const& rhs) const {
+    return count == rhs.count && textures == rhs.textures &&
+           samplers == rhs.samplers;
+  }
+
+  GLuint count;
+  std::array<GLuint, MAX_UNITS> textures;
+  std::array<GLuint, MAX_UNITS> samplers;
+};
+
+struct DrawTextureSetHash {
+  std::size_t operator()(DrawTextureSet const& set) const {
+    std::size_t seed = 0;
+    hashCombine(seed, set.count);
+    for (GLuint i = 0; i < set.count; ++i) {
+      hashCombine(seed, set.textures[i]);
+      hashCombine(seed, set.samplers[i]);
+    }
+    return seed;
+  }
+};
+
+//! Sets a uniform from words stored in a DrawQueue.
+typedef void (*DrawUniformSetter)(GLuint program, GLint location,
+                                  GLsizei count, GLboolean transpose,
+                                  void const* value);
+
+template <int D, class T> inline
+void setDrawUniformv(GLuint const program, GLint const location,
+                     GLsizei const count, GLboolean,
+                     void const* value)
+{
+  programUniformv<D, T>(program, location, count,
+                        static_cast<T const*>(value));
+}
+
+template <int R, int C> inline
+void setDrawUniformMatrixfv(GLuint const program, GLint const location,
+                            GLsizei const count, GLboolean const transpose,
+                            void const* value)
+{
+  programUniformMatrixfv<R, C>(program, location, count, transpose,
+                               static_cast<GLfloat const*>(value));
+}
+
+struct DrawUniform {
+  DrawUniformSetter setter;
+  GLint location;
+  GLsizei count;
+  GLboolean transpose;
+  std::size_t offset; //!< In words.
+};
+
+struct DrawItem {
+  std::uint64_t key;
+  GLuint program;
+  GLuint vertexArray;
+  std::uint32_t state; //!< Index into the queue's states.
+  std::uint32_t textures; //!< Index into the queue's texture sets.
+  std::uint32_t uniformBegin;
+  std::uint32_t uniformEnd;
+  GLenum mode;
+  GLint first;
+  GLsizei count;
+  GLenum indexType; //!< Zero for non-indexed draws.
+  GLintptr indexOffset;
+  GLsizei instanceCount;
+};
+
+//! Returns the index of @a value in @a values, adding it if needed.
+template <typename T, typename Map> inline
+std::uint32_t internDrawValue(T const& value, Map& indices,
+                              std::vector<T>& values)
+{
+  auto const result = indices.insert(
+    std::make_pair(value, static_cast<std::uint32_t>(values.size())));
+  if (result.second) {
+    values.push_back(value);
+  }
+  return result.first->second;
+}
+
+} // Namespace: detail.
+
+//! Collects draws in whatever order they are produced, then sorts and
+//! submits them so that program, pipeline state, texture and vertex array
+//! changes are few. Each draw is described between begin() and one of the
+//! draw calls:
+//!
+//!   queue.begin(program, vertexArray, opaqueState);
+//!   queue.texture(0, diffuse.handle(), sampler.handle());
+//!   queue.uniformMatrixfv<4, 4>(modelUniform, GL_FALSE, model);
+//!   queue.drawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+//!   ...
+//!   queue.submit();
+//!   queue.clear();
+//!
+//! Draws are ordered by a 64-bit key, most significant bits first: layer
+//! (8 bits), program (14), pipeline state (12), texture set (18) and
+//! vertex array (12). Programs, states, texture sets and vertex arrays are
+//! numbered in order of first use, numbers that do not fit wrap around,
+//! which only makes the order less optimal. The sort is stable, so draws
+//! with equal keys keep their order. Use layers for passes that must come
+//! in order, e.g. opaque before transparent.
+//!
+//! Resources must stay alive until the queue is submitted. Texture units
+//! used by a draw are bound with glBindTextures/glBindSamplers starting at
+//! unit 0.
+class DrawQueue {
+public:
+  typedef std::uint64_t Key;
+
+  static std::size_t const MAX_TEXTURE_UNITS =
+    detail::DrawTextureSet::MAX_UNITS;
+
+  //! Number of state changes made by submit().
+  struct SubmitStats {
+    SubmitStats()
+      : draws(0)
+      , programChanges(0)
+      , stateChanges(0)
+      , textureChanges(0)
+      , vertexArrayChanges(0)
+    {}
+
+    std::size_t draws;
+    std::size_t programChanges;
+    std::size_t stateChanges;
+    std::size_t textureChanges;
+    std::size_t vertexArrayChanges;
+  };
+
+  DrawQueue()
+    : _open(false)
+  {}
+
+  //! Start describing a draw. May throw.
+  void begin(ShaderProgram const& program,
+             VertexArray const& vertexArray,
+             PipelineState const& state,
+             std::uint8_t const layer = 0) {
+    if (_open) {
+      NDJINN_THROW("draw queue item not ended");
+    }
+    _open = true;
+    _item = detail::DrawItem();
+    _item.key = static_cast<Key>(layer) << 56;
+    _item.program = program.handle();
+    _item.vertexArray = vertexArray.handle();
+    _item.state = detail::internDrawValue(state, _stateIndices, _states);
+    _item.uniformBegin = static_cast<std::uint32_t>(_uniforms.size());
+    _textureSet = detail::DrawTextureSet();
+  }
+
+  //! Bind @a texture and @a sampler to texture @a unit (an index, not
+  //! GL_TEXTUREi) for the current draw. May throw.
+  void texture(GLuint const unit, GLuint const texture,
+               GLuint const sampler = 0) {
+    throwIfNotOpen();
+    if (unit >= MAX_TEXTURE_UNITS) {
+      NDJINN_THROW("invalid draw queue texture unit: " << unit);
+    }
+    _textureSet.textures[unit] = texture;
+    _textureSet.samplers[unit] = sampler;
+    _textureSet.count = std::max(_textureSet.count, unit + 1);
+  }
+
+  //! Set a uniform for the current draw, see
+  //! ShaderProgram::setUniformv. The values are copied. May throw.
+  template <int D, class T>
+  void uniformv(Uniform const& uni, T const* v) {
+    addUniform(&detail::setDrawUniformv<D, T>, uni, GL_FALSE, v,
+               D * uni.size);
+  }
+
+  //! Set a matrix uniform for the current draw, see
+  //! ShaderProgram::setUniformMatrixfv. The values are copied. May throw.
+  template <int R, int C>
+  void uniformMatrixfv(Uniform const& uni, GLboolean const transpose,
+                       GLfloat const* v) {
+    addUniform(&detail::setDrawUniformMatrixfv<R, C>, uni, transpose, v,
+               R * C * uni.size);
+  }
+
+  //! End the current draw as glDrawArraysInstanced. May throw.
+  void drawArrays(GLenum const mode, GLint const first, GLsizei const count,
+                  GLsizei const instanceCount = 1) {
+    end(mode, first, count, 0, 0, instanceCount);
+  }
+
+  //! End the current draw as glDrawElementsInstanced, @a offset is in
+  //! bytes into the element array buffer of the vertex array. May throw.
+  void drawElements(GLenum const mode, GLsizei const count, GLenum const type,
+                    GLintptr const offset, GLsizei const instanceCount = 1) {
+    end(mode, 0, count, type, offset, instanceCount);
+  }
+
+  //! Number of queued draws.
+  std::size_t size() const {
+    return _items.size();
+  }
+
+  bool empty() const {
+    return _items.empty();
+  }
+
+  //! Sort key of the i'th queued draw, in the order of queuing.
+  Key key(std::size_t const i) const {
+    return _items[i].key;
+  }
+
+  //! Indices of the queued draws in submission order, valid after sort().
+  std::vector<std::uint32_t> order() const {
+    std::vector<std::uint32_t> indices(_sorted.size());
+    for (std::size_t i = 0; i < _sorted.size(); ++i) {
+      indices[i] = _sorted[i].index;
+    }
+    return indices;
+  }
+
+  //! Radix sort the queued draws by key. Passes over bytes that are the
+  //! same for all keys are skipped.
+  void sort() {
+    std::size_t const n = _items.size();
+    _sorted.resize(n);
+    _scratch.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      _sorted[i].key = _items[i].key;
+      _sorted[i].index = static_cast<std::uint32_t>(i);
+    }
+    for (unsigned shift = 0; shift < 64 && n > 1; shift += 8) {
+      std::array<std::size_t, 256> offsets;
+      offsets.fill(0);
+      for (std::size_t i = 0; i < n; ++i) {
+        ++offsets[(_sorted[i].key >> shift) & 0xff];
+      }
+      if (offsets[(_sorted[0].key >> shift) & 0xff] == n) {
+        continue;
+      }
+      std::size_t sum = 0;
+      for (std::size_t b = 0; b < offsets.size(); ++b) {
+        std::size_t const count = offsets[b];
+        offsets[b] = sum;
+        sum += count;
+      }
+      for (std::size_t i = 0; i < n; ++i) {
+        _scratch[offsets[(_sorted[i].key >> shift) & 0xff]++] = _sorted[i];
+      }
+      _sorted.swap(_scratch);
+    }
+  }
+
+  //! Sort and issue the queued draws. The queue is left as is, call clear()
+  //! before queuing the next frame. May throw.
+  SubmitStats submit() {
+    if (_open) {
+      NDJINN_THROW("draw queue item not ended");
+    }
+    sort();
+
+    SubmitStats stats;
+    detail::DrawItem const* previous = nullptr;
+    for (auto iter = _sorted.begin(); iter != _sorted.end(); ++iter) {
+      detail::DrawItem const& item = _items[iter->index];
+      if (previous == nullptr) {
+        _states[item.state].apply();
+      }
+      else if (item.state != previous->state) {
+        _states[item.state].apply(_states[previous->state]);
+      }
+      if (previous == nullptr || item.state != previous->state) {
+        ++stats.stateChanges;
+      }
+      if (previous == nullptr || item.program != previous->program) {
+        detail::useProgram(item.program);
+        ++stats.programChanges;
+      }
+      if (previous == nullptr || item.vertexArray != previous->vertexArray) {
+        detail::bindVertexArray(item.vertexArray);
+        ++stats.vertexArrayChanges;
+      }
+      if (previous == nullptr || item.textures != previous->textures) {
+        bindTextureSet(_textureSets[item.textures],
+                       previous != nullptr ?
+                         _textureSets[previous->textures].count : 0);
+        ++stats.textureChanges;
+      }
+      for (std::uint32_t i = item.uniformBegin; i < item.uniformEnd; ++i) {
+        detail::DrawUniform const& uniform = _uniforms[i];
+        uniform.setter(item.program, uniform.location, uniform.count,
+                       uniform.transpose, &_uniformWords[uniform.offset]);
+      }
+      draw(item);
+      ++stats.draws;
+      previous = &item;
+    }
+    return stats;
+  }
+
+  //! Remove all queued draws.
+  void clear() {
+    _open = false;
+    _items.clear();
+    _sorted.clear();
+    _uniforms.clear();
+    _uniformWords.clear();
+    _states.clear();
+    _stateIndices.clear();
+    _textureSets.clear();
+    _textureSetIndices.clear();
+    _programIndices.clear();
+    _vertexArrayIndices.clear();
+  }
+
+private:
+  DrawQueue(DrawQueue const&); //!< Disabled copy.
+  DrawQueue& operator=(DrawQueue const&); //!< Disabled assign.
+
+  struct SortEntry {
+    Key key;
+    std::uint32_t index;
+  };
+
+  void throwIfNotOpen() const {
+    if (!_open) {
+      NDJINN_THROW("draw queue item not begun");
+    }
+  }
+
+  template <class T>
+  void addUniform(detail::DrawUniformSetter const setter,
+                  Uniform const& uni, GLboolean const transpose,
+                  T const* v, std::size_t const words) {
+    static_assert(sizeof(T) == sizeof(std::uint32_t),
+                  "uniform components must be 32 bits");
+    throwIfNotOpen();
+    detail::DrawUniform uniform;
+    uniform.setter = setter;
+    uniform.location = uni.location;
+    uniform.count = uni.size;
+    uniform.transpose = transpose;
+    uniform.offset = _uniformWords.size();
+    _uniformWords.resize(_uniformWords.size() + words);
+    if (words > 0) {
+      std::memcpy(&_uniformWords[uniform.offset], v, words * sizeof(T));
+    }
+    _uniforms.push_back(uniform);
+  }
+
+  void end(GLenum const mode, GLint const first, GLsizei const count,
+           GLenum const indexType, GLintptr const indexOffset,
+           GLsizei const instanceCount) {
+    throwIfNotOpen();
+    _item.textures = detail::internDrawValue(_textureSet, _textureSetIndices,
+                                             _textureSets);
+    _item.uniformEnd = static_cast<std::uint32_t>(_uniforms.size());
+    _item.mode = mode;
+    _item.first = first;
+    _item.count = count;
+    _item.indexType = indexType;
+    _item.indexOffset = indexOffset;
+    _item.instanceCount = instanceCount;
+
+    Key const program = index(_programIndices, _item.program);
+    Key const vertexArray = index(_vertexArrayIndices, _item.vertexArray);
+    _item.key |= (program & 0x3fff) << 42;
+    _item.key |= (static_cast<Key>(_item.state) & 0xfff) << 30;
+    _item.key |= (static_cast<Key>(_item.textures) & 0x3ffff) << 12;
+    _item.key |= vertexArray & 0xfff;
+    _items.push_back(_item);
+    _open = false;
+  }
+
+  //! Number of @a name in order of first use.
+  static Key index(std::unordered_map<GLuint, std::uint32_t>& indices,
+                   GLuint const name) {
+    auto const result = indices.insert(
+      std::make_pair(name, static_cast<std::uint32_t>(indices.size())));
+    return result.first->second;
+  }
+
+  //! Units used by the previous set but not by @a set are unbound.
+  static void bindTextureSet(detail::DrawTextureSet const& set,
+                             GLuint const previousCount) {
+    GLsizei const count =
+      static_cast<GLsizei>(std::max(set.count, previousCount));
+    if (count > 0) {
+      detail::bindTextures(0, count, set.textures.data());
+      detail::bindSamplers(0, count, set.samplers.data());
+    }
+  }
+
+  static void draw(detail::DrawItem const& item) {
+    if (item.indexType == 0) {
+      drawArraysInstanced(item.mode, item.first, item.count,
+                          item.instanceCount);
+    }
+    else {
+      drawElementsInstanced(item.mode, item.count, item.indexType,
+                            reinterpret_cast<GLvoid const*>(item.indexOffset),
+                            item.instanceCount);
+    }
+  }
+
+  bool _open;
+  detail::DrawItem _item; //!< Being described.
+  detail::DrawTextureSet _textureSet; //!< Of the item being described.
+
+  std::vector<detail::DrawItem> _items;
+  std::vector<SortEntry> _sorted;
+  std::vector<SortEntry> _scratch;
+  std::vector<detail::DrawUniform> _uniforms;
+  std::vector<std::uint32_t> _uniformWords;
+
+  std::vector<PipelineState> _states;
+  std::unordered_map<PipelineState, std::uint32_t> _stateIndices;
+  std::vector<detail::DrawTextureSet> _textureSets;
+  std::unordered_map<detail::DrawTextureSet, std::uint32_t,
+                     detail::DrawTextureSetHash> _textureSetIndices;
+  std::unordered_map<GLuint, std::uint32_t> _programIndices;
+  std::unordered_map<GLuint, std::uint32_t> _vertexArrayIndices;
+};
+
+NDJINN_END_NAMESPACE
+
+#endif // NDJINN_DRAW_QUEUE_HPP_INCLUDED
@@ -8,14 +8,58 @@
 #ifndef NDJINN_ERROR_HPP_INCLUDED
 #define NDJINN_ERROR_HPP_INCLUDED
 
+#include <array>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <set>
 #include <sstream>
 #include <string>
+#include <vector>
 
+#include "nDjinnDispatch.hpp"
 #include "nDjinnNamespace.hpp"
 #include "nDjinnException.hpp"
 
+// Error checking policies, select one by defining NDJINN_ERROR_CHECK before
+// including any nDjinn header. Every glGetError call is a round trip to the
+// driver, so checking less often is considerably cheaper.
+//
+// NDJINN_ERROR_CHECK_ALWAYS: check after every wrapped call (default).
+// NDJINN_ERROR_CHECK_SYNC:   check only at explicit syncError() calls.
+// NDJINN_ERROR_CHECK_NEVER:  never check, checkError compiles to nothing.
+// NDJINN_ERROR_CHECK_DEBUG_OUTPUT: never poll, instead report messages
+//   delivered through an installed DebugOutput (see nDjinnDebug.hpp).
+#define NDJINN_ERROR_CHECK_ALWAYS 0
+#define NDJINN_ERROR_CHECK_SYNC 1
+#define NDJINN_ERROR_CHECK_NEVER 2
+#define NDJINN_ERROR_CHECK_DEBUG_OUTPUT 3
+
+#ifndef NDJINN_ERROR_CHECK
+#define NDJINN_ERROR_CHECK NDJINN_ERROR_CHECK_ALWAYS
+#endif
+
+// Number of wrapper names remembered by an ErrorScope.
+#ifndef NDJINN_ERROR_SCOPE_HISTORY
+#define NDJINN_ERROR_SCOPE_HISTORY 16
+#endif
+
 NDJINN_BEGIN_NAMESPACE
 
+//! A message delivered by the OpenGL debug output callback.
+struct DebugMessage {
+  GLenum source;
+  GLenum type;
+  GLuint id;
+  GLenum severity;
+  bool error; //!< True if the message reports an OpenGL error.
+  std::string text;
+};
+
+//! Receives debug messages together with the name of the wrapped OpenGL
+//! function that triggered them.
+typedef std::function<void(char const*, DebugMessage const&)> DebugSink;
+
 namespace detail {
 
 //! Convert OpenGL error type into a string.
@@ -41,31 +85,287 @@ inline bool isError(const GLenum err) {
 
 //! Get error type from OpenGL.
 inline GLenum getError() {
-  GLenum const err = glGetError(); // TODO: Caused an error?
+  GLenum const err = NDJINN_GL(GetError)(); // TODO: Caused an error?
   return err; 
 }
 
-} // Namespace: detail.
-
-//! Throws if one or more errors are found.
-inline void checkError(std::string const& caller)
+//! Drain the OpenGL error queue. Returns the names of the errors found,
+//! separated by spaces, or an empty string if there were none.
+inline std::string drainErrors()
 {
+  GLenum err = getError();
+  if (!isError(err)) {
+    return std::string();
+  }
+
   std::stringstream ss;
-  GLenum err = detail::getError();      // May throw.
-  while (detail::isError(err)) {
-    ss << detail::errorString(err) << " ";
-    err = detail::getError();         // May throw!?
+  while (isError(err)) {
+    ss << errorString(err) << " ";
+    err = getError();
+  }
+  return ss.str();
+}
+
+//! Book-keeping for ErrorScope. Remembers the names of the most recent
+//! wrapped calls so that a deferred error can still be diagnosed.
+struct ErrorScopeState {
+  static std::size_t const HISTORY_SIZE = NDJINN_ERROR_SCOPE_HISTORY;
+
+  ErrorScopeState()
+    : depth(0)
+    , next(0)
+    , count(0)
+  {}
+
+  void record(char const* caller) {
+    history[next] = caller;
+    next = (next + 1) % HISTORY_SIZE;
+    if (count < HISTORY_SIZE) {
+      ++count;
+    }
+  }
+
+  //! Oldest first.
+  std::string historyString() const {
+    std::stringstream ss;
+    std::size_t const first = (next + HISTORY_SIZE - count) % HISTORY_SIZE;
+    for (std::size_t i = 0; i < count; ++i) {
+      char const* caller = history[(first + i) % HISTORY_SIZE];
+      ss << (i > 0 ? ", " : "") << (caller != nullptr ? caller : "?");
+    }
+    return ss.str();
+  }
+
+  int depth; //!< Number of open scopes.
+  std::array<char const*, HISTORY_SIZE> history;
+  std::size_t next;
+  std::size_t count;
+};
+
+//! Error scopes are opened and closed on the thread issuing the calls.
+inline ErrorScopeState& errorScopeState()
+{
+  static thread_local ErrorScopeState state;
+  return state;
+}
+
+//! Caller names built at run time and recorded by the open ErrorScopes of
+//! the calling thread. Cleared when the outermost scope closes.
+inline std::set<std::string>& internedCallerNames()
+{
+  static thread_local std::set<std::string> names;
+  return names;
+}
+
+//! A copy of @a name that lives until the outermost ErrorScope closes, so
+//! that an ErrorScope can record names built at run time.
+inline char const* internCallerName(std::string const& name)
+{
+  return internedCallerNames().insert(name).first->c_str();
+}
+
+//! Messages received by the debug output callback that have not yet been
+//! reported. The callback runs synchronously on the thread that issued the
+//! offending call, so the queue is per thread.
+inline std::vector<DebugMessage>& pendingDebugMessages()
+{
+  static thread_local std::vector<DebugMessage> messages;
+  return messages;
+}
+
+//! Sink that pending debug messages are routed to. If empty, messages that
+//! report errors are thrown as exceptions and all others are dropped.
+inline DebugSink& debugSink()
+{
+  static DebugSink sink;
+  return sink;
+}
+
+//! Report pending debug messages, attributing them to @a caller. Only
+//! touches the driver through the callback, i.e. free if nothing happened.
+inline void flushDebugMessages(char const* caller)
+{
+  std::vector<DebugMessage>& messages = pendingDebugMessages();
+  if (messages.empty()) {
+    return;
   }
 
-  std::string const errStr = ss.str();
+  std::vector<DebugMessage> flushed;
+  flushed.swap(messages);
+  std::string const callerStr(caller != nullptr ? caller : "");
+  DebugSink const& sink = debugSink();
+  for (auto msg = flushed.begin(); msg != flushed.end(); ++msg) {
+    if (sink) {
+      sink(callerStr.c_str(), *msg);
+    }
+    else if (msg->error) {
+      NDJINN_THROW(
+        "OpenGL debug error: " 
+        << (callerStr.empty() ? "" : (callerStr + ": "))
+        << msg->text);
+    }
+  }
+}
+
+//! Drain the OpenGL error queue. Throws if one or more errors are found.
+//! Pending debug messages are flushed as well, so that a DebugOutput also
+//! works with the glGetError based policies. The queue is drained first,
+//! it is left empty even if a debug message throws.
+inline void throwIfError(char const* caller)
+{
+  std::string const errStr = drainErrors();
+  flushDebugMessages(caller);
   if (!errStr.empty()) {
+    std::string const callerStr(caller != nullptr ? caller : "");
     NDJINN_THROW(
       "OpenGL error(s): " 
-      << (caller.empty() ? "" : (caller + ": "))
+      << (callerStr.empty() ? "" : (callerStr + ": "))
       << errStr);
   }
 }
 
+//! Delete @a name with @a release, e.g. deleteBuffer, from a function that
+//! must not throw, such as a move assignment. Errors are dropped, the name
+//! is lost either way.
+template <typename Release> inline
+void releaseNoThrow(Release release, GLuint const name) noexcept
+{
+  try {
+    release(name);
+  }
+  catch (...) {
+  }
+}
+
+} // Namespace: detail.
+
+//! Called by every wrapper after the wrapped OpenGL call. Depending on
+//! NDJINN_ERROR_CHECK this either drains the error queue (and throws if
+//! errors are found) or does nothing at all. Inside an ErrorScope the call
+//! is only recorded. The caller name should be a string literal, it may
+//! be stored until the enclosing ErrorScope closes.
+inline void checkError(char const* caller)
+{
+#if NDJINN_ERROR_CHECK == NDJINN_ERROR_CHECK_ALWAYS || \
+    NDJINN_ERROR_CHECK == NDJINN_ERROR_CHECK_SYNC
+  detail::ErrorScopeState& scope = detail::errorScopeState();
+  if (scope.depth > 0) {
+    scope.record(caller);
+    return;
+  }
+#endif
+
+#if NDJINN_ERROR_CHECK == NDJINN_ERROR_CHECK_ALWAYS
+  detail::throwIfError(caller);
+#elif NDJINN_ERROR_CHECK == NDJINN_ERROR_CHECK_DEBUG_OUTPUT
+  detail::flushDebugMessages(caller);
+#else
+  (void)caller;
+#endif
+}
+
+//! Convenience, for caller names built at run time. May throw.
+inline void checkError(std::string const& caller)
+{
+#if NDJINN_ERROR_CHECK == NDJINN_ERROR_CHECK_ALWAYS || \
+    NDJINN_ERROR_CHECK == NDJINN_ERROR_CHECK_SYNC
+  if (detail::errorScopeState().depth > 0) {
+    checkError(detail::internCallerName(caller));
+    return;
+  }
+#endif
+  checkError(caller.c_str());
+}
+
+//! Explicit sync point, drains the error queue and throws if errors are
+//! found. Use this at the end of a batch of calls when the policy is
+//! NDJINN_ERROR_CHECK_SYNC. Does nothing when the policy is
+//! NDJINN_ERROR_CHECK_NEVER. Flushes pending debug messages when the policy
+//! is NDJINN_ERROR_CHECK_DEBUG_OUTPUT.
+inline void syncError(char const* caller)
+{
+#if NDJINN_ERROR_CHECK == NDJINN_ERROR_CHECK_DEBUG_OUTPUT
+  detail::flushDebugMessages(caller);
+#elif NDJINN_ERROR_CHECK != NDJINN_ERROR_CHECK_NEVER
+  detail::throwIfError(caller);
+#else
+  (void)caller;
+#endif
+}
+
+//! Suspends per-call error checks for its life-time and drains the error
+//! queue once when closed, i.e. one driver round trip for a whole batch of
+//! calls such as scene setup. If errors are found the exception message
+//! lists the most recent wrapped calls. Scopes may be nested, only the
+//! outermost one checks. Does nothing when the policy is
+//! NDJINN_ERROR_CHECK_NEVER or NDJINN_ERROR_CHECK_DEBUG_OUTPUT.
+class ErrorScope {
+public:
+  explicit ErrorScope(char const* name = "ErrorScope")
+    : _name(name)
+    , _open(true)
+  {
+    detail::ErrorScopeState& state = detail::errorScopeState();
+    if (state.depth == 0) {
+      state.next = 0;
+      state.count = 0;
+    }
+    ++state.depth;
+  }
+
+  //! Closes the scope, unless already closed. Throws if errors are found,
+  //! except during stack unwinding.
+  ~ErrorScope() noexcept(false) {
+    if (_open) {
+#if __cplusplus >= 201703L
+      if (std::uncaught_exceptions() > 0) {
+#else
+      if (std::uncaught_exception()) {
+#endif
+        if (--detail::errorScopeState().depth == 0) {
+          detail::internedCallerNames().clear();
+        }
+        _open = false;
+      }
+      else {
+        close();
+      }
+    }
+  }
+
+  //! Close the scope and check for errors. May throw.
+  void close() {
+    if (!_open) {
+      return;
+    }
+    _open = false;
+
+    detail::ErrorScopeState& state = detail::errorScopeState();
+    --state.depth;
+#if NDJINN_ERROR_CHECK == NDJINN_ERROR_CHECK_ALWAYS || \
+    NDJINN_ERROR_CHECK == NDJINN_ERROR_CHECK_SYNC
+    if (state.depth == 0) {
+      std::string const errStr = detail::drainErrors();
+      std::string const history =
+        errStr.empty() ? std::string() : state.historyString();
+      detail::internedCallerNames().clear();
+      detail::flushDebugMessages(_name);
+      if (!errStr.empty()) {
+        NDJINN_THROW("OpenGL error(s): " << _name << ": " << errStr
+                     << "(recent calls: " << history << ")");
+      }
+    }
+#endif
+  }
+
+private:
+  ErrorScope(ErrorScope const&); //!< Disabled copy.
+  ErrorScope& operator=(ErrorScope const&); //!< Disabled assign.
+
+  char const* _name;
+  bool _open;
+};
+
 NDJINN_END_NAMESPACE
 
 #endif  // NDJINN_ERROR_HPP_INCLUDED
@@ -16,11 +16,15 @@
 #include <utility>
 #include <vector>
 
+#include "nDjinnDeletionQueue.hpp"
+#include "nDjinnDispatch.hpp"
 #include "nDjinnError.hpp"
 #include "nDjinnException.hpp"
 #include "nDjinnFunctions.hpp"
 #include "nDjinnGL.hpp"
+#include "nDjinnHandlePool.hpp"
 #include "nDjinnNamespace.hpp"
+#include "nDjinnStateCache.hpp"
 
 NDJINN_BEGIN_NAMESPACE
 
@@ -28,19 +32,21 @@ namespace detail {
 
 //! glGenFramebuffers wrapper. May throw.
 inline void genFramebuffers(GLsizei const n, GLuint* ids) {
-  glGenFramebuffers(n, ids);
+  NDJINN_GL(GenFramebuffers)(n, ids);
   checkError("glGenFramebuffers");
 }
 
 //! glDeleteFramebuffers wrapper. May throw.
 inline void deleteFramebuffers(GLsizei const n, GLuint const* framebuffers) {
-  glDeleteFramebuffers(n, framebuffers);
+  NDJINN_GL(DeleteFramebuffers)(n, framebuffers);
   checkError("glDeleteFramebuffers");
+  uncacheDeleted(&StateCache::drawFramebuffer, n, framebuffers);
+  uncacheDeleted(&StateCache::readFramebuffer, n, framebuffers);
 }
 
 //! glIsFramebuffer wrapper. May throw.
 inline GLboolean isFramebuffer(GLuint const framebuffer) {
-  GLboolean const result = glIsFramebuffer(framebuffer);
+  GLboolean const result = NDJINN_GL(IsFramebuffer)(framebuffer);
   checkError("glIsFramebuffer");
   return result;
 }
@@ -48,8 +54,23 @@ inline GLboolean isFramebuffer(GLuint const framebuffer) {
 //! glBindFramebuffer wrapper. May throw.
 inline void bindFramebuffer(GLenum const target, GLuint const framebuffer)
 {
-  glBindFramebuffer(target, framebuffer);
+  bool const draw = target != GL_READ_FRAMEBUFFER;
+  bool const read = target != GL_DRAW_FRAMEBUFFER;
+  StateCache* const cache = StateCache::current();
+  if (cache != nullptr &&
+      (!draw || cache->drawFramebuffer.matches(framebuffer)) &&
+      (!read || cache->readFramebuffer.matches(framebuffer))) {
+    cache->skipped(DispatchIndex::BindFramebuffer);
+    return;
+  }
+  NDJINN_GL(BindFramebuffer)(target, framebuffer);
   checkError("glBindFramebuffer"); 
+  if (draw) {
+    cacheState(&StateCache::drawFramebuffer, framebuffer);
+  }
+  if (read) {
+    cacheState(&StateCache::readFramebuffer, framebuffer);
+  }
 }
 
 
@@ -61,7 +82,7 @@ framebufferRenderbuffer(const GLenum target,
                         const GLenum attachment, 
                         const GLenum renderbufferTarget, 
                         const GLuint renderbuffer) {
-  glFramebufferRenderbuffer(target, attachment, 
+  NDJINN_GL(FramebufferRenderbuffer)(target, attachment, 
                             renderbufferTarget, renderbuffer);
   checkError("glFramebufferRenderbuffer");
 }
@@ -73,7 +94,7 @@ framebufferTextureLayer(const GLenum target,
                         const GLuint texture, 
                         const GLint level, 
                         const GLint layer) {
-  glFramebufferTextureLayer(target, attachment, texture, level, layer);
+  NDJINN_GL(FramebufferTextureLayer)(target, attachment, texture, level, layer);
   checkError("glFramebufferTextureLayer"); // May throw.
 }
 
@@ -85,7 +106,7 @@ framebufferTextureLayer(const GLenum target,
 //! glCheckNamedFramebufferStatusEXT wrapper. May throw.
 inline GLenum checkNamedFramebufferStatus(GLuint const framebuffer,
                                           GLenum const target) {
-  GLenum const status = glCheckNamedFramebufferStatusEXT(framebuffer, target);
+  GLenum const status = NDJINN_GL(CheckNamedFramebufferStatusEXT)(framebuffer, target);
   checkError("glCheckNamedFramebufferStatusEXT");
   return status;
 }
@@ -95,7 +116,7 @@ inline void namedFramebufferTexture(GLuint const framebuffer,
                                     GLenum const attachment,
                                     GLuint const texture, GLint const level)
 {
-  glNamedFramebufferTextureEXT(framebuffer, attachment, texture, level);
+  NDJINN_GL(NamedFramebufferTextureEXT)(framebuffer, attachment, texture, level);
   checkError("glNamedFramebufferTextureEXT");
 }
 
@@ -105,7 +126,7 @@ inline void namedFramebufferTexture1D(GLuint const framebuffer,
                                       GLenum const textarget,
                                       GLuint const texture, GLint const level)
 {
-  glNamedFramebufferTexture1DEXT(framebuffer, attachment, textarget, texture,
+  NDJINN_GL(NamedFramebufferTexture1DEXT)(framebuffer, attachment, textarget, texture,
                                  level);
   checkError("glNamedFramebufferTexture1DEXT");
 }
@@ -116,7 +137,7 @@ inline void namedFramebufferTexture2D(GLuint const framebuffer,
                                       GLenum const textarget,
                                       GLuint const texture, GLint const level)
 {
-  glNamedFramebufferTexture2DEXT(framebuffer, attachment, textarget, texture,
+  NDJINN_GL(NamedFramebufferTexture2DEXT)(framebuffer, attachment, textarget, texture,
                                  level);
   checkError("glNamedFramebufferTexture2DEXT");
 }
@@ -128,7 +149,7 @@ inline void namedFramebufferTexture3D(GLuint const framebuffer,
                                       GLuint const texture, GLint const level,
                                       GLint const zoffset)
 {
-  glNamedFramebufferTexture3DEXT(framebuffer, attachment, textarget, texture,
+  NDJINN_GL(NamedFramebufferTexture3DEXT)(framebuffer, attachment, textarget, texture,
                                  level, zoffset);
   checkError("glNamedFramebufferTexture3DEXT");
 }
@@ -138,7 +159,7 @@ namedFramebufferRenderbuffer(GLuint const framebuffer,
                              GLenum const attachment,
                              GLenum const renderbuffertarget,
                              GLuint const renderbuffer) {
-  glNamedFramebufferRenderbufferEXT(
+  NDJINN_GL(NamedFramebufferRenderbufferEXT)(
     framebuffer, attachment, renderbuffertarget, renderbuffer);
   checkError("glNamedFramebufferRenderbufferEXT");
 }
@@ -148,13 +169,17 @@ inline void getNamedFramebufferAttachmentParameteriv(GLuint const framebuffer,
                                                      GLenum const attachment,
                                                      GLenum const pname,
                                                      GLint* params) {
-  glGetNamedFramebufferAttachmentParameterivEXT(
+  NDJINN_GL(GetNamedFramebufferAttachmentParameterivEXT)(
     framebuffer, attachment, pname, params);
   checkError("glGetNamedFramebufferAttachmentParameterivEXT");
 }
 
 //! Convenience.
 inline GLuint genFramebuffer() {
+  HandlePools* const pools = HandlePools::current();
+  if (pools != nullptr) {
+    return pools->framebuffers.acquire(&genFramebuffers, &deleteFramebuffers);
+  }
   GLuint handle = 0;
   genFramebuffers(1, &handle);
   return handle;
@@ -162,6 +187,16 @@ inline GLuint genFramebuffer() {
 
 //! Convenience.
 inline void deleteFramebuffer(GLuint const handle) {
+  HandlePools* const pools = HandlePools::current();
+  if (pools != nullptr) {
+    pools->framebuffers.release(handle, &deleteFramebuffers);
+    return;
+  }
+  DeletionQueue* const queue = DeletionQueue::current();
+  if (queue != nullptr) {
+    queue->push(&deleteFramebuffers, handle);
+    return;
+  }
   deleteFramebuffers(1, &handle);
 }
 
@@ -276,12 +311,39 @@ public:
   //! CTOR.
   Framebuffer()
     : _handle(detail::genFramebuffer())
+    , _complete(false)
   {}
 
   //! DTOR.
   ~Framebuffer()
   {
-    detail::deleteFramebuffer(_handle);
+    if (_handle != 0) {
+      detail::deleteFramebuffer(_handle);
+    }
+  }
+
+  //! Move CTOR, @a rhs is left empty, i.e. with a zero handle.
+  Framebuffer(Framebuffer&& rhs) noexcept
+    : _handle(rhs._handle)
+    , _complete(rhs._complete)
+  {
+    rhs._handle = 0;
+    rhs._complete = false;
+  }
+
+  //! Move assign, the current resource is deleted and @a rhs left empty.
+  Framebuffer& operator=(Framebuffer&& rhs) noexcept
+  {
+    if (this != &rhs) {
+      if (_handle != 0) {
+        detail::releaseNoThrow(&detail::deleteFramebuffer, _handle);
+      }
+      _handle = rhs._handle;
+      _complete = rhs._complete;
+      rhs._handle = 0;
+      rhs._complete = false;
+    }
+    return *this;
   }
 
   GLuint handle() const
@@ -289,10 +351,16 @@ public:
     return _handle;
   }
 
+  //! Completeness is only checked on the first bind after the attachments
+  //! changed. Re-specifying the storage of an attached image is not
+  //! detected, call status() to check explicitly.
   void bind(GLenum const target) const
   {
     detail::bindFramebuffer(target, _handle);
-    throwIfInvalidStatus(target);
+    if (!_complete) {
+      throwIfInvalidStatus(target);
+      _complete = true;
+    }
   }
 
   //! Disable all framebuffer objects and return to rendering to back buffer.
@@ -319,6 +387,7 @@ public:
   {
     detail::namedFramebufferTexture1D(_handle, attachment, GL_TEXTURE_1D,
                                       texture, level);
+    _complete = false;
   }
 
   void attachTexture2D(GLenum const attachment, GLuint const texture,
@@ -327,6 +396,7 @@ public:
   {
     detail::namedFramebufferTexture2D(_handle, attachment, textarget, texture,
                                       level);
+    _complete = false;
   }
 
   void attachTexture3D(GLenum const attachment, GLuint const texture,
@@ -335,12 +405,14 @@ public:
   {
     detail::namedFramebufferTexture3D(_handle, attachment, GL_TEXTURE_3D,
                                       texture, level, zoffset);
+    _complete = false;
   }
 
   void attachRenderbuffer(GLenum const attachment, GLuint const renderbuffer)
   {
     detail::namedFramebufferRenderbuffer(
       _handle, attachment, GL_RENDERBUFFER, renderbuffer);
+    _complete = false;
   }
 
 private:
@@ -370,7 +442,8 @@ private:
     }
   }
 
-  GLuint const _handle; //!< Resource handle.
+  GLuint _handle; //!< Resource handle.
+  mutable bool _complete; //!< Status checked since attachments changed.
 };
 
 NDJINN_END_NAMESPACE
@@ -10,9 +10,11 @@
 
 #include <array>
 
+#include "nDjinnDispatch.hpp"
 #include "nDjinnError.hpp"
 #include "nDjinnGL.hpp"
 #include "nDjinnNamespace.hpp"
+#include "nDjinnStateCache.hpp"
 
 NDJINN_BEGIN_NAMESPACE
 
@@ -21,42 +23,63 @@ NDJINN_BEGIN_NAMESPACE
 //! glBlendEquation wrapper. May throw.
 inline void blendEquation(GLenum const mode)
 {
-  glBlendEquation(mode);
+  StateCache::BlendEquation const equation = {{ mode, mode }};
+  if (detail::skipState(&StateCache::blendEquation, equation,
+                        DispatchIndex::BlendEquation)) {
+    return;
+  }
+  NDJINN_GL(BlendEquation)(mode);
   checkError("glBlendEquation");
+  detail::cacheState(&StateCache::blendEquation, equation);
 }
 
 //! glBlendEquationi wrapper. May throw.
 inline void blendEquationi(GLuint const buf, GLenum const mode) {
-  glBlendEquationi(buf, mode);
+  NDJINN_GL(BlendEquationi)(buf, mode);
   checkError("glBlendEquationi");
+  detail::invalidateState(&StateCache::blendEquation);
 }
 
 //! glBlendEquationSeparate wrapper. May throw.
 inline void blendEquationSeparate(GLenum const mode_rgb,
                                   GLenum const mode_alpha)
 {
-  glBlendEquationSeparate(mode_rgb, mode_alpha);
+  StateCache::BlendEquation const equation = {{ mode_rgb, mode_alpha }};
+  if (detail::skipState(&StateCache::blendEquation, equation,
+                        DispatchIndex::BlendEquationSeparate)) {
+    return;
+  }
+  NDJINN_GL(BlendEquationSeparate)(mode_rgb, mode_alpha);
   checkError("glBlendEquationSeparate");
+  detail::cacheState(&StateCache::blendEquation, equation);
 }
 
 //! glBlendEquationSeparatei wrapper. May throw.
 inline void blendEquationSeparatei(GLuint const buf, GLenum const mode_rgb,
                                    GLenum const mode_alpha)
 {
-  glBlendEquationSeparatei(buf, mode_rgb, mode_alpha);
+  NDJINN_GL(BlendEquationSeparatei)(buf, mode_rgb, mode_alpha);
   checkError("glBlendEquationSeparatei");
+  detail::invalidateState(&StateCache::blendEquation);
 }
 
 //! glBlendFunc wrapper. May throw.
 inline void blendFunc(GLenum const src, GLenum const dst) {
-  glBlendFunc(src, dst);
+  StateCache::BlendFunc const func = {{ src, dst, src, dst }};
+  if (detail::skipState(&StateCache::blendFunc, func,
+                        DispatchIndex::BlendFunc)) {
+    return;
+  }
+  NDJINN_GL(BlendFunc)(src, dst);
   checkError("glBlendFunc");
+  detail::cacheState(&StateCache::blendFunc, func);
 }
 
 //! glBlendFunci wrapper. May throw.
 inline void blendFunci(GLuint const buf, GLenum const src, GLenum const dst) {
-  glBlendFunci(buf, src, dst);
+  NDJINN_GL(BlendFunci)(buf, src, dst);
   checkError("glBlendFunci");
+  detail::invalidateState(&StateCache::blendFunc);
 }
 
 //! glBlendFuncSeparate wrapper. May throw.
@@ -64,8 +87,14 @@ inline void blendFuncSeparate(GLenum const srcRgb,
                               GLenum const dstRgb,
                               GLenum const srcAlpha,
                               GLenum const dstAlpha) {
-  glBlendFuncSeparate(srcRgb, dstRgb, srcAlpha, dstAlpha);
+  StateCache::BlendFunc const func = {{ srcRgb, dstRgb, srcAlpha, dstAlpha }};
+  if (detail::skipState(&StateCache::blendFunc, func,
+                        DispatchIndex::BlendFuncSeparate)) {
+    return;
+  }
+  NDJINN_GL(BlendFuncSeparate)(srcRgb, dstRgb, srcAlpha, dstAlpha);
   checkError("glBlendFuncSeparate");
+  detail::cacheState(&StateCache::blendFunc, func);
 }
 
 //! glBlendFuncSeparatei wrapper. May throw.
@@ -74,8 +103,9 @@ inline void blendFuncSeparatei(GLuint const buf,
                                GLenum const dstRgb,
                                GLenum const srcAlpha,
                                GLenum const dstAlpha) {
-  glBlendFuncSeparatei(buf, srcRgb, dstRgb, srcAlpha, dstAlpha);
+  NDJINN_GL(BlendFuncSeparatei)(buf, srcRgb, dstRgb, srcAlpha, dstAlpha);
   checkError("glBlendFuncSeparatei");
+  detail::invalidateState(&StateCache::blendFunc);
 }
 
 //! glBlendColor wrapper. May throw.
@@ -83,8 +113,14 @@ inline void blendColor(GLclampf const red,
                        GLclampf const green,
                        GLclampf const blue,
                        GLclampf const alpha) {
-  glBlendColor(red, green, blue, alpha);
+  StateCache::Color const color = {{ red, green, blue, alpha }};
+  if (detail::skipState(&StateCache::blendColor, color,
+                        DispatchIndex::BlendColor)) {
+    return;
+  }
+  NDJINN_GL(BlendColor)(red, green, blue, alpha);
   checkError("glBlendColor");
+  detail::cacheState(&StateCache::blendColor, color);
 }
 
 // State
@@ -92,27 +128,35 @@ inline void blendColor(GLclampf const red,
 //! glEnable wrapper. May throw.
 inline void enable(GLenum const cap)
 {
-  glEnable(cap);
+  if (detail::skipCapability(cap, true, DispatchIndex::Enable)) {
+    return;
+  }
+  NDJINN_GL(Enable)(cap);
   checkError("glEnable");
+  detail::cacheCapability(cap, true);
 }
 
 //! glDisable wrapper. May throw.
 inline void disable(GLenum const cap)
 {
-  glDisable(cap);
+  if (detail::skipCapability(cap, false, DispatchIndex::Disable)) {
+    return;
+  }
+  NDJINN_GL(Disable)(cap);
   checkError("glDisable");
+  detail::cacheCapability(cap, false);
 }
 
 //! glGetBooleanv wrapper. May throw.
 inline void getBooleanv(GLenum const pname, GLboolean* data) {
-  glGetBooleanv(pname, data);
+  NDJINN_GL(GetBooleanv)(pname, data);
   checkError("glGetBooleanv");
 }
 
 //! glGetIntegerv wrapper. May throw. 
 inline void getIntegerv(GLenum const pname, GLint* data)
 {
-  glGetIntegerv(pname, data);
+  NDJINN_GL(GetIntegerv)(pname, data);
   checkError("glGetIntegerv");
 }
 
@@ -135,32 +179,41 @@ inline std::array<GLint, N> getIntegers(GLenum const pname)
 
 //! glGetInteger64v wrapper. May throw.
 inline void getInteger64v(GLenum const pname, GLint64* data) {
-  glGetInteger64v(pname, data);
+  NDJINN_GL(GetInteger64v)(pname, data);
   checkError("glGetInteger64v");
 }
 
 //! glGetFloatv wrapper. May throw. 
 inline void getFloatv(GLenum const pname, GLfloat* data) {
-  glGetFloatv(pname, data);
+  NDJINN_GL(GetFloatv)(pname, data);
   checkError("glGetFloatv");
 }
 
 //! glGetDoublev wrapper. May throw.
 inline void getDoublev(GLenum const pname, GLdouble* data) {
-  glGetDoublev(pname, data);
+  NDJINN_GL(GetDoublev)(pname, data);
   checkError("glGetDoublev");
 }
 
 //! glIsEnabled wrapper. May throw. 
 inline GLboolean isEnabled(GLenum const cap) {
-  const GLboolean enabled = glIsEnabled(cap);
+  StateCache* const cache = StateCache::current();
+  if (cache != nullptr) {
+    auto const iter = cache->capabilities.find(cap);
+    if (iter != cache->capabilities.end()) {
+      cache->skipped(DispatchIndex::IsEnabled);
+      return iter->second ? GL_TRUE : GL_FALSE;
+    }
+  }
+  const GLboolean enabled = NDJINN_GL(IsEnabled)(cap);
   checkError("glIsEnabled");
+  detail::cacheCapability(cap, enabled == GL_TRUE);
   return enabled;
 }
 
 //! glGetString wrapper. May throw.
 inline const GLubyte* getString(GLenum const name) {
-  GLubyte const* str = glGetString(name);
+  GLubyte const* str = NDJINN_GL(GetString)(name);
   checkError("glGetString");
   return str;
 }
@@ -174,7 +227,7 @@ inline void vertexAttribPointer(GLuint const index,
                                 GLboolean const normalized,
                                 GLsizei const stride,
                                 GLvoid const* pointer) {
-  glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+  NDJINN_GL(VertexAttribPointer)(index, size, type, normalized, stride, pointer);
   checkError("glVertexAttribPointer");
 }
 
@@ -184,7 +237,7 @@ inline void vertexAttribIPointer(GLuint const index,
                                  GLenum const type,
                                  GLsizei const stride,
                                  GLvoid const* pointer) {
-  glVertexAttribIPointer(index, size, type, stride, pointer);
+  NDJINN_GL(VertexAttribIPointer)(index, size, type, stride, pointer);
   checkError("glVertexAttribIPointer");
 }
 
@@ -194,16 +247,75 @@ inline void vertexAttribLPointer(GLuint const index,
                                  GLenum const type,
                                  GLsizei const stride,
                                  GLvoid const* pointer) {
-  glVertexAttribLPointer(index, size, type, stride, pointer);
+  NDJINN_GL(VertexAttribLPointer)(index, size, type, stride, pointer);
   checkError("glVertexAttribLPointer");
 }
 
 //! glVertexAttribDivisor wrapper. May throw.
 inline void vertexAttribDivisor(GLuint const index, GLuint const divisor) {
-  glVertexAttribDivisor(index, divisor);
+  NDJINN_GL(VertexAttribDivisor)(index, divisor);
   checkError("glVertexAttribDivisor");
 }
 
+//! glDrawArrays wrapper. May throw.
+inline void drawArrays(GLenum const mode,
+                       GLint const first,
+                       GLsizei const count) {
+  NDJINN_GL(DrawArrays)(mode, first, count);
+  checkError("glDrawArrays");
+}
+
+//! glDrawArraysInstanced wrapper. May throw.
+inline void drawArraysInstanced(GLenum const mode,
+                                GLint const first,
+                                GLsizei const count,
+                                GLsizei const instanceCount) {
+  NDJINN_GL(DrawArraysInstanced)(mode, first, count, instanceCount);
+  checkError("glDrawArraysInstanced");
+}
+
+//! glDrawElements wrapper. May throw.
+inline void drawElements(GLenum const mode,
+                         GLsizei const count,
+                         GLenum const type,
+                         GLvoid const* indices) {
+  NDJINN_GL(DrawElements)(mode, count, type, indices);
+  checkError("glDrawElements");
+}
+
+//! glDrawElementsBaseVertex wrapper, @a baseVertex is added to each index.
+//! May throw.
+inline void drawElementsBaseVertex(GLenum const mode,
+                                   GLsizei const count,
+                                   GLenum const type,
+                                   GLvoid const* indices,
+                                   GLint const baseVertex) {
+  NDJINN_GL(DrawElementsBaseVertex)(mode, count, type, indices, baseVertex);
+  checkError("glDrawElementsBaseVertex");
+}
+
+//! glDrawElementsInstanced wrapper. May throw.
+inline void drawElementsInstanced(GLenum const mode,
+                                  GLsizei const count,
+                                  GLenum const type,
+                                  GLvoid const* indices,
+                                  GLsizei const instanceCount) {
+  NDJINN_GL(DrawElementsInstanced)(mode, count, type, indices, instanceCount);
+  checkError("glDrawElementsInstanced");
+}
+
+//! glDrawElementsInstancedBaseVertex wrapper. May throw.
+inline void drawElementsInstancedBaseVertex(GLenum const mode,
+                                            GLsizei const count,
+                                            GLenum const type,
+                                            GLvoid const* indices,
+                                            GLsizei const instanceCount,
+                                            GLint const baseVertex) {
+  NDJINN_GL(DrawElementsInstancedBaseVertex)(mode, count, type, indices,
+                                             instanceCount, baseVertex);
+  checkError("glDrawElementsInstancedBaseVertex");
+}
+
 //! glDrawRangeElements wrapper. May throw.
 inline void drawRangeElements(GLenum const mode,
                               GLuint const start,
@@ -211,16 +323,63 @@ inline void drawRangeElements(GLenum const mode,
                               GLsizei const count,
                               GLenum const type,
                               GLvoid const* indices) {
-  glDrawRangeElements(mode, start, end, count, type, indices);
+  NDJINN_GL(DrawRangeElements)(mode, start, end, count, type, indices);
   checkError("glDrawRangeElements");
 }
 
+//! Layout of the commands read by multiDrawArraysIndirect().
+struct DrawArraysIndirectCommand {
+  GLuint count;
+  GLuint instanceCount;
+  GLuint first;
+  GLuint baseInstance;
+};
+
+//! Layout of the commands read by multiDrawElementsIndirect().
+struct DrawElementsIndirectCommand {
+  GLuint count;
+  GLuint instanceCount;
+  GLuint firstIndex;
+  GLint baseVertex;
+  GLuint baseInstance;
+};
+
+//! glMultiDrawArraysIndirect wrapper, @a indirect is the byte offset of
+//! the first DrawArraysIndirectCommand in the bound
+//! GL_DRAW_INDIRECT_BUFFER. May throw.
+inline void multiDrawArraysIndirect(GLenum const mode,
+                                    GLvoid const* indirect,
+                                    GLsizei const drawCount,
+                                    GLsizei const stride = 0) {
+  NDJINN_GL(MultiDrawArraysIndirect)(mode, indirect, drawCount, stride);
+  checkError("glMultiDrawArraysIndirect");
+}
+
+//! glMultiDrawElementsIndirect wrapper, @a indirect is the byte offset of
+//! the first DrawElementsIndirectCommand in the bound
+//! GL_DRAW_INDIRECT_BUFFER. May throw.
+inline void multiDrawElementsIndirect(GLenum const mode,
+                                      GLenum const type,
+                                      GLvoid const* indirect,
+                                      GLsizei const drawCount,
+                                      GLsizei const stride = 0) {
+  NDJINN_GL(MultiDrawElementsIndirect)(mode, type, indirect, drawCount,
+                                       stride);
+  checkError("glMultiDrawElementsIndirect");
+}
+
 // Viewport
 
 //! glDepthRange wrapper. May throw.
 inline void depthRange(GLclampd const n, GLclampd const f) {
-  glDepthRange(n, f);
+  StateCache::Range const range = {{ n, f }};
+  if (detail::skipState(&StateCache::depthRange, range,
+                        DispatchIndex::DepthRange)) {
+    return;
+  }
+  NDJINN_GL(DepthRange)(n, f);
   checkError("glDepthRange");
+  detail::cacheState(&StateCache::depthRange, range);
 }
 
 //! glViewport wrapper. May throw.
@@ -228,8 +387,14 @@ inline void viewport(GLint const x,
                      GLint const y,
                      GLsizei const w,
                      GLsizei const h) {
-  glViewport(x, y, w, h);
+  StateCache::Rect const rect = {{ x, y, w, h }};
+  if (detail::skipState(&StateCache::viewport, rect,
+                        DispatchIndex::Viewport)) {
+    return;
+  }
+  NDJINN_GL(Viewport)(x, y, w, h);
   checkError("glViewport");
+  detail::cacheState(&StateCache::viewport, rect);
 }
 
 // TODO
@@ -269,14 +434,14 @@ inline void viewport(GLint const x,
 //! glDrawBuffer wrapper. May throw.
 inline void drawBuffer(GLenum const buf)
 {
-  glDrawBuffer(buf);
+  NDJINN_GL(DrawBuffer)(buf);
   checkError("glDrawBuffer");
 } 
 
 //! glDrawBuffers wrapper. May throw.
 inline void drawBuffers(GLsizei const n, GLenum const* bufs)
 {
-  glDrawBuffers(n, bufs);
+  NDJINN_GL(DrawBuffers)(n, bufs);
   checkError("glDrawBuffers");
 }
 
@@ -292,8 +457,14 @@ inline void colorMask(GLboolean const r,
                       GLboolean const g,
                       GLboolean const b,
                       GLboolean const a) {
-  glColorMask(r, g, b, a);
+  StateCache::Mask const mask = {{ r, g, b, a }};
+  if (detail::skipState(&StateCache::colorMask, mask,
+                        DispatchIndex::ColorMask)) {
+    return;
+  }
+  NDJINN_GL(ColorMask)(r, g, b, a);
   checkError("glColorMask");
+  detail::cacheState(&StateCache::colorMask, mask);
 }
 
 //! glColorMaski wrapper. May throw.
@@ -302,31 +473,118 @@ inline void colorMaski(GLuint const buf,
                        GLboolean const g,
                        GLboolean const b,
                        GLboolean const a) {
-  glColorMaski(buf, r, g, b, a);
+  NDJINN_GL(ColorMaski)(buf, r, g, b, a);
   checkError("glColorMaski"); 
+  detail::invalidateState(&StateCache::colorMask);
 }
 
 //! glDepthMask wrapper. May throw.
 inline void depthMask(GLboolean const mask) {
-  glDepthMask(mask);
-  checkError("glColorMask");
+  if (detail::skipState(&StateCache::depthMask, mask,
+                        DispatchIndex::DepthMask)) {
+    return;
+  }
+  NDJINN_GL(DepthMask)(mask);
+  checkError("glDepthMask");
+  detail::cacheState(&StateCache::depthMask, mask);
+}
+
+//! glDepthFunc wrapper. May throw.
+inline void depthFunc(GLenum const func) {
+  if (detail::skipState(&StateCache::depthFunc, func,
+                        DispatchIndex::DepthFunc)) {
+    return;
+  }
+  NDJINN_GL(DepthFunc)(func);
+  checkError("glDepthFunc");
+  detail::cacheState(&StateCache::depthFunc, func);
 }
 
 //! glStencilMask wrapper. May throw.
 inline void stencilMask(GLuint const mask) {
-  glStencilMask(mask);
+  StateCache* const cache = StateCache::current();
+  if (cache != nullptr && cache->stencilMaskFront.matches(mask) &&
+      cache->stencilMaskBack.matches(mask)) {
+    cache->skipped(DispatchIndex::StencilMask);
+    return;
+  }
+  NDJINN_GL(StencilMask)(mask);
   checkError("glStencilMask");
+  detail::cacheState(&StateCache::stencilMaskFront, mask);
+  detail::cacheState(&StateCache::stencilMaskBack, mask);
 }
 
 //! glStencilMaskSeparate wrapper. May throw.
 inline void stencilMaskSeparate(GLenum const face, GLuint const mask) {
-  glStencilMaskSeparate(face, mask);
+  StateCache* const cache = StateCache::current();
+  bool const front = face != GL_BACK;
+  bool const back = face != GL_FRONT;
+  if (cache != nullptr &&
+      (!front || cache->stencilMaskFront.matches(mask)) &&
+      (!back || cache->stencilMaskBack.matches(mask))) {
+    cache->skipped(DispatchIndex::StencilMaskSeparate);
+    return;
+  }
+  NDJINN_GL(StencilMaskSeparate)(face, mask);
   checkError("glStencilMaskSeparate");
+  if (front) {
+    detail::cacheState(&StateCache::stencilMaskFront, mask);
+  }
+  if (back) {
+    detail::cacheState(&StateCache::stencilMaskBack, mask);
+  }
+}
+
+//! glStencilFuncSeparate wrapper. May throw.
+inline void stencilFuncSeparate(GLenum const face, GLenum const func,
+                                GLint const ref, GLuint const mask) {
+  StateCache::StencilFunc const stencil = {{
+    func, static_cast<GLuint>(ref), mask }};
+  StateCache* const cache = StateCache::current();
+  bool const front = face != GL_BACK;
+  bool const back = face != GL_FRONT;
+  if (cache != nullptr &&
+      (!front || cache->stencilFuncFront.matches(stencil)) &&
+      (!back || cache->stencilFuncBack.matches(stencil))) {
+    cache->skipped(DispatchIndex::StencilFuncSeparate);
+    return;
+  }
+  NDJINN_GL(StencilFuncSeparate)(face, func, ref, mask);
+  checkError("glStencilFuncSeparate");
+  if (front) {
+    detail::cacheState(&StateCache::stencilFuncFront, stencil);
+  }
+  if (back) {
+    detail::cacheState(&StateCache::stencilFuncBack, stencil);
+  }
+}
+
+//! glStencilOpSeparate wrapper. May throw.
+inline void stencilOpSeparate(GLenum const face, GLenum const sfail,
+                              GLenum const dpfail, GLenum const dppass) {
+  StateCache::StencilOp const op = {{ sfail, dpfail, dppass }};
+  StateCache* const cache = StateCache::current();
+  bool const front = face != GL_BACK;
+  bool const back = face != GL_FRONT;
+  if (cache != nullptr &&
+      (!front || cache->stencilOpFront.matches(op)) &&
+      (!back || cache->stencilOpBack.matches(op))) {
+    cache->skipped(DispatchIndex::StencilOpSeparate);
+    return;
+  }
+  NDJINN_GL(StencilOpSeparate)(face, sfail, dpfail, dppass);
+  checkError("glStencilOpSeparate");
+  if (front) {
+    detail::cacheState(&StateCache::stencilOpFront, op);
+  }
+  if (back) {
+    detail::cacheState(&StateCache::stencilOpBack, op);
+  }
 }
 
 //! glClear wrapper. May throw.
 inline void clear(GLbitfield const buf) {
-  glClear(buf);
+  NDJINN_GL(Clear)(buf);
   checkError("glClear");        
 }
 
@@ -335,8 +593,14 @@ inline void clearColor(GLclampf const r,
                        GLclampf const g,
                        GLclampf const b,
                        GLclampf const a) {
-  glClearColor(r, g, b, a);
+  StateCache::Color const color = {{ r, g, b, a }};
+  if (detail::skipState(&StateCache::clearColor, color,
+                        DispatchIndex::ClearColor)) {
+    return;
+  }
+  NDJINN_GL(ClearColor)(r, g, b, a);
   checkError("glClearColor");
+  detail::cacheState(&StateCache::clearColor, color);
 }
 
 //! Convenience, set glClearColor from a 4-element array.
@@ -346,27 +610,43 @@ inline void clearColor(GLclampf const color[4]) {
 
 //! glClearDepth wrapper. May throw.
 inline void clearDepth(GLclampd const d) {
-  glClearDepth(d);
+  if (detail::skipState(&StateCache::clearDepth, d,
+                        DispatchIndex::ClearDepth)) {
+    return;
+  }
+  NDJINN_GL(ClearDepth)(d);
   checkError("glClearDepth");
+  detail::cacheState(&StateCache::clearDepth, d);
 }
 
 //! glClearDepthf wrapper. May throw. 
 inline void clearDepthf(GLclampf const d) {
-  glClearDepthf(d);
+  GLdouble const depth = d;
+  if (detail::skipState(&StateCache::clearDepth, depth,
+                        DispatchIndex::ClearDepthf)) {
+    return;
+  }
+  NDJINN_GL(ClearDepthf)(d);
   checkError("glClearDepthf");
+  detail::cacheState(&StateCache::clearDepth, depth);
 }
 
 //! glClearStencil wrapper. May throw.
 inline void clearStencil(GLint const s) {
-  glClearStencil(s);
+  if (detail::skipState(&StateCache::clearStencil, s,
+                        DispatchIndex::ClearStencil)) {
+    return;
+  }
+  NDJINN_GL(ClearStencil)(s);
   checkError("glClearStencil");
+  detail::cacheState(&StateCache::clearStencil, s);
 }
 
 //! glClearBufferiv wrapper. May throw.
 inline void clearBufferiv(GLenum const buf,
                           GLint const drawbuffer,
                           GLint const* value) {
-  glClearBufferiv(buf, drawbuffer, value);
+  NDJINN_GL(ClearBufferiv)(buf, drawbuffer, value);
   checkError("glClearBufferiv");
 }
 
@@ -374,7 +654,7 @@ inline void clearBufferiv(GLenum const buf,
 inline void clearBufferfv(GLenum const buf,
                           GLint const drawbuffer,
                           GLfloat const* value) {
-  glClearBufferfv(buf, drawbuffer, value);
+  NDJINN_GL(ClearBufferfv)(buf, drawbuffer, value);
   checkError("glClearBufferfv");
 }
 
@@ -382,14 +662,14 @@ inline void clearBufferfv(GLenum const buf,
 inline void clearBufferuiv(GLenum const buf,
                            GLint const drawbuffer,
                            GLuint const* value) {
-  glClearBufferuiv(buf, drawbuffer, value);
+  NDJINN_GL(ClearBufferuiv)(buf, drawbuffer, value);
   checkError("glClearBufferuiv");
 }
 
 //! glClearBufferfi wrapper. May throw.
 inline void clearBufferfi(GLenum const buf, GLint const drawbuffer,
                           GLfloat const depth, GLint const stencil) {
-  glClearBufferfi(buf, drawbuffer, depth, stencil);
+  NDJINN_GL(ClearBufferfi)(buf, drawbuffer, depth, stencil);
   checkError("glClearBufferfi");
 }
 
@@ -400,14 +680,14 @@ inline void readPixels(GLint const x, GLint const y, GLsizei const width,
                        GLsizei const height, GLenum const format,
                        GLenum const type, GLvoid* data)
 {
-  glReadPixels(x, y, width, height, format, type, data);
+  NDJINN_GL(ReadPixels)(x, y, width, height, format, type, data);
   checkError("glReadPixels");
 }
 
 //! glReadBuffer wrapper. May throw.
 inline void readBuffer(GLenum const mode)
 {
-  glReadBuffer(mode);
+  NDJINN_GL(ReadBuffer)(mode);
   checkError("glReadBuffer");
 }
 
@@ -425,20 +705,47 @@ inline void namedFramebufferReadBuffer(GLuint const framebuffer,
 
 inline void lineWidth(GLfloat const width)
 {
-  glLineWidth(width);
+  if (detail::skipState(&StateCache::lineWidth, width,
+                        DispatchIndex::LineWidth)) {
+    return;
+  }
+  NDJINN_GL(LineWidth)(width);
   checkError("glLineWidth");
+  detail::cacheState(&StateCache::lineWidth, width);
+}
+
+inline void polygonOffset(GLfloat const factor, GLfloat const units)
+{
+  StateCache::PolygonOffset const offset = {{ factor, units }};
+  if (detail::skipState(&StateCache::polygonOffset, offset,
+                        DispatchIndex::PolygonOffset)) {
+    return;
+  }
+  NDJINN_GL(PolygonOffset)(factor, units);
+  checkError("glPolygonOffset");
+  detail::cacheState(&StateCache::polygonOffset, offset);
 }
 
 inline void cullFace(GLenum const mode)
 {
-  glCullFace(mode);
+  if (detail::skipState(&StateCache::cullFace, mode,
+                        DispatchIndex::CullFace)) {
+    return;
+  }
+  NDJINN_GL(CullFace)(mode);
   checkError("glCullFace");
+  detail::cacheState(&StateCache::cullFace, mode);
 }
 
 inline void frontFace(GLenum const mode)
 {
-  glFrontFace(mode);
+  if (detail::skipState(&StateCache::frontFace, mode,
+                        DispatchIndex::FrontFace)) {
+    return;
+  }
+  NDJINN_GL(FrontFace)(mode);
   checkError("glFrontFace");
+  detail::cacheState(&StateCache::frontFace, mode);
 }
 
 NDJINN_END_NAMESPACE
@@ -34,6 +34,12 @@ struct GLTypeEnum<GLushort> {
   static GLenum const value = GL_UNSIGNED_SHORT;
 };
 
+//! Specialization.
+template<>
+struct GLTypeEnum<GLubyte> {
+  static GLenum const value = GL_UNSIGNED_BYTE;
+};
+
 NDJINN_END_NAMESPACE
 
 #endif // NDJINN_GLTYPEENUM_HPP_INCLUDED
@@ -0,0 +1,197 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+#ifndef NDJINN_HANDLE_POOL_HPP_INCLUDED
+#define NDJINN_HANDLE_POOL_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "nDjinnGL.hpp"
+#include "nDjinnNamespace.hpp"
+
+NDJINN_BEGIN_NAMESPACE
+
+namespace detail {
+
+//! Names of one object type, generated in blocks and deleted in batches.
+//! The glGen* and glDelete* wrappers are passed in, so that the pool does
+//! not depend on the resource headers.
+class HandlePool {
+public:
+  typedef void (*GenFunction)(GLsizei, GLuint*);
+  typedef void (*DeleteFunction)(GLsizei, GLuint const*);
+
+  HandlePool(GLsizei const blockSize, std::size_t const flushThreshold)
+    : _blockSize(blockSize)
+    , _flushThreshold(flushThreshold)
+    , _delete(nullptr)
+    , _genCount(0)
+    , _deleteCount(0)
+  {}
+
+  //! Take a name, generating a block of names if none are left. May throw.
+  GLuint acquire(GenFunction const gen, DeleteFunction const del) {
+    _delete = del;
+    if (_reserved.empty()) {
+      _reserved.resize(static_cast<std::size_t>(_blockSize));
+      gen(_blockSize, &_reserved[0]);
+      ++_genCount;
+      // Hand out names in the order they were generated.
+      std::reverse(_reserved.begin(), _reserved.end());
+    }
+    GLuint const name = _reserved.back();
+    _reserved.pop_back();
+    return name;
+  }
+
+  //! Queue @a name for deletion. Pending names are deleted by flush(),
+  //! which is called here once there are flushThreshold of them.
+  //! May throw.
+  void release(GLuint const name, DeleteFunction const del) {
+    _delete = del;
+    _pending.push_back(name);
+    if (_pending.size() >= _flushThreshold) {
+      flush();
+    }
+  }
+
+  //! Delete all pending names with a single call. May throw.
+  void flush() {
+    if (!_pending.empty()) {
+      std::vector<GLuint> names;
+      names.swap(_pending);
+      ++_deleteCount;
+      _delete(static_cast<GLsizei>(names.size()), &names[0]);
+    }
+  }
+
+  //! Delete pending names and names generated but not yet handed out.
+  //! May throw.
+  void clear() {
+    _pending.insert(_pending.end(), _reserved.begin(), _reserved.end());
+    _reserved.clear();
+    flush();
+  }
+
+  //! Names generated but not yet handed out.
+  std::size_t reservedCount() const {
+    return _reserved.size();
+  }
+
+  //! Names waiting for flush().
+  std::size_t pendingCount() const {
+    return _pending.size();
+  }
+
+  //! Number of glGen* calls made.
+  std::size_t genCount() const {
+    return _genCount;
+  }
+
+  //! Number of glDelete* calls made.
+  std::size_t deleteCount() const {
+    return _deleteCount;
+  }
+
+private:
+  GLsizei _blockSize;
+  std::size_t _flushThreshold;
+  DeleteFunction _delete; //!< Null until first used.
+  std::vector<GLuint> _reserved; //!< Next name last.
+  std::vector<GLuint> _pending;
+  std::size_t _genCount;
+  std::size_t _deleteCount;
+};
+
+} // Namespace: detail.
+
+//! Per-type handle pools of one context. While pools are current, the
+//! resource classes take their names from blocks generated with a single
+//! glGen* call, and destroyed names are deleted in batches with a single
+//! glDelete* call per type, either once enough of them have accumulated or
+//! when flush() is called, e.g. at the end of a frame or after unloading a
+//! level. Until then a destroyed name is still valid in OpenGL, but it is
+//! never handed out again.
+//!
+//! Pools must only be used with their own context current. A
+//! HeadlessContext owns pools and makes them current together with the
+//! context.
+class HandlePools {
+public:
+  //! CTOR. Names are generated @a blockSize at a time, and deleted once
+  //! @a flushThreshold names of a type are pending.
+  explicit HandlePools(GLsizei const blockSize = 64,
+                       std::size_t const flushThreshold = 256)
+    : buffers(blockSize, flushThreshold)
+    , framebuffers(blockSize, flushThreshold)
+    , queries(blockSize, flushThreshold)
+    , renderbuffers(blockSize, flushThreshold)
+    , samplers(blockSize, flushThreshold)
+    , textures(blockSize, flushThreshold)
+    , vertexArrays(blockSize, flushThreshold)
+  {}
+
+  //! The pools of the context that is current on the calling thread, null
+  //! if pooling is disabled (default).
+  static HandlePools* current() {
+    return currentRef();
+  }
+
+  //! Make @a pools the pools of the calling thread, null disables pooling.
+  //! Returns the previous pools.
+  static HandlePools* setCurrent(HandlePools* pools) {
+    HandlePools* const previous = currentRef();
+    currentRef() = pools;
+    return previous;
+  }
+
+  //! Delete all pending names, one call per type. May throw.
+  void flush() {
+    buffers.flush();
+    framebuffers.flush();
+    queries.flush();
+    renderbuffers.flush();
+    samplers.flush();
+    textures.flush();
+    vertexArrays.flush();
+  }
+
+  //! Delete all pending and reserved names, e.g. before the context is
+  //! destroyed. May throw.
+  void clear() {
+    buffers.clear();
+    framebuffers.clear();
+    queries.clear();
+    renderbuffers.clear();
+    samplers.clear();
+    textures.clear();
+    vertexArrays.clear();
+  }
+
+  detail::HandlePool buffers;
+  detail::HandlePool framebuffers;
+  detail::HandlePool queries;
+  detail::HandlePool renderbuffers;
+  detail::HandlePool samplers;
+  detail::HandlePool textures;
+  detail::HandlePool vertexArrays;
+
+private:
+  HandlePools(HandlePools const&); //!< Disabled copy.
+  HandlePools& operator=(HandlePools const&); //!< Disabled assign.
+
+  static HandlePools*& currentRef() {
+    static thread_local HandlePools* current = nullptr;
+    return current;
+  }
+};
+
+NDJINN_END_NAMESPACE
+
+#endif // NDJINN_HANDLE_POOL_HPP_INCLUDED
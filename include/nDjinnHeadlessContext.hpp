@@ -0,0 +1,360 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+#ifndef NDJINN_HEADLESS_CONTEXT_HPP_INCLUDED
+#define NDJINN_HEADLESS_CONTEXT_HPP_INCLUDED
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "nDjinnDeletionQueue.hpp"
+#include "nDjinnDispatch.hpp"
+#include "nDjinnError.hpp"
+#include "nDjinnException.hpp"
+#include "nDjinnFramebuffer.hpp"
+#include "nDjinnFunctions.hpp"
+#include "nDjinnGL.hpp"
+#include "nDjinnHandlePool.hpp"
+#include "nDjinnNamespace.hpp"
+#include "nDjinnRenderbuffer.hpp"
+#include "nDjinnStateCache.hpp"
+
+// Headless contexts are created through EGL using the
+// EGL_MESA_platform_surfaceless extension by default, i.e. no display server
+// is needed. Define NDJINN_HEADLESS_OSMESA to use OSMesa instead.
+#ifdef NDJINN_HEADLESS_OSMESA
+#include <GL/osmesa.h>
+#else
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+NDJINN_BEGIN_NAMESPACE
+
+namespace detail {
+
+#ifndef NDJINN_HEADLESS_OSMESA
+//! Returns true if @a name is in the space separated @a extensions string.
+inline bool hasExtension(char const* extensions, char const* name)
+{
+  if (extensions == nullptr) {
+    return false;
+  }
+  std::size_t const length = std::strlen(name);
+  for (char const* iter = std::strstr(extensions, name); iter != nullptr;
+       iter = std::strstr(iter + length, name)) {
+    bool const begin = iter == extensions || iter[-1] == ' ';
+    bool const end = iter[length] == ' ' || iter[length] == '\0';
+    if (begin && end) {
+      return true;
+    }
+  }
+  return false;
+}
+#endif
+
+//! Load entry points for the current context.
+inline void initEntryPoints()
+{
+#ifdef __glew_h__
+  glewExperimental = GL_TRUE;
+  GLenum const err = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+  // GLEW built for GLX complains when there is no X display, but core
+  // entry points are still loaded.
+  if (err != GLEW_OK && err != GLEW_ERROR_NO_GLX_DISPLAY) {
+#else
+  if (err != GLEW_OK) {
+#endif
+    NDJINN_THROW("glewInit failed: "
+                 << reinterpret_cast<char const*>(glewGetErrorString(err)));
+  }
+  // glewInit queries extensions the old way, which is an error in core
+  // profile contexts.
+  drainErrors();
+#endif
+  loadDispatch();
+}
+
+} // Namespace: detail.
+
+//! An OpenGL core profile context that needs no window or display server,
+//! e.g. for offline rendering and tests on render farm nodes. The context
+//! is made current on construction and renders to a default framebuffer
+//! with an RGBA8 color and a 24/8 depth/stencil renderbuffer, which is
+//! bound to GL_FRAMEBUFFER. Several contexts may exist at once, use
+//! makeCurrent() to switch between them. Each context has a StateCache
+//! and HandlePools that are made current together with the context, and
+//! a DeletionQueue for resources destroyed on other threads. May throw.
+class HeadlessContext {
+public:
+  HeadlessContext(GLsizei const width, GLsizei const height,
+                  GLint const major = 4, GLint const minor = 5)
+    : _width(width)
+    , _height(height)
+#ifdef NDJINN_HEADLESS_OSMESA
+    , _context(nullptr)
+#else
+    , _display(EGL_NO_DISPLAY)
+    , _context(EGL_NO_CONTEXT)
+#endif
+  {
+    createContext(major, minor);
+    try {
+      detail::initEntryPoints();
+      _color.reset(new Renderbuffer(GL_RGBA8, _width, _height));
+      _depthStencil.reset(
+        new Renderbuffer(GL_DEPTH24_STENCIL8, _width, _height));
+      _framebuffer.reset(new Framebuffer);
+      _framebuffer->attachRenderbuffer(GL_COLOR_ATTACHMENT0,
+                                       _color->handle());
+      _framebuffer->attachRenderbuffer(GL_DEPTH_STENCIL_ATTACHMENT,
+                                       _depthStencil->handle());
+      _framebuffer->bind(GL_FRAMEBUFFER);
+      viewport(0, 0, _width, _height);
+    }
+    catch (...) {
+      releaseFramebuffer();
+      releaseCurrent();
+      destroyContext();
+      throw;
+    }
+  }
+
+  //! DTOR. Makes the context current to release the default framebuffer,
+  //! queued and pooled names. Threads pushing to the deletion queue must
+  //! have been stopped.
+  ~HeadlessContext()
+  {
+    try {
+      makeCurrent();
+      releaseFramebuffer();
+      _deletionQueue.drain();
+      _handlePools.clear();
+    }
+    catch (...) {
+    }
+    releaseCurrent();
+    destroyContext();
+  }
+
+  //! Make this the current context of the calling thread, together with
+  //! its state cache and handle pools. May throw.
+  void makeCurrent()
+  {
+#ifdef NDJINN_HEADLESS_OSMESA
+    if (!OSMesaMakeCurrent(_context, &_pixels[0],
+                           GL_UNSIGNED_BYTE, _width, _height)) {
+      NDJINN_THROW("OSMesaMakeCurrent failed");
+    }
+#else
+    if (!eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, _context)) {
+      NDJINN_THROW("eglMakeCurrent failed: 0x" << std::hex << eglGetError());
+    }
+#endif
+    StateCache::setCurrent(&_stateCache);
+    HandlePools::setCurrent(&_handlePools);
+  }
+
+  GLsizei width() const
+  {
+    return _width;
+  }
+
+  GLsizei height() const
+  {
+    return _height;
+  }
+
+  //! Default render target.
+  Framebuffer const& framebuffer() const
+  {
+    return *_framebuffer;
+  }
+
+  Renderbuffer const& colorbuffer() const
+  {
+    return *_color;
+  }
+
+  Renderbuffer const& depthStencilbuffer() const
+  {
+    return *_depthStencil;
+  }
+
+  //! Shadow state of this context.
+  StateCache& stateCache()
+  {
+    return _stateCache;
+  }
+
+  //! Queue for resources of this context destroyed on other threads. Make
+  //! it current on those threads with DeletionQueue::setCurrent() and call
+  //! drain() at a safe point, e.g. at the end of a frame.
+  DeletionQueue& deletionQueue()
+  {
+    return _deletionQueue;
+  }
+
+  //! Handle pools of this context. Call flush() at a safe point, e.g. at
+  //! the end of a frame, to delete destroyed names.
+  HandlePools& handlePools()
+  {
+    return _handlePools;
+  }
+
+  //! Read back the color buffer of the default framebuffer as tightly
+  //! packed RGBA8 rows, bottom row first. The default framebuffer must be
+  //! bound to GL_READ_FRAMEBUFFER. May throw.
+  std::vector<GLubyte> readPixels() const
+  {
+    std::vector<GLubyte> pixels(static_cast<std::size_t>(_width) * _height * 4);
+    readBuffer(GL_COLOR_ATTACHMENT0);
+    ndj::readPixels(0, 0, _width, _height, GL_RGBA, GL_UNSIGNED_BYTE,
+                    pixels.empty() ? nullptr : &pixels[0]);
+    return pixels;
+  }
+
+private:
+  HeadlessContext(HeadlessContext const&); //!< Disabled copy.
+  HeadlessContext& operator=(HeadlessContext const&); //!< Disabled assign.
+
+#ifdef NDJINN_HEADLESS_OSMESA
+  void createContext(GLint const major, GLint const minor)
+  {
+    int const attribs[] = {
+      OSMESA_FORMAT, OSMESA_RGBA,
+      OSMESA_DEPTH_BITS, 0,
+      OSMESA_STENCIL_BITS, 0,
+      OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+      OSMESA_CONTEXT_MAJOR_VERSION, major,
+      OSMESA_CONTEXT_MINOR_VERSION, minor,
+      0
+    };
+    _context = OSMesaCreateContextAttribs(attribs, nullptr);
+    if (_context == nullptr) {
+      NDJINN_THROW("OSMesaCreateContextAttribs failed");
+    }
+    // OSMesa always needs a color buffer, rendering goes to the default
+    // framebuffer object though.
+    _pixels.resize(static_cast<std::size_t>(_width) * _height * 4);
+    makeCurrent();
+  }
+
+  void destroyContext()
+  {
+    if (_context != nullptr) {
+      OSMesaDestroyContext(_context);
+      _context = nullptr;
+    }
+  }
+#else
+  void createContext(GLint const major, GLint const minor)
+  {
+    if (!detail::hasExtension(eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS),
+                              "EGL_MESA_platform_surfaceless")) {
+      NDJINN_THROW("EGL_MESA_platform_surfaceless not supported");
+    }
+    PFNEGLGETPLATFORMDISPLAYEXTPROC const getPlatformDisplay =
+      reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+        eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (getPlatformDisplay == nullptr) {
+      NDJINN_THROW("eglGetPlatformDisplayEXT not found");
+    }
+    // EGL displays are not reference counted, the display is never
+    // terminated since other contexts may still be using it.
+    _display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+                                  EGL_DEFAULT_DISPLAY, nullptr);
+    EGLint eglMajor = 0;
+    EGLint eglMinor = 0;
+    if (_display == EGL_NO_DISPLAY ||
+        !eglInitialize(_display, &eglMajor, &eglMinor)) {
+      NDJINN_THROW("eglInitialize failed: 0x" << std::hex << eglGetError());
+    }
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+      NDJINN_THROW("eglBindAPI failed: 0x" << std::hex << eglGetError());
+    }
+
+    EGLint const configAttribs[] = {
+      EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+      EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(_display, configAttribs, &config, 1, &configCount)) {
+      configCount = 0;
+    }
+
+    EGLint const contextAttribs[] = {
+      EGL_CONTEXT_MAJOR_VERSION, major,
+      EGL_CONTEXT_MINOR_VERSION, minor,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+      EGL_NONE
+    };
+    // Surfaceless contexts do not need a config.
+    _context = eglCreateContext(_display,
+                                configCount > 0 ? config : nullptr,
+                                EGL_NO_CONTEXT, contextAttribs);
+    if (_context == EGL_NO_CONTEXT) {
+      NDJINN_THROW("eglCreateContext failed: 0x" << std::hex
+                   << eglGetError());
+    }
+    makeCurrent();
+  }
+
+  void destroyContext()
+  {
+    if (_context != EGL_NO_CONTEXT) {
+      if (eglGetCurrentContext() == _context) {
+        eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                       EGL_NO_CONTEXT);
+      }
+      eglDestroyContext(_display, _context);
+      _context = EGL_NO_CONTEXT;
+    }
+  }
+#endif
+
+  void releaseFramebuffer()
+  {
+    _framebuffer.reset();
+    _depthStencil.reset();
+    _color.reset();
+  }
+
+  //! Stop using the state cache and handle pools of this context.
+  void releaseCurrent()
+  {
+    if (StateCache::current() == &_stateCache) {
+      StateCache::setCurrent(nullptr);
+    }
+    if (HandlePools::current() == &_handlePools) {
+      HandlePools::setCurrent(nullptr);
+    }
+  }
+
+  GLsizei _width;
+  GLsizei _height;
+#ifdef NDJINN_HEADLESS_OSMESA
+  OSMesaContext _context;
+  std::vector<GLubyte> _pixels;
+#else
+  EGLDisplay _display;
+  EGLContext _context;
+#endif
+  StateCache _stateCache;
+  HandlePools _handlePools;
+  DeletionQueue _deletionQueue;
+  std::unique_ptr<Renderbuffer> _color;
+  std::unique_ptr<Renderbuffer> _depthStencil;
+  std::unique_ptr<Framebuffer> _framebuffer;
+};
+
+NDJINN_END_NAMESPACE
+
+#endif // NDJINN_HEADLESS_CONTEXT_HPP_INCLUDED
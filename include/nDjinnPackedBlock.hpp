@@ -0,0 +1,355 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+#ifndef NDJINN_PACKED_BLOCK_HPP_INCLUDED
+#define NDJINN_PACKED_BLOCK_HPP_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "nDjinnBuffer.hpp"
+#include "nDjinnException.hpp"
+#include "nDjinnGL.hpp"
+#include "nDjinnNamespace.hpp"
+#include "nDjinnShaderProgram.hpp"
+
+NDJINN_BEGIN_NAMESPACE
+
+//! Memory layout rules of an interface block.
+enum BlockPacking {
+  //! Uniform blocks declared layout(std140).
+  BLOCK_PACKING_STD140,
+  //! Shader storage blocks declared layout(std430), where arrays of
+  //! scalars and two-component vectors are not padded to 16 bytes.
+  BLOCK_PACKING_STD430
+};
+
+//! A block member of GLSL type @a TypeT, e.g. GL_FLOAT_VEC3.
+template <GLenum TypeT>
+struct BlockField {
+  static GLenum const TYPE = TypeT;
+  static std::size_t const COUNT = 1;
+  static bool const ARRAY = false;
+};
+
+//! A block member that is an array of @a CountT elements of GLSL type
+//! @a TypeT.
+template <GLenum TypeT, std::size_t CountT>
+struct BlockArray {
+  static_assert(CountT > 0, "block arrays must not be empty");
+  static GLenum const TYPE = TypeT;
+  static std::size_t const COUNT = CountT;
+  static bool const ARRAY = true;
+};
+
+namespace detail {
+
+inline constexpr std::size_t roundUp(std::size_t const value,
+                                     std::size_t const alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+inline constexpr std::size_t maxSize(std::size_t const lhs,
+                                     std::size_t const rhs) {
+  return lhs < rhs ? rhs : lhs;
+}
+
+//! Number of columns and rows of a GLSL type, columns are vectors.
+template <std::size_t Columns, std::size_t Rows>
+struct GlslShape {
+  static std::size_t const COLUMNS = Columns;
+  static std::size_t const ROWS = Rows;
+};
+
+//! Generic. 32-bit scalar, vector and matrix types only.
+template <GLenum TypeT>
+struct GlslType;
+
+template<> struct GlslType<GL_FLOAT> : GlslShape<1, 1> {};
+template<> struct GlslType<GL_FLOAT_VEC2> : GlslShape<1, 2> {};
+template<> struct GlslType<GL_FLOAT_VEC3> : GlslShape<1, 3> {};
+template<> struct GlslType<GL_FLOAT_VEC4> : GlslShape<1, 4> {};
+template<> struct GlslType<GL_INT> : GlslShape<1, 1> {};
+template<> struct GlslType<GL_INT_VEC2> : GlslShape<1, 2> {};
+template<> struct GlslType<GL_INT_VEC3> : GlslShape<1, 3> {};
+template<> struct GlslType<GL_INT_VEC4> : GlslShape<1, 4> {};
+template<> struct GlslType<GL_UNSIGNED_INT> : GlslShape<1, 1> {};
+template<> struct GlslType<GL_UNSIGNED_INT_VEC2> : GlslShape<1, 2> {};
+template<> struct GlslType<GL_UNSIGNED_INT_VEC3> : GlslShape<1, 3> {};
+template<> struct GlslType<GL_UNSIGNED_INT_VEC4> : GlslShape<1, 4> {};
+template<> struct GlslType<GL_BOOL> : GlslShape<1, 1> {};
+template<> struct GlslType<GL_BOOL_VEC2> : GlslShape<1, 2> {};
+template<> struct GlslType<GL_BOOL_VEC3> : GlslShape<1, 3> {};
+template<> struct GlslType<GL_BOOL_VEC4> : GlslShape<1, 4> {};
+template<> struct GlslType<GL_FLOAT_MAT2> : GlslShape<2, 2> {};
+template<> struct GlslType<GL_FLOAT_MAT2x3> : GlslShape<2, 3> {};
+template<> struct GlslType<GL_FLOAT_MAT2x4> : GlslShape<2, 4> {};
+template<> struct GlslType<GL_FLOAT_MAT3> : GlslShape<3, 3> {};
+template<> struct GlslType<GL_FLOAT_MAT3x2> : GlslShape<3, 2> {};
+template<> struct GlslType<GL_FLOAT_MAT3x4> : GlslShape<3, 4> {};
+template<> struct GlslType<GL_FLOAT_MAT4> : GlslShape<4, 4> {};
+template<> struct GlslType<GL_FLOAT_MAT4x2> : GlslShape<4, 2> {};
+template<> struct GlslType<GL_FLOAT_MAT4x3> : GlslShape<4, 3> {};
+
+//! Size and alignment of a block member, following the rules in section
+//! 7.6.2.2 of the OpenGL 4.5 specification. Matrices are column major,
+//! i.e. stored like arrays of column vectors.
+template <BlockPacking PackingT, typename FieldT>
+struct FieldLayout {
+  typedef GlslType<FieldT::TYPE> Type;
+
+  static GLenum const TYPE = FieldT::TYPE;
+  static std::size_t const COUNT = FieldT::COUNT;
+  static bool const ARRAY = FieldT::ARRAY;
+  static bool const MATRIX = Type::COLUMNS > 1;
+
+  //! Bytes of a single column vector.
+  static std::size_t const VECTOR_SIZE = 4 * Type::ROWS;
+  //! Three-component vectors are aligned like four-component ones.
+  static std::size_t const VECTOR_ALIGNMENT =
+    Type::ROWS == 3 ? 16 : VECTOR_SIZE;
+  //! Distance between columns and array elements, std140 rounds it up to
+  //! the size of a vec4.
+  static std::size_t const COLUMN_STRIDE =
+    PackingT == BLOCK_PACKING_STD140 ? roundUp(VECTOR_ALIGNMENT, 16)
+                                     : VECTOR_ALIGNMENT;
+
+  static std::size_t const MATRIX_STRIDE = MATRIX ? COLUMN_STRIDE : 0;
+  static std::size_t const ARRAY_STRIDE =
+    ARRAY ? COLUMN_STRIDE * Type::COLUMNS : 0;
+  static std::size_t const ALIGNMENT =
+    ARRAY || MATRIX ? COLUMN_STRIDE : VECTOR_ALIGNMENT;
+  static std::size_t const SIZE =
+    ARRAY || MATRIX ? COLUMN_STRIDE * Type::COLUMNS * COUNT : VECTOR_SIZE;
+};
+
+//! Reflected layout of a member, for validation.
+struct PackedField {
+  GLenum type;
+  GLint count;
+  GLint offset;
+  GLint arrayStride;
+  GLint matrixStride;
+};
+
+//! Offsets of @a Fields, packed one after the other starting at @a Begin.
+template <BlockPacking PackingT, std::size_t Begin, typename... Fields>
+struct PackFields;
+
+template <BlockPacking PackingT, std::size_t Begin>
+struct PackFields<PackingT, Begin> {
+  static std::size_t const END = Begin;
+  //! Largest member alignment, std140 blocks are padded like structures
+  //! to a multiple of 16 bytes.
+  static std::size_t const ALIGNMENT =
+    PackingT == BLOCK_PACKING_STD140 ? 16 : 4;
+
+  static void append(std::vector<PackedField>&) {}
+};
+
+template <BlockPacking PackingT, std::size_t Begin,
+          typename Head, typename... Tail>
+struct PackFields<PackingT, Begin, Head, Tail...> {
+  typedef FieldLayout<PackingT, Head> Layout;
+  static std::size_t const OFFSET = roundUp(Begin, Layout::ALIGNMENT);
+
+  typedef PackFields<PackingT, OFFSET + Layout::SIZE, Tail...> Next;
+  static std::size_t const END = Next::END;
+  static std::size_t const ALIGNMENT =
+    maxSize(Layout::ALIGNMENT, Next::ALIGNMENT);
+
+  static void append(std::vector<PackedField>& fields) {
+    PackedField const field = {
+      Layout::TYPE,
+      static_cast<GLint>(Layout::COUNT),
+      static_cast<GLint>(OFFSET),
+      static_cast<GLint>(Layout::ARRAY_STRIDE),
+      static_cast<GLint>(Layout::MATRIX_STRIDE)
+    };
+    fields.push_back(field);
+    Next::append(fields);
+  }
+};
+
+//! The PackFields whose head is member @a I.
+template <std::size_t I, typename Pack>
+struct PackedFieldAt {
+  typedef typename PackedFieldAt<I - 1, typename Pack::Next>::Type Type;
+};
+
+template <typename Pack>
+struct PackedFieldAt<0, Pack> {
+  typedef Pack Type;
+};
+
+} // Namespace: detail.
+
+//! CPU-side copy of an interface block with members @a Fields, e.g.
+//! BlockField<GL_FLOAT_MAT4> or BlockArray<GL_FLOAT_VEC4, 8>, in
+//! declaration order. Offsets follow @a PackingT and are computed at
+//! compile time, so set() is a copy to a fixed offset and uploading the
+//! whole block is a single memcpy, e.g. through upload() or
+//! StreamBuffer::upload(data(), SIZE, alignment), instead of a setUniform*
+//! call per member.
+//!
+//! Call validate() once after linking to check the description against
+//! the block reflected by OpenGL. Structure members are not supported,
+//! declare their members in place instead.
+template <BlockPacking PackingT, typename... Fields>
+class PackedBlock {
+private:
+  typedef detail::PackFields<PackingT, 0, Fields...> Pack;
+
+  template <std::size_t I>
+  struct Field {
+    static_assert(I < sizeof...(Fields), "block member index out of range");
+    typedef typename detail::PackedFieldAt<I, Pack>::Type At;
+    typedef typename At::Layout Layout;
+    static std::size_t const OFFSET = At::OFFSET;
+  };
+
+public:
+  static BlockPacking const PACKING = PackingT;
+  static std::size_t const FIELD_COUNT = sizeof...(Fields);
+  //! Size of the block in bytes, the data size reported by OpenGL.
+  static std::size_t const SIZE =
+    detail::roundUp(Pack::END, Pack::ALIGNMENT);
+
+  //! CTOR. All members are zero.
+  PackedBlock() {
+    _data.fill(0);
+  }
+
+  //! Byte offset of member @a I.
+  template <std::size_t I>
+  static constexpr std::size_t offset() {
+    return Field<I>::OFFSET;
+  }
+
+  //! Set member @a I, which must not be an array, to @a value. Vectors are
+  //! passed as tightly packed components, e.g. GLfloat[3], and matrices as
+  //! tightly packed columns.
+  template <std::size_t I, typename T>
+  void set(T const& value) {
+    static_assert(!Field<I>::Layout::ARRAY,
+                  "array members are set one element at a time");
+    write<I>(Field<I>::OFFSET, value);
+  }
+
+  //! Set element @a index of array member @a I to @a value. May throw.
+  template <std::size_t I, typename T>
+  void set(std::size_t const index, T const& value) {
+    typedef typename Field<I>::Layout Layout;
+    static_assert(Layout::ARRAY, "member is not an array");
+    if (index >= Layout::COUNT) {
+      std::size_t const count = Layout::COUNT;
+      NDJINN_THROW("block array index out of range: " << index << " of "
+                   << count);
+    }
+    write<I>(Field<I>::OFFSET + index * Layout::ARRAY_STRIDE, value);
+  }
+
+  //! Packed block contents, SIZE bytes.
+  void const* data() const {
+    return _data.data();
+  }
+
+  //! Copy the block to @a dst, e.g. persistently mapped memory.
+  void copyTo(void* const dst) const {
+    std::memcpy(dst, _data.data(), SIZE);
+  }
+
+  //! Copy the block to @a buffer at @a offset with a single call, see
+  //! BufferUpdate. May throw.
+  template <GLenum TargetT>
+  void upload(Buffer<TargetT>& buffer,
+              GLintptr const offset = 0,
+              BufferUpdate const strategy = BUFFER_UPDATE_SUB_DATA) const {
+    buffer.update(offset, static_cast<GLsizeiptr>(SIZE), _data.data(),
+                  strategy);
+  }
+
+  //! Throws if the members or size of @a block, as reflected by OpenGL,
+  //! differ from this description. Meant to be called once per program
+  //! after linking.
+  static void validate(UniformBlock const& block) {
+    std::vector<detail::PackedField> fields;
+    Pack::append(fields);
+
+    // The order of active uniforms is implementation-defined, compare by
+    // offset.
+    std::vector<UniformBlock::Field> reflected(block.fieldsBegin(),
+                                               block.fieldsEnd());
+    std::stable_sort(reflected.begin(), reflected.end(),
+                     [](UniformBlock::Field const& lhs,
+                        UniformBlock::Field const& rhs) {
+                       return lhs.offset < rhs.offset;
+                     });
+    if (reflected.size() != fields.size()) {
+      NDJINN_THROW("uniform block " << block.index() << " has "
+                   << reflected.size() << " members, packed block has "
+                   << fields.size());
+    }
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+      detail::PackedField const& field = fields[i];
+      UniformBlock::Field const& actual = reflected[i];
+      if (actual.type != field.type ||
+          actual.size != field.count ||
+          actual.offset != field.offset ||
+          actual.arrayStride != field.arrayStride ||
+          actual.matrixStride != field.matrixStride ||
+          actual.rowMajor) {
+        NDJINN_THROW("uniform block member '" << actual.name
+                     << "' does not match packed member " << i
+                     << ": offset " << actual.offset << " vs "
+                     << field.offset << ", type 0x" << std::hex
+                     << actual.type << " vs 0x" << field.type << std::dec
+                     << ", count " << actual.size << " vs " << field.count
+                     << ", array stride " << actual.arrayStride << " vs "
+                     << field.arrayStride << ", matrix stride "
+                     << actual.matrixStride << " vs " << field.matrixStride
+                     << (actual.rowMajor ? ", row major" : ""));
+      }
+    }
+    GLint const size = static_cast<GLint>(SIZE);
+    if (block.size() != size) {
+      NDJINN_THROW("uniform block " << block.index() << " is "
+                   << block.size() << " bytes, packed block is " << size);
+    }
+  }
+
+private:
+  //! Copy @a value column by column, columns are padded to the column
+  //! stride.
+  template <std::size_t I, typename T>
+  void write(std::size_t const offset, T const& value) {
+    typedef typename Field<I>::Layout Layout;
+    std::size_t const COLUMNS = Layout::Type::COLUMNS;
+    static_assert(sizeof(T) == Layout::VECTOR_SIZE * COLUMNS,
+                  "value size does not match the member type");
+    unsigned char const* const src =
+      reinterpret_cast<unsigned char const*>(&value);
+    if (COLUMNS == 1) {
+      std::memcpy(&_data[offset], src, sizeof(T));
+    }
+    else {
+      for (std::size_t c = 0; c < COLUMNS; ++c) {
+        std::memcpy(&_data[offset + c * Layout::COLUMN_STRIDE],
+                    src + c * Layout::VECTOR_SIZE, Layout::VECTOR_SIZE);
+      }
+    }
+  }
+
+  std::array<unsigned char, SIZE> _data;
+};
+
+NDJINN_END_NAMESPACE
+
+#endif // NDJINN_PACKED_BLOCK_HPP_INCLUDED
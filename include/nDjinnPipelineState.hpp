@@ -0,0 +1,777 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+#ifndef NDJINN_PIPELINE_STATE_HPP_INCLUDED
+#define NDJINN_PIPELINE_STATE_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <functional>
+
+#include "nDjinnFunctions.hpp"
+#include "nDjinnGL.hpp"
+#include "nDjinnNamespace.hpp"
+#include "nDjinnStateCache.hpp"
+
+NDJINN_BEGIN_NAMESPACE
+
+namespace detail {
+
+//! Mix the hash of @a value into @a seed.
+template <typename T> inline
+void hashCombine(std::size_t& seed, T const& value)
+{
+  seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+template <typename T, std::size_t N> inline
+void hashCombine(std::size_t& seed, std::array<T, N> const& values)
+{
+  for (auto iter = values.begin(); iter != values.end(); ++iter) {
+    hashCombine(seed, *iter);
+  }
+}
+
+//! glEnable or glDisable. May throw.
+inline void capability(GLenum const cap, bool const enabled)
+{
+  if (enabled) {
+    enable(cap);
+  }
+  else {
+    disable(cap);
+  }
+}
+
+//! Index of a face in per-face state arrays, front first.
+inline std::size_t faceIndex(GLenum const face)
+{
+  return face == GL_BACK ? 1 : 0;
+}
+
+} // Namespace: detail.
+
+// Pipeline state objects. Each type groups related fixed-function state
+// into an immutable value with a precomputed hash, so that states can be
+// compared cheaply, e.g. when sorting draws. New states are derived with
+// the with* functions, which return modified copies:
+//
+//   ndj::BlendState const alphaBlend = ndj::BlendState()
+//     .withEnabled(true)
+//     .withFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+//
+// apply() makes a state current. The setters it uses skip redundant calls
+// while a StateCache is current, without one every setter reaches the
+// driver. apply(previous) instead assumes that @a previous is the current
+// state and only makes calls for the parts that differ, which needs no
+// cache. Default constructed states match the OpenGL defaults.
+
+//! Blending state. Per draw buffer blending is not covered.
+class BlendState {
+public:
+  BlendState()
+    : _enabled(false)
+    , _hash(0)
+  {
+    _equation[0] = GL_FUNC_ADD;
+    _equation[1] = GL_FUNC_ADD;
+    _func[0] = GL_ONE;
+    _func[1] = GL_ZERO;
+    _func[2] = GL_ONE;
+    _func[3] = GL_ZERO;
+    _color.fill(0.f);
+    rehash();
+  }
+
+  //! GL_BLEND.
+  BlendState withEnabled(bool const enabled) const {
+    BlendState state(*this);
+    state._enabled = enabled;
+    state.rehash();
+    return state;
+  }
+
+  BlendState withEquation(GLenum const mode) const {
+    return withEquationSeparate(mode, mode);
+  }
+
+  BlendState withEquationSeparate(GLenum const modeRgb,
+                                  GLenum const modeAlpha) const {
+    BlendState state(*this);
+    state._equation[0] = modeRgb;
+    state._equation[1] = modeAlpha;
+    state.rehash();
+    return state;
+  }
+
+  BlendState withFunc(GLenum const src, GLenum const dst) const {
+    return withFuncSeparate(src, dst, src, dst);
+  }
+
+  BlendState withFuncSeparate(GLenum const srcRgb, GLenum const dstRgb,
+                              GLenum const srcAlpha,
+                              GLenum const dstAlpha) const {
+    BlendState state(*this);
+    state._func[0] = srcRgb;
+    state._func[1] = dstRgb;
+    state._func[2] = srcAlpha;
+    state._func[3] = dstAlpha;
+    state.rehash();
+    return state;
+  }
+
+  BlendState withColor(GLfloat const red, GLfloat const green,
+                       GLfloat const blue, GLfloat const alpha) const {
+    BlendState state(*this);
+    state._color[0] = red;
+    state._color[1] = green;
+    state._color[2] = blue;
+    state._color[3] = alpha;
+    state.rehash();
+    return state;
+  }
+
+  bool enabled() const {
+    return _enabled;
+  }
+
+  StateCache::BlendEquation const& equation() const {
+    return _equation;
+  }
+
+  StateCache::BlendFunc const& func() const {
+    return _func;
+  }
+
+  StateCache::Color const& color() const {
+    return _color;
+  }
+
+  std::size_t hash() const {
+    return _hash;
+  }
+
+  bool operator==(BlendState const& rhs) const {
+    return _hash == rhs._hash && _enabled == rhs._enabled &&
+           _equation == rhs._equation && _func == rhs._func &&
+           _color == rhs._color;
+  }
+
+  bool operator!=(BlendState const& rhs) const {
+    return !(*this == rhs);
+  }
+
+  //! Make this the current blend state. May throw.
+  void apply() const {
+    apply(nullptr);
+  }
+
+  //! Make this the current blend state, assuming that @a previous is.
+  //! May throw.
+  void apply(BlendState const& previous) const {
+    if (previous != *this) {
+      apply(&previous);
+    }
+  }
+
+private:
+  void apply(BlendState const* previous) const {
+    if (previous == nullptr || previous->_enabled != _enabled) {
+      detail::capability(GL_BLEND, _enabled);
+    }
+    if (previous == nullptr || previous->_equation != _equation) {
+      blendEquationSeparate(_equation[0], _equation[1]);
+    }
+    if (previous == nullptr || previous->_func != _func) {
+      blendFuncSeparate(_func[0], _func[1], _func[2], _func[3]);
+    }
+    if (previous == nullptr || previous->_color != _color) {
+      blendColor(_color[0], _color[1], _color[2], _color[3]);
+    }
+  }
+
+  void rehash() {
+    _hash = 0;
+    detail::hashCombine(_hash, _enabled);
+    detail::hashCombine(_hash, _equation);
+    detail::hashCombine(_hash, _func);
+    detail::hashCombine(_hash, _color);
+  }
+
+  bool _enabled;
+  StateCache::BlendEquation _equation;
+  StateCache::BlendFunc _func;
+  StateCache::Color _color;
+  std::size_t _hash;
+};
+
+//! Depth and stencil test state. Stencil state is per face, the @a face
+//! arguments take GL_FRONT, GL_BACK or GL_FRONT_AND_BACK.
+class DepthStencilState {
+public:
+  DepthStencilState()
+    : _depthTest(false)
+    , _depthWrite(GL_TRUE)
+    , _depthFunc(GL_LESS)
+    , _stencilTest(false)
+    , _hash(0)
+  {
+    for (std::size_t i = 0; i < 2; ++i) {
+      _stencilFunc[i][0] = GL_ALWAYS;
+      _stencilFunc[i][1] = 0;
+      _stencilFunc[i][2] = ~GLuint(0);
+      _stencilOp[i].fill(GL_KEEP);
+      _stencilWriteMask[i] = ~GLuint(0);
+    }
+    rehash();
+  }
+
+  //! GL_DEPTH_TEST.
+  DepthStencilState withDepthTest(bool const enabled) const {
+    DepthStencilState state(*this);
+    state._depthTest = enabled;
+    state.rehash();
+    return state;
+  }
+
+  //! glDepthMask.
+  DepthStencilState withDepthWrite(GLboolean const mask) const {
+    DepthStencilState state(*this);
+    state._depthWrite = mask;
+    state.rehash();
+    return state;
+  }
+
+  DepthStencilState withDepthFunc(GLenum const func) const {
+    DepthStencilState state(*this);
+    state._depthFunc = func;
+    state.rehash();
+    return state;
+  }
+
+  //! GL_STENCIL_TEST.
+  DepthStencilState withStencilTest(bool const enabled) const {
+    DepthStencilState state(*this);
+    state._stencilTest = enabled;
+    state.rehash();
+    return state;
+  }
+
+  DepthStencilState withStencilFunc(GLenum const face, GLenum const func,
+                                    GLint const ref,
+                                    GLuint const mask) const {
+    StateCache::StencilFunc const stencil = {{
+      func, static_cast<GLuint>(ref), mask }};
+    DepthStencilState state(*this);
+    state.setFace(state._stencilFunc, face, stencil);
+    state.rehash();
+    return state;
+  }
+
+  DepthStencilState withStencilOp(GLenum const face, GLenum const sfail,
+                                  GLenum const dpfail,
+                                  GLenum const dppass) const {
+    StateCache::StencilOp const op = {{ sfail, dpfail, dppass }};
+    DepthStencilState state(*this);
+    state.setFace(state._stencilOp, face, op);
+    state.rehash();
+    return state;
+  }
+
+  //! glStencilMaskSeparate.
+  DepthStencilState withStencilWriteMask(GLenum const face,
+                                         GLuint const mask) const {
+    DepthStencilState state(*this);
+    state.setFace(state._stencilWriteMask, face, mask);
+    state.rehash();
+    return state;
+  }
+
+  bool depthTest() const {
+    return _depthTest;
+  }
+
+  GLboolean depthWrite() const {
+    return _depthWrite;
+  }
+
+  GLenum depthFunc() const {
+    return _depthFunc;
+  }
+
+  bool stencilTest() const {
+    return _stencilTest;
+  }
+
+  StateCache::StencilFunc const& stencilFunc(GLenum const face) const {
+    return _stencilFunc[detail::faceIndex(face)];
+  }
+
+  StateCache::StencilOp const& stencilOp(GLenum const face) const {
+    return _stencilOp[detail::faceIndex(face)];
+  }
+
+  GLuint stencilWriteMask(GLenum const face) const {
+    return _stencilWriteMask[detail::faceIndex(face)];
+  }
+
+  std::size_t hash() const {
+    return _hash;
+  }
+
+  bool operator==(DepthStencilState const& rhs) const {
+    return _hash == rhs._hash && _depthTest == rhs._depthTest &&
+           _depthWrite == rhs._depthWrite && _depthFunc == rhs._depthFunc &&
+           _stencilTest == rhs._stencilTest &&
+           _stencilFunc == rhs._stencilFunc && _stencilOp == rhs._stencilOp &&
+           _stencilWriteMask == rhs._stencilWriteMask;
+  }
+
+  bool operator!=(DepthStencilState const& rhs) const {
+    return !(*this == rhs);
+  }
+
+  //! Make this the current depth/stencil state. May throw.
+  void apply() const {
+    apply(nullptr);
+  }
+
+  //! Make this the current depth/stencil state, assuming that @a previous
+  //! is. May throw.
+  void apply(DepthStencilState const& previous) const {
+    if (previous != *this) {
+      apply(&previous);
+    }
+  }
+
+private:
+  template <typename T>
+  static void setFace(std::array<T, 2>& values, GLenum const face,
+                      T const& value) {
+    if (face != GL_BACK) {
+      values[0] = value;
+    }
+    if (face != GL_FRONT) {
+      values[1] = value;
+    }
+  }
+
+  //! Calls @a set once for both faces if they agree, otherwise once per
+  //! face that changed.
+  template <typename T, typename F>
+  static void applyFaces(std::array<T, 2> const& values,
+                         std::array<T, 2> const* previous, F const& set) {
+    if (previous != nullptr && *previous == values) {
+      return;
+    }
+    if (values[0] == values[1]) {
+      set(GL_FRONT_AND_BACK, values[0]);
+      return;
+    }
+    if (previous == nullptr || (*previous)[0] != values[0]) {
+      set(GL_FRONT, values[0]);
+    }
+    if (previous == nullptr || (*previous)[1] != values[1]) {
+      set(GL_BACK, values[1]);
+    }
+  }
+
+  void apply(DepthStencilState const* previous) const {
+    if (previous == nullptr || previous->_depthTest != _depthTest) {
+      detail::capability(GL_DEPTH_TEST, _depthTest);
+    }
+    if (previous == nullptr || previous->_depthWrite != _depthWrite) {
+      depthMask(_depthWrite);
+    }
+    if (previous == nullptr || previous->_depthFunc != _depthFunc) {
+      ndj::depthFunc(_depthFunc);
+    }
+    if (previous == nullptr || previous->_stencilTest != _stencilTest) {
+      detail::capability(GL_STENCIL_TEST, _stencilTest);
+    }
+    applyFaces(_stencilFunc,
+               previous != nullptr ? &previous->_stencilFunc : nullptr,
+               [](GLenum const face, StateCache::StencilFunc const& func) {
+                 stencilFuncSeparate(face, func[0],
+                                     static_cast<GLint>(func[1]), func[2]);
+               });
+    applyFaces(_stencilOp,
+               previous != nullptr ? &previous->_stencilOp : nullptr,
+               [](GLenum const face, StateCache::StencilOp const& op) {
+                 stencilOpSeparate(face, op[0], op[1], op[2]);
+               });
+    applyFaces(_stencilWriteMask,
+               previous != nullptr ? &previous->_stencilWriteMask : nullptr,
+               [](GLenum const face, GLuint const mask) {
+                 stencilMaskSeparate(face, mask);
+               });
+  }
+
+  void rehash() {
+    _hash = 0;
+    detail::hashCombine(_hash, _depthTest);
+    detail::hashCombine(_hash, _depthWrite);
+    detail::hashCombine(_hash, _depthFunc);
+    detail::hashCombine(_hash, _stencilTest);
+    for (std::size_t i = 0; i < 2; ++i) {
+      detail::hashCombine(_hash, _stencilFunc[i]);
+      detail::hashCombine(_hash, _stencilOp[i]);
+      detail::hashCombine(_hash, _stencilWriteMask[i]);
+    }
+  }
+
+  bool _depthTest;
+  GLboolean _depthWrite;
+  GLenum _depthFunc;
+  bool _stencilTest;
+  std::array<StateCache::StencilFunc, 2> _stencilFunc; //!< Front, back.
+  std::array<StateCache::StencilOp, 2> _stencilOp; //!< Front, back.
+  std::array<GLuint, 2> _stencilWriteMask; //!< Front, back.
+  std::size_t _hash;
+};
+
+//! Rasterization state.
+class RasterState {
+public:
+  RasterState()
+    : _culling(false)
+    , _cullFace(GL_BACK)
+    , _frontFace(GL_CCW)
+    , _lineWidth(1.f)
+    , _polygonOffsetFill(false)
+    , _scissorTest(false)
+    , _hash(0)
+  {
+    _polygonOffset.fill(0.f);
+    rehash();
+  }
+
+  //! GL_CULL_FACE.
+  RasterState withCulling(bool const enabled) const {
+    RasterState state(*this);
+    state._culling = enabled;
+    state.rehash();
+    return state;
+  }
+
+  RasterState withCullFace(GLenum const mode) const {
+    RasterState state(*this);
+    state._cullFace = mode;
+    state.rehash();
+    return state;
+  }
+
+  RasterState withFrontFace(GLenum const mode) const {
+    RasterState state(*this);
+    state._frontFace = mode;
+    state.rehash();
+    return state;
+  }
+
+  RasterState withLineWidth(GLfloat const width) const {
+    RasterState state(*this);
+    state._lineWidth = width;
+    state.rehash();
+    return state;
+  }
+
+  //! GL_POLYGON_OFFSET_FILL.
+  RasterState withPolygonOffsetFill(bool const enabled) const {
+    RasterState state(*this);
+    state._polygonOffsetFill = enabled;
+    state.rehash();
+    return state;
+  }
+
+  RasterState withPolygonOffset(GLfloat const factor,
+                                GLfloat const units) const {
+    RasterState state(*this);
+    state._polygonOffset[0] = factor;
+    state._polygonOffset[1] = units;
+    state.rehash();
+    return state;
+  }
+
+  //! GL_SCISSOR_TEST.
+  RasterState withScissorTest(bool const enabled) const {
+    RasterState state(*this);
+    state._scissorTest = enabled;
+    state.rehash();
+    return state;
+  }
+
+  bool culling() const {
+    return _culling;
+  }
+
+  GLenum cullFace() const {
+    return _cullFace;
+  }
+
+  GLenum frontFace() const {
+    return _frontFace;
+  }
+
+  GLfloat lineWidth() const {
+    return _lineWidth;
+  }
+
+  bool polygonOffsetFill() const {
+    return _polygonOffsetFill;
+  }
+
+  StateCache::PolygonOffset const& polygonOffset() const {
+    return _polygonOffset;
+  }
+
+  bool scissorTest() const {
+    return _scissorTest;
+  }
+
+  std::size_t hash() const {
+    return _hash;
+  }
+
+  bool operator==(RasterState const& rhs) const {
+    return _hash == rhs._hash && _culling == rhs._culling &&
+           _cullFace == rhs._cullFace && _frontFace == rhs._frontFace &&
+           _lineWidth == rhs._lineWidth &&
+           _polygonOffsetFill == rhs._polygonOffsetFill &&
+           _polygonOffset == rhs._polygonOffset &&
+           _scissorTest == rhs._scissorTest;
+  }
+
+  bool operator!=(RasterState const& rhs) const {
+    return !(*this == rhs);
+  }
+
+  //! Make this the current raster state. May throw.
+  void apply() const {
+    apply(nullptr);
+  }
+
+  //! Make this the current raster state, assuming that @a previous is.
+  //! May throw.
+  void apply(RasterState const& previous) const {
+    if (previous != *this) {
+      apply(&previous);
+    }
+  }
+
+private:
+  void apply(RasterState const* previous) const {
+    if (previous == nullptr || previous->_culling != _culling) {
+      detail::capability(GL_CULL_FACE, _culling);
+    }
+    if (previous == nullptr || previous->_cullFace != _cullFace) {
+      ndj::cullFace(_cullFace);
+    }
+    if (previous == nullptr || previous->_frontFace != _frontFace) {
+      ndj::frontFace(_frontFace);
+    }
+    if (previous == nullptr || previous->_lineWidth != _lineWidth) {
+      ndj::lineWidth(_lineWidth);
+    }
+    if (previous == nullptr ||
+        previous->_polygonOffsetFill != _polygonOffsetFill) {
+      detail::capability(GL_POLYGON_OFFSET_FILL, _polygonOffsetFill);
+    }
+    if (previous == nullptr || previous->_polygonOffset != _polygonOffset) {
+      ndj::polygonOffset(_polygonOffset[0], _polygonOffset[1]);
+    }
+    if (previous == nullptr || previous->_scissorTest != _scissorTest) {
+      detail::capability(GL_SCISSOR_TEST, _scissorTest);
+    }
+  }
+
+  void rehash() {
+    _hash = 0;
+    detail::hashCombine(_hash, _culling);
+    detail::hashCombine(_hash, _cullFace);
+    detail::hashCombine(_hash, _frontFace);
+    detail::hashCombine(_hash, _lineWidth);
+    detail::hashCombine(_hash, _polygonOffsetFill);
+    detail::hashCombine(_hash, _polygonOffset);
+    detail::hashCombine(_hash, _scissorTest);
+  }
+
+  bool _culling;
+  GLenum _cullFace;
+  GLenum _frontFace;
+  GLfloat _lineWidth;
+  bool _polygonOffsetFill;
+  StateCache::PolygonOffset _polygonOffset;
+  bool _scissorTest;
+  std::size_t _hash;
+};
+
+//! Color write mask. Per draw buffer masks are not covered.
+class ColorMask {
+public:
+  ColorMask(GLboolean const r = GL_TRUE, GLboolean const g = GL_TRUE,
+            GLboolean const b = GL_TRUE, GLboolean const a = GL_TRUE)
+    : _hash(0)
+  {
+    _mask[0] = r;
+    _mask[1] = g;
+    _mask[2] = b;
+    _mask[3] = a;
+    detail::hashCombine(_hash, _mask);
+  }
+
+  StateCache::Mask const& mask() const {
+    return _mask;
+  }
+
+  std::size_t hash() const {
+    return _hash;
+  }
+
+  bool operator==(ColorMask const& rhs) const {
+    return _mask == rhs._mask;
+  }
+
+  bool operator!=(ColorMask const& rhs) const {
+    return !(*this == rhs);
+  }
+
+  //! Make this the current color mask. May throw.
+  void apply() const {
+    colorMask(_mask[0], _mask[1], _mask[2], _mask[3]);
+  }
+
+  //! Make this the current color mask, assuming that @a previous is.
+  //! May throw.
+  void apply(ColorMask const& previous) const {
+    if (previous != *this) {
+      apply();
+    }
+  }
+
+private:
+  StateCache::Mask _mask;
+  std::size_t _hash;
+};
+
+//! All of the above, set together per draw.
+class PipelineState {
+public:
+  PipelineState(BlendState const& blend = BlendState(),
+                DepthStencilState const& depthStencil = DepthStencilState(),
+                RasterState const& raster = RasterState(),
+                ColorMask const& colorMask = ColorMask())
+    : _blend(blend)
+    , _depthStencil(depthStencil)
+    , _raster(raster)
+    , _colorMask(colorMask)
+    , _hash(0)
+  {
+    detail::hashCombine(_hash, _blend.hash());
+    detail::hashCombine(_hash, _depthStencil.hash());
+    detail::hashCombine(_hash, _raster.hash());
+    detail::hashCombine(_hash, _colorMask.hash());
+  }
+
+  BlendState const& blend() const {
+    return _blend;
+  }
+
+  DepthStencilState const& depthStencil() const {
+    return _depthStencil;
+  }
+
+  RasterState const& raster() const {
+    return _raster;
+  }
+
+  ColorMask const& colorMask() const {
+    return _colorMask;
+  }
+
+  std::size_t hash() const {
+    return _hash;
+  }
+
+  bool operator==(PipelineState const& rhs) const {
+    return _hash == rhs._hash && _blend == rhs._blend &&
+           _depthStencil == rhs._depthStencil && _raster == rhs._raster &&
+           _colorMask == rhs._colorMask;
+  }
+
+  bool operator!=(PipelineState const& rhs) const {
+    return !(*this == rhs);
+  }
+
+  //! Make this the current state. May throw.
+  void apply() const {
+    _blend.apply();
+    _depthStencil.apply();
+    _raster.apply();
+    _colorMask.apply();
+  }
+
+  //! Make this the current state, assuming that @a previous is. May throw.
+  void apply(PipelineState const& previous) const {
+    if (previous == *this) {
+      return;
+    }
+    _blend.apply(previous._blend);
+    _depthStencil.apply(previous._depthStencil);
+    _raster.apply(previous._raster);
+    _colorMask.apply(previous._colorMask);
+  }
+
+private:
+  BlendState _blend;
+  DepthStencilState _depthStencil;
+  RasterState _raster;
+  ColorMask _colorMask;
+  std::size_t _hash;
+};
+
+NDJINN_END_NAMESPACE
+
+namespace std {
+
+template <>
+struct hash<ndj::BlendState> {
+  size_t operator()(ndj::BlendState const& state) const {
+    return state.hash();
+  }
+};
+
+template <>
+struct hash<ndj::DepthStencilState> {
+  size_t operator()(ndj::DepthStencilState const& state) const {
+    return state.hash();
+  }
+};
+
+template <>
+struct hash<ndj::RasterState> {
+  size_t operator()(ndj::RasterState const& state) const {
+    return state.hash();
+  }
+};
+
+template <>
+struct hash<ndj::ColorMask> {
+  size_t operator()(ndj::ColorMask const& mask) const {
+    return mask.hash();
+  }
+};
+
+template <>
+struct hash<ndj::PipelineState> {
+  size_t operator()(ndj::PipelineState const& state) const {
+    return state.hash();
+  }
+};
+
+} // Namespace: std.
+
+#endif // NDJINN_PIPELINE_STATE_HPP_INCLUDED
@@ -8,9 +8,12 @@
 #ifndef NDJINN_QUERY_HPP_INCLUDED
 #define NDJINN_QUERY_HPP_INCLUDED
 
+#include "nDjinnDeletionQueue.hpp"
+#include "nDjinnDispatch.hpp"
 #include "nDjinnError.hpp"
 #include "nDjinnException.hpp"
 #include "nDjinnGL.hpp"
+#include "nDjinnHandlePool.hpp"
 #include "nDjinnNamespace.hpp"
 
 NDJINN_BEGIN_NAMESPACE
@@ -19,32 +22,32 @@ namespace detail {
 
 //! glGenQueries wrapper. May throw.
 inline void genQueries(GLsizei const n, GLuint* queries) {
-  glGenQueries(n, queries);
+  NDJINN_GL(GenQueries)(n, queries);
   checkError("glGenQueries");
 }
 
 //! glDeleteQueries wrapper. May throw.
 inline void deleteQueries(GLsizei const n, GLuint const* queries) {
-  glDeleteQueries(n, queries);
+  NDJINN_GL(DeleteQueries)(n, queries);
   checkError("glDeleteQueries");
 }
 
 //! glIsQuery wrapper. May throw.
 inline GLboolean isQuery(GLuint const query) {
-  GLboolean const result = glIsQuery(query);
+  GLboolean const result = NDJINN_GL(IsQuery)(query);
   checkError("glIsQuery");
   return result;
 }
 
 //! glQueryCounter wrapper. May throw.
 inline void queryCounter(GLuint const id) {
-  glQueryCounter(id, GL_TIMESTAMP);
+  NDJINN_GL(QueryCounter)(id, GL_TIMESTAMP);
   checkError("glQueryCounter");
 }
 
 //! glBeginQuery wrapper. May throw.
 inline void beginQuery(GLenum const target, GLuint const id) {
-  glBeginQuery(target, id);
+  NDJINN_GL(BeginQuery)(target, id);
   checkError("glBeginQuery");
 }
 
@@ -52,25 +55,25 @@ inline void beginQuery(GLenum const target, GLuint const id) {
 inline void beginQueryIndexed(GLenum const target,
                               GLuint const index,
                               GLuint const id) {
-  glBeginQueryIndexed(target, index, id);
+  NDJINN_GL(BeginQueryIndexed)(target, index, id);
   checkError("glBeginQueryIndexed");
 }
 
 //! glEndQuery wrapper. May throw.
 inline void endQuery(GLenum const target) {
-  glEndQuery(target);
+  NDJINN_GL(EndQuery)(target);
   checkError("glEndQuery");
 }
 
 //! glEndQueryIndexed wrapper. May throw.
 inline void endQueryIndexed(GLenum const target, GLuint const index) {
-  glEndQueryIndexed(target, index);
+  NDJINN_GL(EndQueryIndexed)(target, index);
   checkError("glEndQueryIndexed");
 }
 
 //! glGetQueryiv wrapper. May throw.
 inline void getQueryiv(GLenum const target, GLenum const pname, GLint* params) {
-  glGetQueryiv(target, pname, params);
+  NDJINN_GL(GetQueryiv)(target, pname, params);
   checkError("glGetQueryiv");
 }
 
@@ -79,7 +82,7 @@ inline void getQueryIndexediv(GLenum const target,
                               GLuint const index,
                               GLenum const pname,
                               GLint* params) {
-  glGetQueryIndexediv(target, index, pname, params);
+  NDJINN_GL(GetQueryIndexediv)(target, index, pname, params);
   checkError("glGetQueryIndexediv");
 }
 
@@ -87,7 +90,7 @@ inline void getQueryIndexediv(GLenum const target,
 inline void getQueryObjectiv(GLuint const id,
                              GLenum const pname,
                              GLint* params) {
-  glGetQueryObjectiv(id, pname, params);
+  NDJINN_GL(GetQueryObjectiv)(id, pname, params);
   checkError("glGetQueryObjectiv");
 }
 
@@ -95,7 +98,7 @@ inline void getQueryObjectiv(GLuint const id,
 inline void getQueryObjectuiv(GLuint const id,
                               GLenum const pname,
                               GLuint* params) {
-  glGetQueryObjectuiv(id, pname, params);
+  NDJINN_GL(GetQueryObjectuiv)(id, pname, params);
   checkError("glGetQueryObjectuiv");
 }
 
@@ -103,7 +106,7 @@ inline void getQueryObjectuiv(GLuint const id,
 inline void getQueryObjecti64v(GLuint const id,
                                GLenum const pname,
                                GLint64* params) {
-  glGetQueryObjecti64v(id, pname, params);
+  NDJINN_GL(GetQueryObjecti64v)(id, pname, params);
   checkError("glGetQueryObjecti64v");
 }
 
@@ -111,7 +114,7 @@ inline void getQueryObjecti64v(GLuint const id,
 inline void getQueryObjectui64v(GLuint const id,
                                 GLenum const pname,
                                 GLuint64* params) {
-  glGetQueryObjectui64v(id, pname, params);
+  NDJINN_GL(GetQueryObjectui64v)(id, pname, params);
   checkError("glGetQueryObjectui64v");
 }
 
@@ -149,6 +152,10 @@ getQueryObjectv<GLuint64>(GLuint const id,
 
 //! Convenience.
 inline GLuint genQuery() {
+  HandlePools* const pools = HandlePools::current();
+  if (pools != nullptr) {
+    return pools->queries.acquire(&genQueries, &deleteQueries);
+  }
   GLuint query = 0;
   genQueries(1, &query);
   return query;
@@ -156,6 +163,16 @@ inline GLuint genQuery() {
 
 //! Convenience.
 inline void deleteQuery(GLuint const& query) {
+  HandlePools* const pools = HandlePools::current();
+  if (pools != nullptr) {
+    pools->queries.release(query, &deleteQueries);
+    return;
+  }
+  DeletionQueue* const queue = DeletionQueue::current();
+  if (queue != nullptr) {
+    queue->push(&deleteQueries, query);
+    return;
+  }
   deleteQueries(1, &query);
 }
 
@@ -174,7 +191,30 @@ public:
   }
 
   ~Query() {
-    detail::deleteQuery(_handle);
+    if (_handle != 0) {
+      detail::deleteQuery(_handle);
+    }
+  }
+
+  //! Move CTOR, @a rhs is left empty, i.e. with a zero handle.
+  Query(Query&& rhs) noexcept
+    : _handle(rhs._handle)
+    , _target(rhs._target)
+  {
+    rhs._handle = 0;
+  }
+
+  //! Move assign, the current resource is deleted and @a rhs left empty.
+  Query& operator=(Query&& rhs) noexcept {
+    if (this != &rhs) {
+      if (_handle != 0) {
+        detail::releaseNoThrow(&detail::deleteQuery, _handle);
+      }
+      _handle = rhs._handle;
+      _target = rhs._target;
+      rhs._handle = 0;
+    }
+    return *this;
   }
 
   void begin() {
@@ -204,8 +244,8 @@ private:
   Query(Query const&); //!< Disabled copy.
   Query& operator=(Query const&); //!< Disabled assign.
 
-  GLuint const _handle;
-  GLenum const _target;
+  GLuint _handle;
+  GLenum _target;
 };
 
 //! DOCS
@@ -222,7 +262,32 @@ public:
   }
 
   ~IndexedQuery() {
-    detail::deleteQuery(_handle);
+    if (_handle != 0) {
+      detail::deleteQuery(_handle);
+    }
+  }
+
+  //! Move CTOR, @a rhs is left empty, i.e. with a zero handle.
+  IndexedQuery(IndexedQuery&& rhs) noexcept
+    : _handle(rhs._handle)
+    , _target(rhs._target)
+    , _index(rhs._index)
+  {
+    rhs._handle = 0;
+  }
+
+  //! Move assign, the current resource is deleted and @a rhs left empty.
+  IndexedQuery& operator=(IndexedQuery&& rhs) noexcept {
+    if (this != &rhs) {
+      if (_handle != 0) {
+        detail::releaseNoThrow(&detail::deleteQuery, _handle);
+      }
+      _handle = rhs._handle;
+      _target = rhs._target;
+      _index = rhs._index;
+      rhs._handle = 0;
+    }
+    return *this;
   }
 
   void begin() {
@@ -252,9 +317,9 @@ private:
   IndexedQuery(IndexedQuery const&); //!< Disabled copy.
   IndexedQuery& operator=(IndexedQuery const&); //!< Disabled assign.
 
-  GLuint const _handle;
-  GLenum const _target;
-  GLuint const _index;
+  GLuint _handle;
+  GLenum _target;
+  GLuint _index;
 };
 
 NDJINN_END_NAMESPACE
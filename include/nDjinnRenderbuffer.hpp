@@ -10,8 +10,11 @@
 
 #include <iostream>
 
+#include "nDjinnDeletionQueue.hpp"
+#include "nDjinnDispatch.hpp"
 #include "nDjinnError.hpp"
 #include "nDjinnException.hpp"
+#include "nDjinnHandlePool.hpp"
 #include "nDjinnNamespace.hpp"
 
 NDJINN_BEGIN_NAMESPACE
@@ -21,30 +24,30 @@ namespace detail {
 //! glGenRenderbuffers wrapper. May throw.
 inline void genRenderbuffers(GLsizei const n, GLuint* renderbuffers)
 {
-  glGenRenderbuffers(n, renderbuffers);
+  NDJINN_GL(GenRenderbuffers)(n, renderbuffers);
   checkError("glGenRenderbuffers");
 }
 
 //! glDeleteRenderbuffers wrapper. May throw.
 inline void deleteRenderbuffers(GLsizei const n, GLuint const* renderbuffers)
 {
-  glDeleteRenderbuffers(n, renderbuffers);
+  NDJINN_GL(DeleteRenderbuffers)(n, renderbuffers);
   checkError("glDeleteRenderbuffers");
 }
 
 //! glIsRenderbuffer wrapper. May throw.
 inline GLboolean isRenderbuffer(GLuint const renderbuffer)
 {
-  GLboolean const result = glIsRenderbuffer(renderbuffer);
+  GLboolean const result = NDJINN_GL(IsRenderbuffer)(renderbuffer);
   checkError("glIsRenderbuffer");
   return result;
 }
 
 //! glBindRenderbuffer wrapper. May throw.
-inline GLboolean bindRenderbuffer(GLenum const target,
-                                  GLuint const renderbuffer)
+inline void bindRenderbuffer(GLenum const target,
+                             GLuint const renderbuffer)
 {
-  glBindRenderbuffer(target, renderbuffer);
+  NDJINN_GL(BindRenderbuffer)(target, renderbuffer);
   checkError("glBindRenderbuffer");
 }
 
@@ -55,7 +58,7 @@ inline void namedRenderbufferStorageMultisample(GLuint const renderbuffer,
                                                 GLsizei const width,
                                                 GLsizei const height)
 {
-  glNamedRenderbufferStorageMultisampleEXT(renderbuffer, samples,
+  NDJINN_GL(NamedRenderbufferStorageMultisampleEXT)(renderbuffer, samples,
                                            internalformat, width, height);
   checkError("glNamedRenderbufferStorageMultisampleEXT");
 }
@@ -64,20 +67,34 @@ inline void namedRenderbufferStorageMultisample(GLuint const renderbuffer,
 inline void getNamedRenderbufferParameteriv(GLuint const renderbuffer,
                                             GLenum const pname, GLint* params)
 {
-  glGetNamedRenderbufferParameterivEXT(renderbuffer, pname, params);
+  NDJINN_GL(GetNamedRenderbufferParameterivEXT)(renderbuffer, pname, params);
   checkError("glGetNamedRenderbufferParameterivEXT");
 }
 
 //! Convenience.
 inline GLuint genRenderbuffer() {
+  HandlePools* const pools = HandlePools::current();
+  if (pools != nullptr) {
+    return pools->renderbuffers.acquire(&genRenderbuffers, &deleteRenderbuffers);
+  }
   GLuint handle = 0;
-  genFramebuffers(1, &handle);
+  genRenderbuffers(1, &handle);
   return handle;
 }
 
 //! Convenience.
 inline void deleteRenderbuffer(GLuint const handle) {
-  deleteFramebuffers(1, &handle);
+  HandlePools* const pools = HandlePools::current();
+  if (pools != nullptr) {
+    pools->renderbuffers.release(handle, &deleteRenderbuffers);
+    return;
+  }
+  DeletionQueue* const queue = DeletionQueue::current();
+  if (queue != nullptr) {
+    queue->push(&deleteRenderbuffers, handle);
+    return;
+  }
+  deleteRenderbuffers(1, &handle);
 }
 
 //! Convenience.
@@ -106,7 +123,29 @@ public:
 
   ~Renderbuffer()
   {
-    detail::deleteRenderbuffer(_handle);
+    if (_handle != 0) {
+      detail::deleteRenderbuffer(_handle);
+    }
+  }
+
+  //! Move CTOR, @a rhs is left empty, i.e. with a zero handle.
+  Renderbuffer(Renderbuffer&& rhs) noexcept
+    : _handle(rhs._handle)
+  {
+    rhs._handle = 0;
+  }
+
+  //! Move assign, the current resource is deleted and @a rhs left empty.
+  Renderbuffer& operator=(Renderbuffer&& rhs) noexcept
+  {
+    if (this != &rhs) {
+      if (_handle != 0) {
+        detail::releaseNoThrow(&detail::deleteRenderbuffer, _handle);
+      }
+      _handle = rhs._handle;
+      rhs._handle = 0;
+    }
+    return *this;
   }
 
   GLuint handle() const
@@ -135,7 +174,7 @@ private:
     }
   }
 
-  GLuint const _handle;
+  GLuint _handle;
 };
 
 NDJINN_END_NAMESPACE
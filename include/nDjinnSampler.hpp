@@ -8,9 +8,15 @@
 #ifndef NDJINN_SAMPLER_HPP_INCLUDED
 #define NDJINN_SAMPLER_HPP_INCLUDED
 
+#include <array>
+#include <cstddef>
+
+#include "nDjinnDeletionQueue.hpp"
+#include "nDjinnDispatch.hpp"
 #include "nDjinnError.hpp"
 #include "nDjinnException.hpp"
 #include "nDjinnGL.hpp"
+#include "nDjinnHandlePool.hpp"
 #include "nDjinnNamespace.hpp"
 
 NDJINN_BEGIN_NAMESPACE
@@ -19,27 +25,34 @@ namespace detail {
 
 //! glGenSamplers wrapper. May throw.
 inline void genSamplers(GLsizei const count, GLuint* samplers) {
-  glGenSamplers(count, samplers);
+  NDJINN_GL(GenSamplers)(count, samplers);
   checkError("glGenSamplers");
 }
 
 //! glDeleteSamplers wrapper. May throw.
 inline void deleteSamplers(GLsizei const count, GLuint const* samplers) {
-  glDeleteSamplers(count, samplers);
+  NDJINN_GL(DeleteSamplers)(count, samplers);
   checkError("glDeleteSamplers");
 }
 
 //! glBindSampler wrapper. May throw.
 inline void bindSampler(GLuint const unit, GLuint const sampler) {
-  glBindSampler(unit, sampler);
+  NDJINN_GL(BindSampler)(unit, sampler);
   checkError("glBindSampler"); 
 }
 
+//! glBindSamplers wrapper. Null @a samplers unbinds the units. May throw.
+inline void bindSamplers(GLuint const first, GLsizei const count,
+                         GLuint const* samplers) {
+  NDJINN_GL(BindSamplers)(first, count, samplers);
+  checkError("glBindSamplers");
+}
+
 //! glSamplerParameteri wrapper. May throw.
 inline void samplerParameteri(GLuint const sampler, 
                               GLenum const pname,
                               GLint const param) {
-  glSamplerParameteri(sampler, pname, param);
+  NDJINN_GL(SamplerParameteri)(sampler, pname, param);
   checkError("glSamplerParameteri");
 }
 
@@ -47,7 +60,7 @@ inline void samplerParameteri(GLuint const sampler,
 inline void samplerParameterf(GLuint const sampler, 
                               GLenum const pname,
                               GLfloat const param) {
-  glSamplerParameterf(sampler, pname, param);
+  NDJINN_GL(SamplerParameterf)(sampler, pname, param);
   checkError("glSamplerParameterf");
 }
 
@@ -55,7 +68,7 @@ inline void samplerParameterf(GLuint const sampler,
 inline void samplerParameteriv(GLuint const sampler, 
                                GLenum const pname,
                                GLint const* param) {
-  glSamplerParameteriv(sampler, pname, param);
+  NDJINN_GL(SamplerParameteriv)(sampler, pname, param);
   checkError("glSamplerParameteriv");
 }
 
@@ -63,7 +76,7 @@ inline void samplerParameteriv(GLuint const sampler,
 inline void samplerParameterfv(GLuint const sampler, 
                                GLenum const pname,
                                GLfloat const* params) {
-  glSamplerParameterfv(sampler, pname, params);
+  NDJINN_GL(SamplerParameterfv)(sampler, pname, params);
   checkError("glSamplerParameterfv");
 }
 
@@ -71,7 +84,7 @@ inline void samplerParameterfv(GLuint const sampler,
 inline void getSamplerParameteriv(GLuint const sampler, 
                                   GLenum const pname,
                                   GLint* params) {
-  glGetSamplerParameteriv(sampler, pname, params);
+  NDJINN_GL(GetSamplerParameteriv)(sampler, pname, params);
   checkError("glSamplerParameteriv");
 }
 
@@ -79,19 +92,23 @@ inline void getSamplerParameteriv(GLuint const sampler,
 inline void getSamplerParameterfv(GLuint const sampler,
                                   GLenum const pname,
                                   GLfloat* params) {
-  glGetSamplerParameterfv(sampler, pname, params);
+  NDJINN_GL(GetSamplerParameterfv)(sampler, pname, params);
   checkError("glSamplerParameterfv");
 }
 
 //! glIsSampler wrapper. May throw.
 inline GLboolean isSampler(GLuint const sampler) {
-  GLboolean const isSampler = glIsSampler(sampler);
+  GLboolean const isSampler = NDJINN_GL(IsSampler)(sampler);
   checkError("glIsSampler");
   return isSampler;
 }
 
 //! Convenience, generate a single sampler handle and return it. May throw.
 inline GLuint genSampler() {
+  HandlePools* const pools = HandlePools::current();
+  if (pools != nullptr) {
+    return pools->samplers.acquire(&genSamplers, &deleteSamplers);
+  }
   GLuint handle = 0;
   genSamplers(1, &handle);
   return handle;
@@ -99,6 +116,16 @@ inline GLuint genSampler() {
 
 //! Convenience.
 inline void deleteSampler(GLuint const& handle) {
+  HandlePools* const pools = HandlePools::current();
+  if (pools != nullptr) {
+    pools->samplers.release(handle, &deleteSamplers);
+    return;
+  }
+  DeletionQueue* const queue = DeletionQueue::current();
+  if (queue != nullptr) {
+    queue->push(&deleteSamplers, handle);
+    return;
+  }
   deleteSamplers(1, &handle);
 }
 
@@ -178,7 +205,28 @@ public:
   }
 
   ~Sampler() {
-    detail::deleteSampler(_handle);
+    if (_handle != 0) {
+      detail::deleteSampler(_handle);
+    }
+  }
+
+  //! Move CTOR, @a rhs is left empty, i.e. with a zero handle.
+  Sampler(Sampler&& rhs) noexcept
+    : _handle(rhs._handle)
+  {
+    rhs._handle = 0;
+  }
+
+  //! Move assign, the current resource is deleted and @a rhs left empty.
+  Sampler& operator=(Sampler&& rhs) noexcept {
+    if (this != &rhs) {
+      if (_handle != 0) {
+        detail::releaseNoThrow(&detail::deleteSampler, _handle);
+      }
+      _handle = rhs._handle;
+      rhs._handle = 0;
+    }
+    return *this;
   }
 
   GLuint handle() const {
@@ -209,9 +257,24 @@ private:
   Sampler(Sampler const&); //!< Disabled copy.
   Sampler& operator=(Sampler const&); //!< Disabled assign.
 
-  GLuint const _handle; //!< Resource handle.
+  GLuint _handle; //!< Resource handle.
 };
 
+//! Bind @a samplers to consecutive texture units starting at @a first with
+//! a single call. Zero handles unbind. May throw.
+template <std::size_t N> inline
+void bindSamplers(GLuint const first, std::array<GLuint, N> const& samplers)
+{
+  detail::bindSamplers(first, static_cast<GLsizei>(N), samplers.data());
+}
+
+//! Release the samplers of @a count texture units starting at @a first.
+//! May throw.
+inline void releaseSamplers(GLuint const first, GLsizei const count)
+{
+  detail::bindSamplers(first, count, nullptr);
+}
+
 NDJINN_END_NAMESPACE
 
 #endif // NDJINN_SAMPLER_HPP_INCLUDED
@@ -11,6 +11,8 @@
 #include <string>
 #include <iostream>
 
+#include "nDjinnDeletionQueue.hpp"
+#include "nDjinnDispatch.hpp"
 #include "nDjinnError.hpp"
 #include "nDjinnException.hpp"
 #include "nDjinnGL.hpp"
@@ -23,7 +25,7 @@ namespace detail {
 //! glCreateShader wrapper. May throw. 
 inline GLuint createShader(GLenum const type)
 {
-  GLuint const shader = glCreateShader(type);
+  GLuint const shader = NDJINN_GL(CreateShader)(type);
   checkError("glCreateShader");
   return shader; 
 }
@@ -31,14 +33,35 @@ inline GLuint createShader(GLenum const type)
 //! glDeleteShader wrapper. May throw. 
 inline void deleteShader(GLuint const shader)
 {
-  glDeleteShader(shader); 
+  NDJINN_GL(DeleteShader)(shader); 
   checkError("glDeleteShader");
 }
 
+//! Delete @a count shaders, one call each since there is no batched
+//! glDeleteShaders. May throw.
+inline void deleteShaders(GLsizei const count, GLuint const* shaders)
+{
+  for (GLsizei i = 0; i < count; ++i) {
+    deleteShader(shaders[i]);
+  }
+}
+
+//! Convenience. Queues @a shader if a DeletionQueue is current.
+//! May throw.
+inline void destroyShader(GLuint const shader)
+{
+  DeletionQueue* const queue = DeletionQueue::current();
+  if (queue != nullptr) {
+    queue->push(&deleteShaders, shader);
+    return;
+  }
+  deleteShader(shader);
+}
+
 //! glIsShader wrapper. May throw.
 inline GLboolean isShader(GLuint const shader)
 {
-  GLboolean const isShader = glIsShader(shader);
+  GLboolean const isShader = NDJINN_GL(IsShader)(shader);
   checkError("glIsShader");
   return isShader; 
 }
@@ -47,14 +70,14 @@ inline GLboolean isShader(GLuint const shader)
 inline void shaderSource(GLuint const shader, GLsizei const count,
                          GLchar const** string, GLint const* length)
 {
-  glShaderSource(shader, count, string, length); 
+  NDJINN_GL(ShaderSource)(shader, count, string, length); 
   checkError("glShaderSource");
 }
 
 //! glCompileShader wrapper. May throw. 
 inline void compileShader(GLuint const shader)
 {
-  glCompileShader(shader); 
+  NDJINN_GL(CompileShader)(shader); 
   checkError("glCompileShader");
 }
 
@@ -63,7 +86,7 @@ inline void getShaderiv(GLuint const shader,
                         GLenum const pname,
                         GLint *params)
 {
-  glGetShaderiv(shader, pname, params);
+  NDJINN_GL(GetShaderiv)(shader, pname, params);
   checkError("glGetShaderiv");
 }
 
@@ -73,7 +96,7 @@ inline void getShaderInfoLog(GLuint const shader,
                              GLsizei* length,
                              GLchar* infoLog)
 {
-  glGetShaderInfoLog(shader, bufSize, length, infoLog); 
+  NDJINN_GL(GetShaderInfoLog)(shader, bufSize, length, infoLog); 
   checkError("glGetShaderInfoLog");
 }
 
@@ -83,7 +106,7 @@ inline void getShaderSource(GLuint const shader,
                             GLsizei* length,
                             GLchar* source)
 {
-  glGetShaderSource(shader, bufSize, length, source);
+  NDJINN_GL(GetShaderSource)(shader, bufSize, length, source);
   checkError("glGetShaderSource"); 
 }
 
@@ -128,7 +151,29 @@ public:
   //! DTOR
   ~Shader()
   {
-    detail::deleteShader(_handle);
+    if (_handle != 0) {
+      detail::destroyShader(_handle);
+    }
+  }
+
+  //! Move CTOR, @a rhs is left empty, i.e. with a zero handle.
+  Shader(Shader<Type>&& rhs) noexcept
+    : _handle(rhs._handle)
+  {
+    rhs._handle = 0;
+  }
+
+  //! Move assign, the current resource is deleted and @a rhs left empty.
+  Shader& operator=(Shader<Type>&& rhs) noexcept
+  {
+    if (this != &rhs) {
+      if (_handle != 0) {
+        detail::releaseNoThrow(&detail::destroyShader, _handle);
+      }
+      _handle = rhs._handle;
+      rhs._handle = 0;
+    }
+    return *this;
   }
 
   GLuint handle() const
@@ -196,7 +241,7 @@ private:
     }
   }
 
-  GLuint const _handle; //!< Resource handle.
+  GLuint _handle; //!< Resource handle.
 };
 
 // Convenient types.
@@ -13,12 +13,16 @@
 #include <algorithm>
 #include <string>
 #include <iostream>
+#include <utility>
 
+#include "nDjinnDeletionQueue.hpp"
+#include "nDjinnDispatch.hpp"
 #include "nDjinnError.hpp"
 #include "nDjinnException.hpp"
 #include "nDjinnGL.hpp"
 #include "nDjinnNamespace.hpp"
 #include "nDjinnShader.hpp"
+#include "nDjinnStateCache.hpp"
 
 NDJINN_BEGIN_NAMESPACE
 
@@ -26,45 +30,64 @@ namespace detail {
 
 //! glCreateProgram wrapper. May throw.
 inline GLuint createProgram() {
-  GLuint const program = glCreateProgram();
+  GLuint const program = NDJINN_GL(CreateProgram)();
   checkError("glCreateProgram");
   return program; 
 }
 
 //! glDeleteProgram wrapper. May throw.
 inline void deleteProgram(GLuint const program) {
-  glDeleteProgram(program); 
+  NDJINN_GL(DeleteProgram)(program); 
   checkError("glDeleteProgram"); 
 }
 
+//! Delete @a count programs, one call each since there is no batched
+//! glDeletePrograms. May throw.
+inline void deletePrograms(GLsizei const count, GLuint const* programs) {
+  for (GLsizei i = 0; i < count; ++i) {
+    deleteProgram(programs[i]);
+  }
+}
+
+//! Convenience. Queues @a program if a DeletionQueue is current.
+//! May throw.
+inline void destroyProgram(GLuint const program) {
+  DeletionQueue* const queue = DeletionQueue::current();
+  if (queue != nullptr) {
+    queue->push(&deletePrograms, program);
+    return;
+  }
+  deleteProgram(program);
+}
+
 //! glIsProgram wrapper. May throw.
 inline GLboolean isProgram(GLuint const program) {
-  const GLboolean isProgram = glIsProgram(program);
+  const GLboolean isProgram = NDJINN_GL(IsProgram)(program);
   checkError("glIsProgram");
   return isProgram;
 }
 
 //! glAttachShader wrapper. May throw.
 inline void attachShader(GLuint const program, GLuint const shader) {
-  glAttachShader(program, shader); 
+  NDJINN_GL(AttachShader)(program, shader); 
   checkError("glAttachShader");
 }
 
 //! glDetachShader wrapper. May throw.
 inline void detachShader(GLuint const program, GLuint const shader) {
-  glDetachShader(program, shader); 
+  NDJINN_GL(DetachShader)(program, shader); 
   checkError("glDetachShader");
 }
 
 //! glLinkProgram wrapper. May throw.
 inline void linkProgram(GLuint const program) {
-  glLinkProgram(program); 
+  NDJINN_GL(LinkProgram)(program); 
   checkError("glLinkProgram"); 
 }
 
 //! glValidateProgram wrapper. May throw.
 inline void validateProgram(GLuint const program) {
-  glValidateProgram(program); 
+  NDJINN_GL(ValidateProgram)(program); 
   checkError("glValidateProgram"); 
 }
 
@@ -73,21 +96,25 @@ inline void getProgramInfoLog(GLuint const program,
                               GLsizei const bufSize,
                               GLsizei* length,
                               GLchar* infoLog) {
-  glGetProgramInfoLog(program, bufSize, length, infoLog);
+  NDJINN_GL(GetProgramInfoLog)(program, bufSize, length, infoLog);
   checkError("glGetProgramInfoLog");
 }
 
 //! glUseProgram wrapper. May throw.
 inline void useProgram(GLuint const program) {
-  glUseProgram(program);
+  if (skipState(&StateCache::program, program, DispatchIndex::UseProgram)) {
+    return;
+  }
+  NDJINN_GL(UseProgram)(program);
   checkError("glUseProgram");
+  cacheState(&StateCache::program, program);
 }
 
 //! glGetProgramiv wrapper. May throw.
 inline void getProgramiv(GLuint const program,
                          GLenum const pname,
                          GLint* params) {
-  glGetProgramiv(program, pname, params);
+  NDJINN_GL(GetProgramiv)(program, pname, params);
   checkError("glGetProgramiv");
 }
 
@@ -99,13 +126,13 @@ inline void getActiveAttrib(GLuint const program,
                             GLint* size,
                             GLenum* type,
                             GLchar* name) {
-  glGetActiveAttrib(program, index, bufSize, length, size, type, name); 
+  NDJINN_GL(GetActiveAttrib)(program, index, bufSize, length, size, type, name); 
   checkError("glGetActiveAttrib");
 }
 
 //! glGetAttribLocation wrapper. May throw.
 inline GLint getAttribLocation(GLuint const program, GLchar const* name) {
-  GLint loc = glGetAttribLocation(program, name); 
+  GLint loc = NDJINN_GL(GetAttribLocation)(program, name); 
   checkError("glGetAttribLocation");
   return loc;
 }
@@ -118,13 +145,13 @@ inline void getActiveUniform(GLuint const program,
                              GLint* size,
                              GLenum* type,
                              GLchar* name) {
-  glGetActiveUniform(program, index, bufSize, length, size, type, name); 
+  NDJINN_GL(GetActiveUniform)(program, index, bufSize, length, size, type, name); 
   checkError("glGetActiveUniform"); 
 }
 
 //! glGetUniformLocation wrapper. May throw.
 inline GLint getUniformLocation(GLuint const program, GLchar const* name) {
-  GLint const loc = glGetUniformLocation(program, name);
+  GLint const loc = NDJINN_GL(GetUniformLocation)(program, name);
   checkError("glGetUniformLocation"); 
   return loc; 
 }
@@ -135,7 +162,7 @@ inline void getActiveUniformsiv(GLuint const program,
                                 GLuint const* uIndices,
                                 GLenum const pname,
                                 GLint* params) {
-  glGetActiveUniformsiv(program, ucount, uIndices, pname, params);
+  NDJINN_GL(GetActiveUniformsiv)(program, ucount, uIndices, pname, params);
   checkError("glGetActiveUniformsiv");
 }
 
@@ -144,7 +171,7 @@ inline void getActiveUniformBlockiv(GLuint const program,
                                     GLuint const uniformBlockIndex,
                                     GLenum const pname,
                                     GLint* params) {
-  glGetActiveUniformBlockiv(program, uniformBlockIndex, pname, params);
+  NDJINN_GL(GetActiveUniformBlockiv)(program, uniformBlockIndex, pname, params);
   checkError("glGetActiveUniformBlockiv");
 }
 
@@ -154,7 +181,7 @@ inline void getActiveUniformBlockName(GLuint const program,
                                       GLsizei const bufSize,
                                       GLsizei* length,
                                       GLchar* uniformBlockName) {
-  glGetActiveUniformBlockName(program, 
+  NDJINN_GL(GetActiveUniformBlockName)(program, 
                               uniformBlockIndex, 
                               bufSize, 
                               length, 
@@ -165,7 +192,7 @@ inline void getActiveUniformBlockName(GLuint const program,
 //! glGetUniformBlockIndex wrapper. May throw.
 inline GLuint getUniformBlockIndex(GLuint const program,
                                          GLchar const* name) {
-  GLuint const index = glGetUniformBlockIndex(program, name);
+  GLuint const index = NDJINN_GL(GetUniformBlockIndex)(program, name);
   checkError("glGetActiveUniformBlockIndex");
   return index;
 }
@@ -174,7 +201,7 @@ inline GLuint getUniformBlockIndex(GLuint const program,
 inline void uniformBlockBinding(GLuint const program,
                                 GLuint const uniformBlockIndex,
                                 GLuint const uniformBlockBinding) {
-  glUniformBlockBinding(program, uniformBlockIndex, uniformBlockBinding);
+  NDJINN_GL(UniformBlockBinding)(program, uniformBlockIndex, uniformBlockBinding);
   checkError("glUniformBlockBinding");
 }
 
@@ -187,7 +214,7 @@ template <> inline
 void getUniformv<GLfloat>(GLuint const program,
                           GLint const location,
                           GLfloat* params) {
-  glGetUniformfv(program, location, params);
+  NDJINN_GL(GetUniformfv)(program, location, params);
   checkError("glGetUniformfv");
 }
 
@@ -196,7 +223,7 @@ template <> inline
 void getUniformv<GLint>(GLuint const program,
                         GLint const location,
                         GLint* params) {
-  glGetUniformiv(program, location, params);
+  NDJINN_GL(GetUniformiv)(program, location, params);
   checkError("glGetUniformiv");
 }
 
@@ -205,7 +232,7 @@ template <> inline
 void getUniformv<GLuint>(GLuint const program,
                          GLint const location,
                          GLuint* params) {
-  glGetUniformuiv(program, location, params);
+  NDJINN_GL(GetUniformuiv)(program, location, params);
   checkError("glGetUniformuiv");
 }
 
@@ -214,7 +241,7 @@ template <> inline
 void getUniformv<GLdouble>(GLuint const program,
                            GLint const location,
                            GLdouble* params) {
-  glGetUniformdv(program, location, params);
+  NDJINN_GL(GetUniformdv)(program, location, params);
   checkError("glGetUniformdv");
 }
 
@@ -229,7 +256,7 @@ template<> inline
 void programUniform1<GLint>(GLuint const program,
                             GLint const location,
                             GLint const v0) {
-  glProgramUniform1i(program, location, v0);
+  NDJINN_GL(ProgramUniform1i)(program, location, v0);
   checkError("glProgramUniform1i");
 }
 
@@ -238,7 +265,7 @@ template<> inline
 void programUniform1<GLfloat>(GLuint const program,
                               GLint const location,
                               GLfloat const v0) {
-  glProgramUniform1f(program, location, v0);
+  NDJINN_GL(ProgramUniform1f)(program, location, v0);
   checkError("glProgramUniform1f");
 }
 
@@ -252,7 +279,7 @@ void programUniform2<GLint>(GLuint const program,
                             GLint const location,
                             GLint const v0,
                             GLint const v1) {
-  glProgramUniform2i(program, location, v0, v1);
+  NDJINN_GL(ProgramUniform2i)(program, location, v0, v1);
   checkError("glProgramUniform2i");
 }
 
@@ -262,7 +289,7 @@ void programUniform2<GLfloat>(GLuint const program,
                               GLint const location,
                               GLfloat const v0,
                               GLfloat const v1) {
-  glProgramUniform2f(program, location, v0, v1);
+  NDJINN_GL(ProgramUniform2f)(program, location, v0, v1);
   checkError("glProgramUniform2f");
 }
 
@@ -277,7 +304,7 @@ void programUniform3<GLint>(GLuint const program,
                             GLint const v0,
                             GLint const v1,
                             GLint const v2) {
-  glProgramUniform3i(program, location, v0, v1, v2);
+  NDJINN_GL(ProgramUniform3i)(program, location, v0, v1, v2);
   checkError("glProgramUniform3i");
 }
 
@@ -288,7 +315,7 @@ void programUniform3<GLfloat>(GLuint const program,
                               GLfloat const v0,
                               GLfloat const v1,
                               GLfloat const v2) {
-  glProgramUniform3f(program, location, v0, v1, v2);
+  NDJINN_GL(ProgramUniform3f)(program, location, v0, v1, v2);
   checkError("glProgramUniform3f");
 }
 
@@ -304,7 +331,7 @@ void programUniform4<GLint>(GLuint const program,
                             GLint const v1,
                             GLint const v2,
                             GLint const v3) {
-  glProgramUniform4i(program, location, v0, v1, v2, v3);
+  NDJINN_GL(ProgramUniform4i)(program, location, v0, v1, v2, v3);
   checkError("glProgramUniform4i");
 }
 
@@ -316,7 +343,7 @@ void programUniform4<GLfloat>(GLuint const program,
                               GLfloat const v1,
                               GLfloat const v2,
                               GLfloat const v3) {
-  glProgramUniform4f(program, location, v0, v1, v2, v3);
+  NDJINN_GL(ProgramUniform4f)(program, location, v0, v1, v2, v3);
   checkError("glProgramUniform4f");
 }
 
@@ -333,7 +360,7 @@ void programUniformv<1,GLfloat>(GLuint const program,
                                 GLint const location,
                                 GLsizei const count,
                                 GLfloat const* value) {
-  glProgramUniform1fv(program, location, count, value);
+  NDJINN_GL(ProgramUniform1fv)(program, location, count, value);
   checkError("glProgramUniform1fv");
 }
 
@@ -343,7 +370,7 @@ void programUniformv<2,GLfloat>(GLuint const program,
                                 GLint const location,
                                 GLsizei const count,
                                 GLfloat const* value) {
-  glProgramUniform2fv(program, location, count, value);
+  NDJINN_GL(ProgramUniform2fv)(program, location, count, value);
   checkError("glProgramUniform2fv");
 }
 
@@ -353,7 +380,7 @@ void programUniformv<3,GLfloat>(GLuint const program,
                                 GLint const location,
                                 GLsizei const count,
                                 GLfloat const* value) {
-  glProgramUniform3fv(program, location, count, value);
+  NDJINN_GL(ProgramUniform3fv)(program, location, count, value);
   checkError("glProgramUniform3fv");
 }
 
@@ -363,7 +390,7 @@ void programUniformv<4,GLfloat>(GLuint const program,
                                 GLint const location,
                                 GLsizei const count,
                                 GLfloat const* value) {
-  glProgramUniform4fv(program, location, count, value);
+  NDJINN_GL(ProgramUniform4fv)(program, location, count, value);
   checkError("glProgramUniform4fv");
 }
 
@@ -373,7 +400,7 @@ void programUniformv<1,GLint>(GLuint const program,
                               GLint const location,
                               GLsizei const count,
                               GLint const* value) {
-  glProgramUniform1iv(program, location, count, value);
+  NDJINN_GL(ProgramUniform1iv)(program, location, count, value);
   checkError("glProgramUniform1iv");
 }
 
@@ -383,7 +410,7 @@ void programUniformv<2,GLint>(GLuint const program,
                               GLint const location,
                               GLsizei const count,
                               GLint const* value) {
-  glProgramUniform2iv(program, location, count, value);
+  NDJINN_GL(ProgramUniform2iv)(program, location, count, value);
   checkError("glProgramUniform2iv");
 }
 
@@ -393,7 +420,7 @@ void programUniformv<3,GLint>(GLuint const program,
                               GLint const location,
                               GLsizei const count,
                               GLint const* value) {
-  glProgramUniform3iv(program, location, count, value);
+  NDJINN_GL(ProgramUniform3iv)(program, location, count, value);
   checkError("glProgramUniform3iv");
 }
 
@@ -403,7 +430,7 @@ void programUniformv<4,GLint>(GLuint const program,
                               GLint const location,
                               GLsizei const count,
                               GLint const* value) {
-  glProgramUniform4iv(program, location, count, value);
+  NDJINN_GL(ProgramUniform4iv)(program, location, count, value);
   checkError("glProgramUniform4iv");
 }
 
@@ -422,7 +449,7 @@ void programUniformMatrixfv<2,2>(GLuint const program,
                                  GLsizei const count,
                                  GLboolean const transpose,
                                  GLfloat const* value) {
-  glProgramUniformMatrix2fv(program, location, count, transpose, value);
+  NDJINN_GL(ProgramUniformMatrix2fv)(program, location, count, transpose, value);
   checkError("glProgramUniformMatrix2fv");
 }
 
@@ -433,7 +460,7 @@ void programUniformMatrixfv<3,3>(GLuint const program,
                                  GLsizei const count,
                                  GLboolean const transpose,
                                  GLfloat const* value) {
-  glProgramUniformMatrix3fv(program, location, count, transpose, value);
+  NDJINN_GL(ProgramUniformMatrix3fv)(program, location, count, transpose, value);
   checkError("glProgramUniformMatrix3fv");
 }
 
@@ -444,7 +471,7 @@ void programUniformMatrixfv<4,4>(GLuint const program,
                                  GLsizei const count,
                                  GLboolean const transpose,
                                  GLfloat const* value) {
-  glProgramUniformMatrix4fv(program, location, count, transpose, value);
+  NDJINN_GL(ProgramUniformMatrix4fv)(program, location, count, transpose, value);
   checkError("glProgramUniformMatrix4fv");
 }
 
@@ -455,7 +482,7 @@ void programUniformMatrixfv<2,3>(GLuint const program,
                                  GLsizei const count,
                                  GLboolean const transpose,
                                  GLfloat const* value) {
-  glProgramUniformMatrix2x3fv(program, location, count, transpose, value);
+  NDJINN_GL(ProgramUniformMatrix2x3fv)(program, location, count, transpose, value);
   checkError("glProgramUniformMatrix2x3fv");
 }
 
@@ -466,7 +493,7 @@ void programUniformMatrixfv<3,2>(GLuint const program,
                                  GLsizei const count,
                                  GLboolean const transpose,
                                  GLfloat const* value) {
-  glProgramUniformMatrix3x2fv(program, location, count, transpose, value);
+  NDJINN_GL(ProgramUniformMatrix3x2fv)(program, location, count, transpose, value);
   checkError("glProgramUniformMatrix3x2fv");
 }
 
@@ -477,7 +504,7 @@ void programUniformMatrixfv<2,4>(GLuint const program,
                                  GLsizei const count,
                                  GLboolean const transpose,
                                  GLfloat const* value) {
-  glProgramUniformMatrix2x4fv(program, location, count, transpose, value);
+  NDJINN_GL(ProgramUniformMatrix2x4fv)(program, location, count, transpose, value);
   checkError("glProgramUniformMatrix2x4fv");
 }
 
@@ -488,7 +515,7 @@ void programUniformMatrixfv<4,2>(GLuint const program,
                                  GLsizei const count,
                                  GLboolean const transpose,
                                  GLfloat const* value) {
-  glProgramUniformMatrix4x2fv(program, location, count, transpose, value);
+  NDJINN_GL(ProgramUniformMatrix4x2fv)(program, location, count, transpose, value);
   checkError("glProgramUniformMatrix4x2fv");
 }
 
@@ -499,7 +526,7 @@ void programUniformMatrixfv<3,4>(GLuint const program,
                                  GLsizei const count,
                                  GLboolean const transpose,
                                  GLfloat const* value) {
-  glProgramUniformMatrix3x4fv(program, location, count, transpose, value);
+  NDJINN_GL(ProgramUniformMatrix3x4fv)(program, location, count, transpose, value);
   checkError("glProgramUniformMatrix3x4fv");
 }
 
@@ -510,7 +537,7 @@ void programUniformMatrixfv<4,3>(GLuint const program,
                                  GLsizei const count,
                                  GLboolean const transpose,
                                  GLfloat const* value) {
-  glProgramUniformMatrix4x3fv(program, location, count, transpose, value);
+  NDJINN_GL(ProgramUniformMatrix4x3fv)(program, location, count, transpose, value);
   checkError("glProgramUniformMatrix4x3fv");
 }
 
@@ -644,6 +671,9 @@ public:
     GLuint blockIndex;
     GLint size;
     GLenum type;
+    GLint arrayStride; //!< Zero if not an array.
+    GLint matrixStride; //!< Zero if not a matrix.
+    bool rowMajor;
   };
 
   typedef std::vector<Field> FieldContainer;
@@ -679,6 +709,29 @@ public:
       GL_UNIFORM_OFFSET,
       &fieldOffsets[0]);
 
+    // Get the strides and majorness, used to validate packed blocks.
+    std::vector<GLint> arrayStrides(fieldIndices.size(), 0);
+    detail::getActiveUniformsiv(
+      _program,
+      static_cast<GLsizei>(fieldIndices.size()),
+      reinterpret_cast<GLuint*>(&fieldIndices[0]),
+      GL_UNIFORM_ARRAY_STRIDE,
+      &arrayStrides[0]);
+    std::vector<GLint> matrixStrides(fieldIndices.size(), 0);
+    detail::getActiveUniformsiv(
+      _program,
+      static_cast<GLsizei>(fieldIndices.size()),
+      reinterpret_cast<GLuint*>(&fieldIndices[0]),
+      GL_UNIFORM_MATRIX_STRIDE,
+      &matrixStrides[0]);
+    std::vector<GLint> rowMajors(fieldIndices.size(), 0);
+    detail::getActiveUniformsiv(
+      _program,
+      static_cast<GLsizei>(fieldIndices.size()),
+      reinterpret_cast<GLuint*>(&fieldIndices[0]),
+      GL_UNIFORM_IS_ROW_MAJOR,
+      &rowMajors[0]);
+
     // Get the maximum length of a uniform for the whole program.
     GLint activeUniformMaxLength = -1;
     ndj::detail::getProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH,
@@ -689,6 +742,9 @@ public:
       field.name.resize(activeUniformMaxLength);
       field.blockIndex = fieldIndices[i];
       field.offset = fieldOffsets[i];
+      field.arrayStride = arrayStrides[i];
+      field.matrixStride = matrixStrides[i];
+      field.rowMajor = rowMajors[i] != 0;
       GLsizei length = 0;
       detail::getActiveUniform(
           program,
@@ -797,7 +853,40 @@ public:
 
   //! DTOR.
   ~ShaderProgram() {
-    detail::deleteProgram(_handle);
+    if (_handle != 0) {
+      detail::destroyProgram(_handle);
+    }
+  }
+
+  //! Move CTOR, @a rhs is left empty, i.e. with a zero handle.
+  ShaderProgram(ShaderProgram&& rhs) noexcept
+    : _handle(rhs._handle)
+    , _attribs(std::move(rhs._attribs))
+    , _uniforms(std::move(rhs._uniforms))
+    , _uniformBlocks(std::move(rhs._uniformBlocks))
+  {
+    rhs._handle = 0;
+    rhs._attribs.clear();
+    rhs._uniforms.clear();
+    rhs._uniformBlocks.clear();
+  }
+
+  //! Move assign, the current resource is deleted and @a rhs left empty.
+  ShaderProgram& operator=(ShaderProgram&& rhs) noexcept {
+    if (this != &rhs) {
+      if (_handle != 0) {
+        detail::releaseNoThrow(&detail::destroyProgram, _handle);
+      }
+      _handle = rhs._handle;
+      _attribs = std::move(rhs._attribs);
+      _uniforms = std::move(rhs._uniforms);
+      _uniformBlocks = std::move(rhs._uniformBlocks);
+      rhs._handle = 0;
+      rhs._attribs.clear();
+      rhs._uniforms.clear();
+      rhs._uniformBlocks.clear();
+    }
+    return *this;
   }
 
   GLuint handle() const {
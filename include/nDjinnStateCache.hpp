@@ -0,0 +1,368 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+#ifndef NDJINN_STATE_CACHE_HPP_INCLUDED
+#define NDJINN_STATE_CACHE_HPP_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "nDjinnDispatch.hpp"
+#include "nDjinnGL.hpp"
+#include "nDjinnNamespace.hpp"
+
+NDJINN_BEGIN_NAMESPACE
+
+//! A shadowed piece of OpenGL state, unknown until first set.
+template <typename T>
+class CachedState {
+public:
+  CachedState()
+    : _valid(false)
+    , _value()
+  {}
+
+  //! True if the state is known to have @a value.
+  bool matches(T const& value) const {
+    return _valid && _value == value;
+  }
+
+  bool valid() const {
+    return _valid;
+  }
+
+  T const& value() const {
+    return _value;
+  }
+
+  void set(T const& value) {
+    _valid = true;
+    _value = value;
+  }
+
+  void invalidate() {
+    _valid = false;
+  }
+
+private:
+  bool _valid;
+  T _value;
+};
+
+//! Shadow copy of the fixed-function state and object bindings of one
+//! context. While a cache is current, enable, disable, blendFunc, depthMask,
+//! viewport and the other state setters in nDjinnFunctions.hpp skip calls
+//! that would not change anything and count them. The same goes for
+//! binding buffers, vertex arrays, programs and framebuffers, no matter if
+//! through bind(), release() or a Bindor. The element array buffer bound to
+//! each vertex array is remembered, so it is known again after switching
+//! vertex arrays. Texture bindings are not shadowed. State starts out
+//! unknown, so the first call to each setter always reaches the driver.
+//!
+//! Call invalidate() after OpenGL is used behind nDjinn's back, e.g. by
+//! another library or after swapping dispatch tables. A HeadlessContext
+//! owns a cache and makes it current together with the context.
+class StateCache {
+public:
+  typedef std::array<GLenum, 2> BlendEquation; //!< RGB, alpha.
+  typedef std::array<GLenum, 4> BlendFunc; //!< Src/dst RGB, src/dst alpha.
+  typedef std::array<GLfloat, 4> Color;
+  typedef std::array<GLboolean, 4> Mask;
+  typedef std::array<GLdouble, 2> Range;
+  typedef std::array<GLfloat, 2> PolygonOffset; //!< Factor, units.
+  typedef std::array<GLint, 4> Rect;
+  typedef std::array<GLuint, 3> StencilFunc; //!< Func, ref, mask.
+  typedef std::array<GLenum, 3> StencilOp; //!< Sfail, dpfail, dppass.
+
+  StateCache()
+    : _skipCounts(DispatchIndex::COUNT, 0)
+  {}
+
+  //! The cache of the context that is current on the calling thread, null
+  //! if caching is disabled (default).
+  static StateCache* current() {
+    return currentRef();
+  }
+
+  //! Make @a cache the cache of the calling thread, null disables caching.
+  //! Returns the previous cache.
+  static StateCache* setCurrent(StateCache* cache) {
+    StateCache* const previous = currentRef();
+    currentRef() = cache;
+    return previous;
+  }
+
+  //! Forget all shadowed state, the next call to each setter reaches the
+  //! driver.
+  void invalidate() {
+    bufferBindings.clear();
+    elementArrayBuffers.clear();
+    drawFramebuffer.invalidate();
+    program.invalidate();
+    readFramebuffer.invalidate();
+    vertexArray.invalidate();
+
+    capabilities.clear();
+    blendColor.invalidate();
+    blendEquation.invalidate();
+    blendFunc.invalidate();
+    clearColor.invalidate();
+    clearDepth.invalidate();
+    clearStencil.invalidate();
+    colorMask.invalidate();
+    cullFace.invalidate();
+    depthFunc.invalidate();
+    depthMask.invalidate();
+    depthRange.invalidate();
+    frontFace.invalidate();
+    lineWidth.invalidate();
+    polygonOffset.invalidate();
+    stencilFuncBack.invalidate();
+    stencilFuncFront.invalidate();
+    stencilMaskBack.invalidate();
+    stencilMaskFront.invalidate();
+    stencilOpBack.invalidate();
+    stencilOpFront.invalidate();
+    viewport.invalidate();
+  }
+
+  //! Number of skipped calls to the entry point with the given
+  //! DispatchIndex.
+  std::size_t skipCount(std::size_t const index) const {
+    return index < _skipCounts.size() ? _skipCounts[index] : 0;
+  }
+
+  //! Total number of skipped calls.
+  std::size_t totalSkipCount() const {
+    std::size_t total = 0;
+    for (auto iter = _skipCounts.begin(); iter != _skipCounts.end(); ++iter) {
+      total += *iter;
+    }
+    return total;
+  }
+
+  void resetSkipCounts() {
+    std::fill(_skipCounts.begin(), _skipCounts.end(), 0);
+  }
+
+  void skipped(std::size_t const index) {
+    ++_skipCounts[index];
+  }
+
+  // Shadowed state, maintained by the wrappers.
+
+  std::unordered_map<GLenum, GLuint> bufferBindings; //!< By target.
+  std::unordered_map<GLuint, GLuint> elementArrayBuffers; //!< By vertex array.
+  CachedState<GLuint> drawFramebuffer;
+  CachedState<GLuint> program;
+  CachedState<GLuint> readFramebuffer;
+  CachedState<GLuint> vertexArray;
+
+  std::unordered_map<GLenum, bool> capabilities; //!< Enabled or not.
+  CachedState<Color> blendColor;
+  CachedState<BlendEquation> blendEquation;
+  CachedState<BlendFunc> blendFunc;
+  CachedState<Color> clearColor;
+  CachedState<GLdouble> clearDepth;
+  CachedState<GLint> clearStencil;
+  CachedState<Mask> colorMask;
+  CachedState<GLenum> cullFace;
+  CachedState<GLenum> depthFunc;
+  CachedState<GLboolean> depthMask;
+  CachedState<Range> depthRange;
+  CachedState<GLenum> frontFace;
+  CachedState<GLfloat> lineWidth;
+  CachedState<PolygonOffset> polygonOffset;
+  CachedState<StencilFunc> stencilFuncBack;
+  CachedState<StencilFunc> stencilFuncFront;
+  CachedState<GLuint> stencilMaskBack;
+  CachedState<GLuint> stencilMaskFront;
+  CachedState<StencilOp> stencilOpBack;
+  CachedState<StencilOp> stencilOpFront;
+  CachedState<Rect> viewport;
+
+private:
+  StateCache(StateCache const&); //!< Disabled copy.
+  StateCache& operator=(StateCache const&); //!< Disabled assign.
+
+  static StateCache*& currentRef() {
+    static thread_local StateCache* current = nullptr;
+    return current;
+  }
+
+  std::vector<std::size_t> _skipCounts;
+};
+
+namespace detail {
+
+//! True if the current cache, if any, says that setting @a state to
+//! @a value is redundant. Skipped calls are counted against the entry
+//! point @a index.
+template <typename T> inline
+bool skipState(CachedState<T> StateCache::*state, T const& value,
+               std::size_t const index)
+{
+  StateCache* const cache = StateCache::current();
+  if (cache != nullptr && (cache->*state).matches(value)) {
+    cache->skipped(index);
+    return true;
+  }
+  return false;
+}
+
+//! Record a successfully set state in the current cache, if any.
+template <typename T> inline
+void cacheState(CachedState<T> StateCache::*state, T const& value)
+{
+  StateCache* const cache = StateCache::current();
+  if (cache != nullptr) {
+    (cache->*state).set(value);
+  }
+}
+
+//! Forget a state in the current cache, if any, e.g. after setting it for
+//! a single draw buffer.
+template <typename T> inline
+void invalidateState(CachedState<T> StateCache::*state)
+{
+  StateCache* const cache = StateCache::current();
+  if (cache != nullptr) {
+    (cache->*state).invalidate();
+  }
+}
+
+//! As skipState, for state that is set per key, e.g. per target.
+template <typename K, typename T> inline
+bool skipState(std::unordered_map<K, T> StateCache::*states, K const& key,
+               T const& value, std::size_t const index)
+{
+  StateCache* const cache = StateCache::current();
+  if (cache != nullptr) {
+    auto const iter = (cache->*states).find(key);
+    if (iter != (cache->*states).end() && iter->second == value) {
+      cache->skipped(index);
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename K, typename T> inline
+void cacheState(std::unordered_map<K, T> StateCache::*states, K const& key,
+                T const& value)
+{
+  StateCache* const cache = StateCache::current();
+  if (cache != nullptr) {
+    (cache->*states)[key] = value;
+  }
+}
+
+template <typename K, typename T> inline
+void invalidateState(std::unordered_map<K, T> StateCache::*states,
+                     K const& key)
+{
+  StateCache* const cache = StateCache::current();
+  if (cache != nullptr) {
+    (cache->*states).erase(key);
+  }
+}
+
+//! True if @a cap is known to be @a enabled, see skipState.
+inline bool skipCapability(GLenum const cap, bool const enabled,
+                           std::size_t const index)
+{
+  return skipState(&StateCache::capabilities, cap, enabled, index);
+}
+
+inline void cacheCapability(GLenum const cap, bool const enabled)
+{
+  cacheState(&StateCache::capabilities, cap, enabled);
+}
+
+//! Deleting a bound object reverts the binding to zero.
+inline void uncacheDeleted(CachedState<GLuint> StateCache::*binding,
+                           GLsizei const n, GLuint const* names)
+{
+  StateCache* const cache = StateCache::current();
+  if (cache != nullptr && (cache->*binding).valid() &&
+      std::find(names, names + n, (cache->*binding).value()) != names + n) {
+    (cache->*binding).set(0);
+  }
+}
+
+inline void uncacheDeleted(std::unordered_map<GLenum, GLuint> StateCache::*bindings,
+                           GLsizei const n, GLuint const* names)
+{
+  StateCache* const cache = StateCache::current();
+  if (cache != nullptr) {
+    for (auto iter = (cache->*bindings).begin();
+         iter != (cache->*bindings).end(); ++iter) {
+      if (std::find(names, names + n, iter->second) != names + n) {
+        iter->second = 0;
+      }
+    }
+  }
+}
+
+//! Record @a buffer as the element array buffer of the bound vertex array,
+//! if known.
+inline void cacheElementArrayBuffer(GLuint const buffer)
+{
+  StateCache* const cache = StateCache::current();
+  if (cache != nullptr && cache->vertexArray.valid()) {
+    cache->elementArrayBuffers[cache->vertexArray.value()] = buffer;
+  }
+}
+
+//! The element array buffer binding is vertex array state. After binding
+//! @a vertexArray it is whatever was last recorded for that vertex array,
+//! or unknown.
+inline void restoreElementArrayBuffer(GLuint const vertexArray)
+{
+  StateCache* const cache = StateCache::current();
+  if (cache != nullptr) {
+    auto const iter = cache->elementArrayBuffers.find(vertexArray);
+    if (iter != cache->elementArrayBuffers.end()) {
+      cache->bufferBindings[GL_ELEMENT_ARRAY_BUFFER] = iter->second;
+    }
+    else {
+      cache->bufferBindings.erase(GL_ELEMENT_ARRAY_BUFFER);
+    }
+  }
+}
+
+//! Deleting a buffer detaches it from the bound vertex array only, other
+//! vertex arrays holding it are forgotten.
+inline void uncacheDeletedElementArrayBuffers(GLsizei const n,
+                                              GLuint const* names)
+{
+  StateCache* const cache = StateCache::current();
+  if (cache != nullptr) {
+    auto iter = cache->elementArrayBuffers.begin();
+    while (iter != cache->elementArrayBuffers.end()) {
+      if (std::find(names, names + n, iter->second) == names + n) {
+        ++iter;
+      }
+      else if (cache->vertexArray.matches(iter->first)) {
+        iter->second = 0;
+        ++iter;
+      }
+      else {
+        iter = cache->elementArrayBuffers.erase(iter);
+      }
+    }
+  }
+}
+
+} // Namespace: detail.
+
+NDJINN_END_NAMESPACE
+
+#endif // NDJINN_STATE_CACHE_HPP_INCLUDED
@@ -0,0 +1,159 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+#ifndef NDJINN_STATS_HPP_INCLUDED
+#define NDJINN_STATS_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "nDjinnDispatch.hpp"
+#include "nDjinnNamespace.hpp"
+
+NDJINN_BEGIN_NAMESPACE
+
+//! Statistics for one OpenGL entry point, i.e. one detail:: wrapper.
+struct CallStats {
+  std::string name; //!< OpenGL name, e.g. "glBindBuffer".
+  std::string family; //!< See NDJINN_GL_FUNCTIONS.
+  std::uint64_t calls;
+  std::uint64_t nanoseconds; //!< CPU time spent in the OpenGL calls.
+
+  //! Bucket i counts calls that took [2^i, 2^(i+1)) nanoseconds. Trailing
+  //! empty buckets are omitted.
+  std::vector<std::uint64_t> histogram;
+};
+
+//! Snapshot of the call statistics collected on the calling thread when
+//! compiled with NDJINN_STATS defined to 1, e.g. once per frame:
+//!
+//!   ndj::Stats const stats = ndj::Stats::snapshot();
+//!   ndj::Stats::reset();
+//!   log << stats.json();
+//!
+//! Time spent checking for errors is reported as glGetError. Without
+//! NDJINN_STATS snapshots are empty and wrappers are not instrumented.
+class Stats {
+public:
+  //! True if instrumentation is compiled in.
+  static bool enabled() {
+    return NDJINN_STATS != 0;
+  }
+
+  //! Statistics collected since the last reset.
+  static Stats snapshot() {
+    Stats stats;
+    std::vector<detail::StatsCounter> const& counters =
+      detail::statsCounters();
+    for (std::size_t i = 0; i < counters.size(); ++i) {
+      detail::StatsCounter const& counter = counters[i];
+      if (counter.calls == 0) {
+        continue;
+      }
+
+      CallStats call;
+      call.name = dispatchName(i);
+      call.family = dispatchFamily(i);
+      call.calls = counter.calls;
+      call.nanoseconds = counter.nanoseconds;
+      std::size_t size = counter.histogram.size();
+      while (size > 0 && counter.histogram[size - 1] == 0) {
+        --size;
+      }
+      call.histogram.assign(counter.histogram.begin(),
+                            counter.histogram.begin() + size);
+      stats._calls.push_back(call);
+      stats._totalCalls += call.calls;
+      stats._totalNanoseconds += call.nanoseconds;
+    }
+    std::stable_sort(stats._calls.begin(), stats._calls.end(),
+      [](CallStats const& lhs, CallStats const& rhs) {
+        return lhs.nanoseconds > rhs.nanoseconds;
+      });
+    return stats;
+  }
+
+  //! Clear the statistics collected on the calling thread.
+  static void reset() {
+    std::vector<detail::StatsCounter>& counters = detail::statsCounters();
+    std::fill(counters.begin(), counters.end(), detail::StatsCounter());
+  }
+
+  Stats()
+    : _totalCalls(0)
+    , _totalNanoseconds(0)
+  {}
+
+  //! Entry points that were called, most expensive first.
+  std::vector<CallStats> const& calls() const {
+    return _calls;
+  }
+
+  std::uint64_t totalCalls() const {
+    return _totalCalls;
+  }
+
+  std::uint64_t totalNanoseconds() const {
+    return _totalNanoseconds;
+  }
+
+  //! Statistics as a JSON object.
+  std::string json() const {
+    std::stringstream ss;
+    ss << "{\"enabled\": " << (enabled() ? "true" : "false")
+       << ", \"calls\": " << _totalCalls
+       << ", \"nanoseconds\": " << _totalNanoseconds
+       << ", \"functions\": [";
+    for (std::size_t i = 0; i < _calls.size(); ++i) {
+      CallStats const& call = _calls[i];
+      ss << (i > 0 ? ", " : "")
+         << "{\"name\": \"" << call.name << "\""
+         << ", \"family\": \"" << call.family << "\""
+         << ", \"calls\": " << call.calls
+         << ", \"nanoseconds\": " << call.nanoseconds
+         << ", \"histogram\": [";
+      for (std::size_t j = 0; j < call.histogram.size(); ++j) {
+        ss << (j > 0 ? ", " : "") << call.histogram[j];
+      }
+      ss << "]}";
+    }
+    ss << "]}";
+    return ss.str();
+  }
+
+private:
+  std::vector<CallStats> _calls;
+  std::uint64_t _totalCalls;
+  std::uint64_t _totalNanoseconds;
+};
+
+NDJINN_END_NAMESPACE
+
+namespace std {
+
+inline
+ostream& operator<<(ostream& os, ndj::Stats const& stats)
+{
+  os << "Stats" << endl
+     << "  Calls: " << stats.totalCalls() << endl
+     << "  Nanoseconds: " << stats.totalNanoseconds() << endl;
+  for (auto iter = stats.calls().begin(); iter != stats.calls().end();
+       ++iter) {
+    os << "    " << iter->name << ": " << iter->calls << " calls, "
+       << iter->nanoseconds << " ns" << endl;
+  }
+  return os;
+}
+
+} // Namespace: std.
+
+#endif // NDJINN_STATS_HPP_INCLUDED
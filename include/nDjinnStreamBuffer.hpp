@@ -0,0 +1,171 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+#ifndef NDJINN_STREAM_BUFFER_HPP_INCLUDED
+#define NDJINN_STREAM_BUFFER_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#include "nDjinnBuffer.hpp"
+#include "nDjinnException.hpp"
+#include "nDjinnGL.hpp"
+#include "nDjinnNamespace.hpp"
+#include "nDjinnSync.hpp"
+
+NDJINN_BEGIN_NAMESPACE
+
+//! Ring buffer for data that changes every frame, e.g. dynamic geometry and
+//! uniforms. The buffer is split into REGION_COUNT regions and mapped once,
+//! persistently and coherently, so uploading is a memcpy into the current
+//! region. advance() fences the current region and moves on to the next,
+//! waiting only if OpenGL is still using it, i.e. if the CPU is more than
+//! REGION_COUNT - 1 frames ahead.
+//!
+//! Offsets returned by allocate() are from the start of the buffer and can
+//! be used directly with bindRange() or as vertex and index offsets.
+template <GLenum TargetT>
+class StreamBuffer {
+public:
+  static GLenum const TARGET = TargetT;
+  static std::size_t const REGION_COUNT = 3;
+
+  //! Memory for a single upload.
+  struct Allocation {
+    void* ptr; //!< Mapped memory, write only.
+    GLintptr offset; //!< From the start of the buffer.
+  };
+
+  //! CTOR. Allocate immutable storage for REGION_COUNT regions of
+  //! @a regionSize bytes and map it. For uniform buffers @a regionSize
+  //! should be a multiple of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT. May throw.
+  explicit StreamBuffer(GLsizeiptr const regionSize)
+    : _buffer(static_cast<GLsizeiptr>(REGION_COUNT) * regionSize, nullptr,
+              ImmutableStorage(FLAGS))
+    , _regionSize(regionSize)
+    , _data(static_cast<unsigned char*>(detail::mapNamedBufferRange(
+        _buffer.handle(), 0, _buffer.sizeInBytes(), FLAGS)))
+    , _region(0)
+    , _head(0)
+    , _stallCount(0)
+  {
+    _fences.fill(nullptr);
+    if (_data == nullptr) {
+      NDJINN_THROW("could not map stream buffer: " << _buffer.handle());
+    }
+  }
+
+  //! DTOR
+  ~StreamBuffer() {
+    for (std::size_t i = 0; i < REGION_COUNT; ++i) {
+      if (_fences[i] != nullptr) {
+        detail::deleteSync(_fences[i]);
+      }
+    }
+    _buffer.unmap();
+  }
+
+  //! Expose resource handle.
+  GLuint handle() const {
+    return _buffer.handle();
+  }
+
+  GLsizeiptr regionSize() const {
+    return _regionSize;
+  }
+
+  //! Index of the region being written.
+  std::size_t region() const {
+    return _region;
+  }
+
+  //! Bytes left in the current region, ignoring alignment.
+  GLsizeiptr available() const {
+    return _regionSize - _head;
+  }
+
+  //! Number of times advance() had to wait for OpenGL.
+  std::size_t stallCount() const {
+    return _stallCount;
+  }
+
+  //! Reserve @a size bytes in the current region, with the offset a
+  //! multiple of @a alignment. Throws if the region is full, in which case
+  //! the region size is too small for a frame.
+  Allocation allocate(GLsizeiptr const size, GLsizeiptr const alignment = 1) {
+    GLintptr const begin = static_cast<GLintptr>(_region) * _regionSize;
+    GLintptr offset = begin + _head;
+    offset = (offset + alignment - 1) / alignment * alignment;
+    if (offset + size > begin + _regionSize) {
+      NDJINN_THROW("stream buffer region full: " << size << " bytes requested, "
+                   << available() << " available");
+    }
+    _head = offset + size - begin;
+    Allocation const allocation = { _data + offset, offset };
+    return allocation;
+  }
+
+  //! Copy @a size bytes to the current region. Returns the offset of the
+  //! copy from the start of the buffer. May throw.
+  GLintptr upload(void const* data, GLsizeiptr const size,
+                  GLsizeiptr const alignment = 1) {
+    Allocation const allocation = allocate(size, alignment);
+    std::memcpy(allocation.ptr, data, static_cast<std::size_t>(size));
+    return allocation.offset;
+  }
+
+  //! Call once all commands reading the current region have been issued,
+  //! typically at the end of a frame. May throw.
+  void advance() {
+    _fences[_region] = detail::fenceSync();
+    _region = (_region + 1) % REGION_COUNT;
+    _head = 0;
+    GLsync const fence = _fences[_region];
+    if (fence != nullptr) {
+      if (!detail::waitSync(fence, 0)) {
+        ++_stallCount;
+        while (!detail::waitSync(fence, 1000000000)) {
+        }
+      }
+      detail::deleteSync(fence);
+      _fences[_region] = nullptr;
+    }
+  }
+
+  //! Bind buffer.
+  void bind() const {
+    _buffer.bind();
+  }
+
+  //! Bind @a size bytes at @a offset, e.g. an allocation, to an indexed
+  //! binding point.
+  void bindRange(GLuint const index,
+                 GLintptr const offset,
+                 GLsizeiptr const size) const {
+    _buffer.bindRange(index, offset, size);
+  }
+
+private:
+  StreamBuffer(StreamBuffer<TargetT> const&); //!< Disabled copy.
+  StreamBuffer& operator=(StreamBuffer<TargetT> const&); //!< Disabled assign.
+
+  static GLbitfield const FLAGS =
+    GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+  Buffer<TargetT> _buffer;
+  GLsizeiptr const _regionSize;
+  unsigned char* const _data; //!< Persistently mapped storage.
+  std::array<GLsync, REGION_COUNT> _fences; //!< Null if not in use.
+  std::size_t _region;
+  GLsizeiptr _head; //!< Bytes used in the current region.
+  std::size_t _stallCount;
+};
+
+NDJINN_END_NAMESPACE
+
+#endif // NDJINN_STREAM_BUFFER_HPP_INCLUDED
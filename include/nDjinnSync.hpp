@@ -0,0 +1,100 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+#ifndef NDJINN_SYNC_HPP_INCLUDED
+#define NDJINN_SYNC_HPP_INCLUDED
+
+#include "nDjinnDispatch.hpp"
+#include "nDjinnError.hpp"
+#include "nDjinnException.hpp"
+#include "nDjinnGL.hpp"
+#include "nDjinnNamespace.hpp"
+
+NDJINN_BEGIN_NAMESPACE
+
+namespace detail {
+
+//! glFenceSync wrapper. May throw.
+inline GLsync fenceSync(GLenum const condition = GL_SYNC_GPU_COMMANDS_COMPLETE,
+                        GLbitfield const flags = 0) {
+  GLsync const sync = NDJINN_GL(FenceSync)(condition, flags);
+  checkError("glFenceSync");
+  return sync;
+}
+
+//! glClientWaitSync wrapper. May throw.
+inline GLenum clientWaitSync(GLsync const sync,
+                             GLbitfield const flags,
+                             GLuint64 const timeout) {
+  GLenum const result = NDJINN_GL(ClientWaitSync)(sync, flags, timeout);
+  checkError("glClientWaitSync");
+  return result;
+}
+
+//! glDeleteSync wrapper. May throw.
+inline void deleteSync(GLsync const sync) {
+  NDJINN_GL(DeleteSync)(sync);
+  checkError("glDeleteSync");
+}
+
+//! Wait at most @a timeout nanoseconds for @a sync to be signaled, pending
+//! commands are flushed so that the wait can finish. Returns true if
+//! signaled. May throw.
+inline bool waitSync(GLsync const sync, GLuint64 const timeout) {
+  switch (clientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, timeout)) {
+  case GL_ALREADY_SIGNALED:
+  case GL_CONDITION_SATISFIED:
+    return true;
+  case GL_TIMEOUT_EXPIRED:
+    return false;
+  }
+  NDJINN_THROW("glClientWaitSync failed");
+}
+
+} // Namespace: detail.
+
+//! Signaled once OpenGL has completed all commands issued before the fence
+//! was created.
+class Fence {
+public:
+  Fence()
+    : _sync(detail::fenceSync())
+  {}
+
+  ~Fence() {
+    detail::deleteSync(_sync);
+  }
+
+  GLsync handle() const {
+    return _sync;
+  }
+
+  //! True if signaled, never blocks. May throw.
+  bool signaled() const {
+    GLenum const result = detail::clientWaitSync(_sync, 0, 0);
+    if (result == GL_WAIT_FAILED) {
+      NDJINN_THROW("glClientWaitSync failed");
+    }
+    return result != GL_TIMEOUT_EXPIRED;
+  }
+
+  //! Block for at most @a timeout nanoseconds. Returns true if
+  //! signaled. May throw.
+  bool wait(GLuint64 const timeout) const {
+    return detail::waitSync(_sync, timeout);
+  }
+
+private:
+  Fence(Fence const&); //!< Disabled copy.
+  Fence& operator=(Fence const&); //!< Disabled assign.
+
+  GLsync const _sync;
+};
+
+NDJINN_END_NAMESPACE
+
+#endif // NDJINN_SYNC_HPP_INCLUDED
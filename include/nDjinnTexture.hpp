@@ -10,8 +10,11 @@
 
 #include <array>
 
+#include "nDjinnDeletionQueue.hpp"
+#include "nDjinnDispatch.hpp"
 #include "nDjinnError.hpp"
 #include "nDjinnException.hpp"
+#include "nDjinnHandlePool.hpp"
 #include "nDjinnNamespace.hpp"
 
 NDJINN_BEGIN_NAMESPACE
@@ -21,28 +24,28 @@ namespace detail {
 //! glActiveTexture wrapper. May throw.
 inline void activeTexture(GLenum const texture)
 {
-  glActiveTexture(texture);
+  NDJINN_GL(ActiveTexture)(texture);
   checkError("glActiveTexture");
 }
 
 //! glGenTextures wrapper. May throw.
 inline void genTextures(GLsizei const n, GLuint *textures)
 {
-  glGenTextures(n, textures);
+  NDJINN_GL(GenTextures)(n, textures);
   checkError("glGenTextures");
 }
 
 //! glDeleteTextures wrapper. May throw.
 inline void deleteTextures(GLsizei const n, GLuint const* textures)
 {
-  glDeleteTextures(n, textures);
+  NDJINN_GL(DeleteTextures)(n, textures);
   checkError("glDeleteTextures");
 }
 
 //! glIsTexture wrapper. May throw.
 inline GLboolean isTexture(GLuint const texture)
 {
-  GLboolean const result = glIsTexture(texture);
+  GLboolean const result = NDJINN_GL(IsTexture)(texture);
   checkError("glIsTexture");
   return result;      
 }
@@ -50,17 +53,44 @@ inline GLboolean isTexture(GLuint const texture)
 //! glBindTexture wrapper. May throw. 
 inline void
 bindTexture(GLenum const target, GLuint const texture) {
-  glBindTexture(target, texture);
+  NDJINN_GL(BindTexture)(target, texture);
   checkError("glBindTexture");
 }
 
+//! glBindMultiTextureEXT wrapper, binds to @a texunit without changing the
+//! active texture unit. May throw.
+inline void
+bindMultiTexture(GLenum const texunit, GLenum const target,
+                 GLuint const texture) {
+  NDJINN_GL(BindMultiTextureEXT)(texunit, target, texture);
+  checkError("glBindMultiTextureEXT");
+}
+
+//! glBindTextures wrapper. Binds to the target of each texture, null
+//! @a textures unbinds all targets of the units. May throw.
+inline void
+bindTextures(GLuint const first, GLsizei const count,
+             GLuint const* textures) {
+  NDJINN_GL(BindTextures)(first, count, textures);
+  checkError("glBindTextures");
+}
+
+//! glBindImageTextures wrapper. Binds level 0 of each texture, all layers,
+//! with the texture's internal format and read/write access. May throw.
+inline void
+bindImageTextures(GLuint const first, GLsizei const count,
+                  GLuint const* textures) {
+  NDJINN_GL(BindImageTextures)(first, count, textures);
+  checkError("glBindImageTextures");
+}
+
 // Texture Parameters.
 
 //! glTextureParameteri wrapper. May throw.
 inline void textureParameteri(GLuint const texture, GLenum const target,
                               GLenum const pname, GLint const param)
 {
-  glTextureParameteriEXT(texture, target, pname, param);
+  NDJINN_GL(TextureParameteriEXT)(texture, target, pname, param);
   checkError("glTextureParameteriEXT");
 }
 
@@ -68,7 +98,7 @@ inline void textureParameteri(GLuint const texture, GLenum const target,
 inline void textureParameterf(GLuint const texture, GLenum const target,
                               GLenum const pname, GLfloat const param)
 {
-  glTextureParameterfEXT(texture, target, pname, param);
+  NDJINN_GL(TextureParameterfEXT)(texture, target, pname, param);
   checkError("glTextureParameterfEXT");
 }
 
@@ -76,7 +106,7 @@ inline void textureParameterf(GLuint const texture, GLenum const target,
 inline void textureParameteriv(GLuint const texture, GLenum const target,
                                GLenum const pname, GLint const* params)
 {
-  glTextureParameterivEXT(texture, target, pname, params);
+  NDJINN_GL(TextureParameterivEXT)(texture, target, pname, params);
   checkError("glTextureParameterivEXT");
 }
 
@@ -84,7 +114,7 @@ inline void textureParameteriv(GLuint const texture, GLenum const target,
 inline void textureParameterfv(GLuint const texture, GLenum const target,
                                GLenum const pname, GLfloat const* params)
 {
-  glTextureParameterfvEXT(texture, target, pname, params);
+  NDJINN_GL(TextureParameterfvEXT)(texture, target, pname, params);
   checkError("glTextureParameterfvEXT");
 }
 
@@ -92,7 +122,7 @@ inline void textureParameterfv(GLuint const texture, GLenum const target,
 inline void textureParameterIiv(GLuint const texture, GLenum const target,
                                 GLenum const pname, GLint const* params)
 {
-  glTextureParameterIivEXT(texture, target, pname, params);
+  NDJINN_GL(TextureParameterIivEXT)(texture, target, pname, params);
   checkError("glTextureParameterIivEXT");
 }
 
@@ -100,7 +130,7 @@ inline void textureParameterIiv(GLuint const texture, GLenum const target,
 inline void textureParameterIuiv(GLuint const texture, GLenum const target,
                                  GLenum const pname, GLuint const* params)
 {
-  glTextureParameterIuivEXT(texture, target, pname, params);
+  NDJINN_GL(TextureParameterIuivEXT)(texture, target, pname, params);
   checkError("glTextureParameterIuivEXT");
 }
 
@@ -172,7 +202,7 @@ void textureParameterIv<GLuint>(GLuint const texture, GLenum const target,
 inline void getTextureParameteriv(GLuint const texture, GLenum const target,
                                   GLenum const pname, GLint* params)
 {
-  glGetTextureParameterivEXT(texture, target, pname, params);
+  NDJINN_GL(GetTextureParameterivEXT)(texture, target, pname, params);
   checkError("glGetTextureParameterivEXT");
 }
 
@@ -180,7 +210,7 @@ inline void getTextureParameteriv(GLuint const texture, GLenum const target,
 inline void getTextureParameterfv(GLuint const texture, GLenum const target,
                                   GLenum const pname, GLfloat* params)
 {
-  glGetTextureParameterfvEXT(texture, target, pname, params);
+  NDJINN_GL(GetTextureParameterfvEXT)(texture, target, pname, params);
   checkError("glGetTextureParameterfvEXT");
 }
 
@@ -188,7 +218,7 @@ inline void getTextureParameterfv(GLuint const texture, GLenum const target,
 inline void getTextureParameterIiv(GLuint const texture, GLenum const target,
                                    GLenum const pname, GLint* params)
 {
-  glGetTextureParameterIivEXT(texture, target, pname, params);
+  NDJINN_GL(GetTextureParameterIivEXT)(texture, target, pname, params);
   checkError("glGetTextureParameterIivEXT"); // May throw.
 }
 
@@ -196,7 +226,7 @@ inline void getTextureParameterIiv(GLuint const texture, GLenum const target,
 inline void getTextureParameterIuiv(GLuint const texture, GLenum const target,
                                     GLenum const pname, GLuint* params)
 {
-  glGetTextureParameterIuivEXT(texture, target, pname, params);
+  NDJINN_GL(GetTextureParameterIuivEXT)(texture, target, pname, params);
   checkError("glGetTexParameterIuivEXT");
 }
 
@@ -206,7 +236,7 @@ inline void getTextureLevelParameteriv(GLuint const texture,
                                        GLint const level, GLenum const pname,
                                        GLint* params)
 {
-  glGetTextureLevelParameterivEXT(texture, target, level, pname, params);
+  NDJINN_GL(GetTextureLevelParameterivEXT)(texture, target, level, pname, params);
   checkError("glGetTextureLevelParameterivEXT");
 }
 
@@ -215,7 +245,7 @@ inline void getTextureLevelParameterfv(GLuint const texture,
                                        GLenum const target, GLint const level,
                                        GLenum const pname, GLfloat* params)
 {
-  glGetTextureLevelParameterfvEXT(texture, target, level, pname, params);
+  NDJINN_GL(GetTextureLevelParameterfvEXT)(texture, target, level, pname, params);
   checkError("glGetTextureLevelParameterfvEXT");
 }
 
@@ -293,7 +323,7 @@ inline void getTextureImage(GLuint const texture, GLenum const target,
                             GLint const level, GLenum const format,
                             GLenum const type, GLvoid* pixels)
 {
-  glGetTextureImageEXT(texture, target, level, format, type, pixels);
+  NDJINN_GL(GetTextureImageEXT)(texture, target, level, format, type, pixels);
   checkError("glGetTextureImageEXT");
 }
 
@@ -301,13 +331,17 @@ inline void getTextureImage(GLuint const texture, GLenum const target,
 inline void getCompressedTextureImage(GLuint const texture, GLenum const target,
                                       GLint const level, GLvoid* pixels)
 {
-  glGetCompressedTextureImageEXT(texture, target, level, pixels);
+  NDJINN_GL(GetCompressedTextureImageEXT)(texture, target, level, pixels);
   checkError("glGetCompressedTextureImageEXT");
 }
 
 //! Convenience.
 inline GLuint genTexture()
 {
+  HandlePools* const pools = HandlePools::current();
+  if (pools != nullptr) {
+    return pools->textures.acquire(&genTextures, &deleteTextures);
+  }
   GLuint handle = 0;
   genTextures(1, &handle);
   return handle;
@@ -316,6 +350,16 @@ inline GLuint genTexture()
 //! Convenience.
 inline void deleteTexture(GLuint const& handle)
 {
+  HandlePools* const pools = HandlePools::current();
+  if (pools != nullptr) {
+    pools->textures.release(handle, &deleteTextures);
+    return;
+  }
+  DeletionQueue* const queue = DeletionQueue::current();
+  if (queue != nullptr) {
+    queue->push(&deleteTextures, handle);
+    return;
+  }
   deleteTextures(1, &handle);
 }
 
@@ -340,6 +384,37 @@ inline void releaseTexture(GLenum const target)
   detail::bindTexture(target, 0);
 }
 
+//! Bind @a textures to consecutive texture units starting at @a first, each
+//! to its own target, with a single call. Zero handles unbind. Does not
+//! change the active texture unit. May throw.
+template <std::size_t N> inline
+void bindTextures(GLuint const first, std::array<GLuint, N> const& textures)
+{
+  detail::bindTextures(first, static_cast<GLsizei>(N), textures.data());
+}
+
+//! Release all targets of @a count texture units starting at @a first.
+//! May throw.
+inline void releaseTextures(GLuint const first, GLsizei const count)
+{
+  detail::bindTextures(first, count, nullptr);
+}
+
+//! Bind @a textures to consecutive image units starting at @a first with a
+//! single call, see detail::bindImageTextures. May throw.
+template <std::size_t N> inline
+void bindImageTextures(GLuint const first,
+                       std::array<GLuint, N> const& textures)
+{
+  detail::bindImageTextures(first, static_cast<GLsizei>(N), textures.data());
+}
+
+//! Release @a count image units starting at @a first. May throw.
+inline void releaseImageTextures(GLuint const first, GLsizei const count)
+{
+  detail::bindImageTextures(first, count, nullptr);
+}
+
 // Set texture parameter(s).
 
 template <typename T, typename P> inline
@@ -12,6 +12,7 @@
 #include <iostream>
 #include <string>
 
+#include "nDjinnDispatch.hpp"
 #include "nDjinnError.hpp"
 #include "nDjinnException.hpp"
 #include "nDjinnGL.hpp"
@@ -29,7 +30,7 @@ inline void textureImage2D(GLuint const texture, GLenum const target,
                            GLint const border, GLenum const format,
                            GLenum const type, GLvoid const* data)
 {
-  glTextureImage2DEXT(texture, target, level, internal_format, width, height,
+  NDJINN_GL(TextureImage2DEXT)(texture, target, level, internal_format, width, height,
                       border, format, type, data);
   checkError("glTextureImage2DEXT");
 }
@@ -41,7 +42,7 @@ inline void textureSubImage2D(GLuint const texture, GLenum const target,
                               GLenum const format, GLenum const type,
                               GLvoid const* data)
 {
-  glTextureSubImage2DEXT(texture, target, level, x, y, width, height, format,
+  NDJINN_GL(TextureSubImage2DEXT)(texture, target, level, x, y, width, height, format,
                          type, data);
   checkError("glTextureSubImage2DEXT"); // May throw;
 }
@@ -53,7 +54,7 @@ inline void copyTextureImage2D(GLuint const texture, GLenum const target,
                                GLsizei const width, GLsizei const height,
                                GLint const border)
 {
-  glCopyTextureImage2DEXT(texture, target, level, internal_format, x, y, width,
+  NDJINN_GL(CopyTextureImage2DEXT)(texture, target, level, internal_format, x, y, width,
                           height, border);
   checkError("glCopyTextureImage2DEXT");
 }
@@ -65,7 +66,7 @@ inline void copyTextureSubImage2D(GLuint const texture, GLenum const target,
                                   GLint const y, GLsizei const width,
                                   GLsizei const height)
 {
-  glCopyTextureSubImage2DEXT(texture, target, level, x_offset, y_offset, x, y,
+  NDJINN_GL(CopyTextureSubImage2DEXT)(texture, target, level, x_offset, y_offset, x, y,
                              width, height);
   checkError("glCopyTextureSubImage2DEXT");
 }
@@ -78,7 +79,7 @@ inline void compressedTextureImage2D(GLuint const texture, const GLenum target,
                                      GLint const border, GLsizei const size,
                                      GLvoid const* data)
 {
-  glCompressedTextureImage2DEXT(texture, target, level, internal_format, width,
+  NDJINN_GL(CompressedTextureImage2DEXT)(texture, target, level, internal_format, width,
                                 height, border, size, data);
   checkError("glCompressedTextureImage2DEXT");
 }
@@ -93,7 +94,7 @@ inline void compressedTextureSubImage2D(GLuint const texture,
                                         GLenum const format,
                                         GLsizei const size, GLvoid const* data)
 {
-  glCompressedTextureSubImage2DEXT(texture, target, level, x, y,
+  NDJINN_GL(CompressedTextureSubImage2DEXT)(texture, target, level, x, y,
                                    width, height, format, size, data);
   checkError("glCompressedTextureSubImage2DEXT");
 }
@@ -182,7 +183,29 @@ public:
 
   ~Texture2D()
   {
-    detail::deleteTexture(_handle);
+    if (_handle != 0) {
+      detail::deleteTexture(_handle);
+    }
+  }
+
+  //! Move CTOR, @a rhs is left empty, i.e. with a zero handle.
+  Texture2D(Texture2D&& rhs) noexcept
+    : _handle(rhs._handle)
+  {
+    rhs._handle = 0;
+  }
+
+  //! Move assign, the current resource is deleted and @a rhs left empty.
+  Texture2D& operator=(Texture2D&& rhs) noexcept
+  {
+    if (this != &rhs) {
+      if (_handle != 0) {
+        detail::releaseNoThrow(&detail::deleteTexture, _handle);
+      }
+      _handle = rhs._handle;
+      rhs._handle = 0;
+    }
+    return *this;
   }
 
   GLuint handle() const
@@ -267,7 +290,7 @@ private:
   Texture2D(Texture2D const&); //!< Disabled copy.
   Texture2D& operator=(Texture2D const&); //!< Disabled assign.
 
-  GLuint const _handle;
+  GLuint _handle;
 };
 
 NDJINN_END_NAMESPACE
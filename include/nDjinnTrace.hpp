@@ -0,0 +1,1159 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+#ifndef NDJINN_TRACE_HPP_INCLUDED
+#define NDJINN_TRACE_HPP_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "nDjinnDispatch.hpp"
+#include "nDjinnException.hpp"
+#include "nDjinnGL.hpp"
+#include "nDjinnNamespace.hpp"
+#include "nDjinnStateCache.hpp"
+
+// Binary trace layout, all values in native byte order:
+//
+//   "NDJT", uint32 version, uint32 entry point count N,
+//   N x (uint8 length, name), e.g. "glBindBuffer",
+//   calls...
+//
+// Each call is a uint16 index into the name table followed by its arguments.
+// Scalars are stored by value. Input pointers are stored either as a
+// payload (uint8 1, uint64 size, bytes) when the size of the pointed-to
+// data is known, e.g. buffer and texture uploads, or as a raw value
+// (uint8 0, uint64 value), e.g. offsets into bound buffers. Output pointers
+// store the number of bytes the call may write (uint64). Callbacks are not
+// stored and replayed as null.
+
+NDJINN_BEGIN_NAMESPACE
+
+namespace detail {
+
+static std::uint32_t const TRACE_VERSION = 1;
+
+//! Minimum scratch memory provided for output arguments during replay,
+//! large enough for any of the glGet* queries.
+static std::size_t const TRACE_MIN_SCRATCH = 256;
+
+//! Largest number of arguments of any entry point.
+static std::size_t const TRACE_MAX_ARGS = 16;
+
+typedef std::vector<unsigned char> TraceData;
+typedef std::vector<std::vector<std::uint64_t>> TraceScratch;
+
+inline void traceWrite(TraceData& data, void const* src, std::size_t const size)
+{
+  unsigned char const* bytes = static_cast<unsigned char const*>(src);
+  data.insert(data.end(), bytes, bytes + size);
+}
+
+template <typename T> inline
+void traceWriteValue(TraceData& data, T const& value)
+{
+  traceWrite(data, &value, sizeof(T));
+}
+
+//! Reads values from a trace, throws if the trace is truncated.
+class TraceReader {
+public:
+  TraceReader(unsigned char const* begin, unsigned char const* end)
+    : _pos(begin)
+    , _end(end)
+  {}
+
+  bool atEnd() const {
+    return _pos == _end;
+  }
+
+  unsigned char const* skip(std::size_t const size) {
+    if (static_cast<std::size_t>(_end - _pos) < size) {
+      NDJINN_THROW("truncated trace");
+    }
+    unsigned char const* const data = _pos;
+    _pos += size;
+    return data;
+  }
+
+  void read(void* dst, std::size_t const size) {
+    std::memcpy(dst, skip(size), size);
+  }
+
+  template <typename T>
+  T value() {
+    T v;
+    read(&v, sizeof(T));
+    return v;
+  }
+
+private:
+  unsigned char const* _pos;
+  unsigned char const* _end;
+};
+
+//! Returns scratch memory of at least @a size bytes, zero initialized.
+inline void* traceScratch(std::vector<std::uint64_t>& slot,
+                          std::size_t const size)
+{
+  slot.assign(size / sizeof(std::uint64_t) + 1, 0);
+  return &slot[0];
+}
+
+// Argument encoding, selected by TraceArgKind.
+
+enum TraceArgKindValue {
+  TRACE_ARG_SCALAR,
+  TRACE_ARG_CALLBACK,
+  TRACE_ARG_INPUT,
+  TRACE_ARG_STRINGS,
+  TRACE_ARG_OUTPUT
+};
+
+template <typename T>
+struct TraceArgKind {
+  typedef typename std::remove_pointer<T>::type Pointee;
+  static int const value =
+    !std::is_pointer<T>::value ? TRACE_ARG_SCALAR :
+    std::is_function<Pointee>::value ? TRACE_ARG_CALLBACK :
+    !std::is_const<Pointee>::value ? TRACE_ARG_OUTPUT :
+    std::is_pointer<Pointee>::value ? TRACE_ARG_STRINGS :
+    TRACE_ARG_INPUT;
+};
+
+template <typename T, int Kind = TraceArgKind<T>::value>
+struct TraceArg;
+
+template <typename T>
+struct TraceArg<T, TRACE_ARG_SCALAR> {
+  static void write(TraceData& data, T const value, std::size_t) {
+    traceWriteValue(data, value);
+  }
+
+  static T read(TraceReader& reader, std::vector<std::uint64_t>&) {
+    return reader.value<T>();
+  }
+};
+
+template <typename T>
+struct TraceArg<T, TRACE_ARG_CALLBACK> {
+  static void write(TraceData&, T, std::size_t) {}
+
+  static T read(TraceReader&, std::vector<std::uint64_t>&) {
+    return nullptr;
+  }
+};
+
+//! Input data, @a size is the number of bytes pointed to or zero if
+//! unknown, in which case the pointer value is stored.
+template <typename T>
+struct TraceArg<T, TRACE_ARG_INPUT> {
+  static void write(TraceData& data, T const value, std::size_t const size) {
+    if (value != nullptr && size > 0) {
+      traceWriteValue(data, static_cast<std::uint8_t>(1));
+      traceWriteValue(data, static_cast<std::uint64_t>(size));
+      traceWrite(data, value, size);
+    }
+    else {
+      traceWriteValue(data, static_cast<std::uint8_t>(0));
+      traceWriteValue(data,
+        static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(value)));
+    }
+  }
+
+  static T read(TraceReader& reader, std::vector<std::uint64_t>& scratch) {
+    if (reader.value<std::uint8_t>() != 0) {
+      std::size_t const size =
+        static_cast<std::size_t>(reader.value<std::uint64_t>());
+      void* const dst = traceScratch(scratch, size);
+      reader.read(dst, size);
+      return static_cast<T>(dst);
+    }
+    return reinterpret_cast<T>(
+      static_cast<std::uintptr_t>(reader.value<std::uint64_t>()));
+  }
+};
+
+//! Array of strings, only the first string is stored, @a size is its
+//! length including null-termination.
+template <typename T>
+struct TraceArg<T, TRACE_ARG_STRINGS> {
+  static void write(TraceData& data, T const value, std::size_t const size) {
+    TraceArg<void const*>::write(data,
+      value != nullptr ? static_cast<void const*>(value[0]) : nullptr, size);
+  }
+
+  static T read(TraceReader& reader, std::vector<std::uint64_t>& scratch) {
+    if (reader.value<std::uint8_t>() != 0) {
+      // Pointer to the string followed by the string itself.
+      std::size_t const size =
+        static_cast<std::size_t>(reader.value<std::uint64_t>());
+      traceScratch(scratch, sizeof(std::uint64_t) + size);
+      reader.read(&scratch[1], size);
+      typedef typename std::remove_const<
+        typename std::remove_pointer<T>::type>::type String;
+      String* const strings = reinterpret_cast<String*>(&scratch[0]);
+      strings[0] = reinterpret_cast<String>(&scratch[1]);
+      return strings;
+    }
+    return reinterpret_cast<T>(
+      static_cast<std::uintptr_t>(reader.value<std::uint64_t>()));
+  }
+};
+
+//! Output data, @a size is the number of bytes the call may write or zero
+//! if small.
+template <typename T>
+struct TraceArg<T, TRACE_ARG_OUTPUT> {
+  static void write(TraceData& data, T, std::size_t const size) {
+    traceWriteValue(data, static_cast<std::uint64_t>(size));
+  }
+
+  static T read(TraceReader& reader, std::vector<std::uint64_t>& scratch) {
+    std::size_t const size =
+      static_cast<std::size_t>(reader.value<std::uint64_t>());
+    return static_cast<T>(
+      traceScratch(scratch, size > TRACE_MIN_SCRATCH ? size : TRACE_MIN_SCRATCH));
+  }
+};
+
+// Payload sizes.
+
+//! Bytes per pixel of client side pixel data.
+inline std::size_t pixelSize(GLenum const format, GLenum const type)
+{
+  std::size_t components = 4;
+  switch (format) {
+  case GL_RED:
+  case GL_GREEN:
+  case GL_BLUE:
+  case GL_RED_INTEGER:
+  case GL_DEPTH_COMPONENT:
+  case GL_STENCIL_INDEX:
+    components = 1;
+    break;
+  case GL_RG:
+  case GL_RG_INTEGER:
+  case GL_DEPTH_STENCIL:
+    components = 2;
+    break;
+  case GL_RGB:
+  case GL_BGR:
+  case GL_RGB_INTEGER:
+  case GL_BGR_INTEGER:
+    components = 3;
+    break;
+  }
+
+  switch (type) {
+  case GL_UNSIGNED_BYTE_3_3_2:
+  case GL_UNSIGNED_BYTE_2_3_3_REV:
+    return 1;
+  case GL_UNSIGNED_SHORT_5_6_5:
+  case GL_UNSIGNED_SHORT_5_6_5_REV:
+  case GL_UNSIGNED_SHORT_4_4_4_4:
+  case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+  case GL_UNSIGNED_SHORT_5_5_5_1:
+  case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+    return 2;
+  case GL_UNSIGNED_INT_8_8_8_8:
+  case GL_UNSIGNED_INT_8_8_8_8_REV:
+  case GL_UNSIGNED_INT_10_10_10_2:
+  case GL_UNSIGNED_INT_2_10_10_10_REV:
+  case GL_UNSIGNED_INT_24_8:
+  case GL_UNSIGNED_INT_10F_11F_11F_REV:
+  case GL_UNSIGNED_INT_5_9_9_9_REV:
+    return 4;
+  case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+    return 8;
+  case GL_UNSIGNED_BYTE:
+  case GL_BYTE:
+    return components;
+  case GL_UNSIGNED_SHORT:
+  case GL_SHORT:
+  case GL_HALF_FLOAT:
+    return 2 * components;
+  default:
+    return 4 * components;
+  }
+}
+
+//! Size in bytes of client side pixel data, assuming the default pixel
+//! store state, i.e. rows aligned to four bytes.
+inline std::size_t imageSize(GLsizei const width, GLsizei const height,
+                             GLenum const format, GLenum const type)
+{
+  if (width <= 0 || height <= 0) {
+    return 0;
+  }
+  std::size_t const row = pixelSize(format, type) * width;
+  std::size_t const stride = (row + 3) & ~static_cast<std::size_t>(3);
+  return stride * (height - 1) + row;
+}
+
+inline std::size_t stringSize(GLchar const* str, GLsizei const length = -1)
+{
+  return str == nullptr ? 0 :
+    length < 0 ? std::strlen(str) + 1 : static_cast<std::size_t>(length);
+}
+
+//! Number of bytes pointed to by argument @a arg of entry point I, zero if
+//! unknown or small. Specialized below for calls that upload or download
+//! data.
+template <std::size_t I>
+struct TraceSizes {
+  template <typename... A>
+  static std::size_t get(std::size_t, A...) {
+    return 0;
+  }
+};
+
+struct TraceNamesSizes {
+  static std::size_t get(std::size_t const arg, GLsizei const n,
+                         GLuint const*) {
+    return arg == 1 ? n * sizeof(GLuint) : 0;
+  }
+};
+
+//! Multi-bind, e.g. glBindTextures(first, count, names).
+struct TraceBindNamesSizes {
+  static std::size_t get(std::size_t const arg, GLuint, GLsizei const count,
+                         GLuint const*) {
+    return arg == 2 ? count * sizeof(GLuint) : 0;
+  }
+};
+
+struct TraceLocationSizes {
+  static std::size_t get(std::size_t const arg, GLuint, GLchar const* name) {
+    return arg == 1 ? stringSize(name) : 0;
+  }
+};
+
+struct TraceInfoLogSizes {
+  static std::size_t get(std::size_t const arg, GLuint, GLsizei const bufSize,
+                         GLsizei*, GLchar*) {
+    return arg == 3 ? bufSize : 0;
+  }
+};
+
+struct TraceActiveVariableSizes {
+  static std::size_t get(std::size_t const arg, GLuint, GLuint,
+                         GLsizei const bufSize, GLsizei*, GLint*, GLenum*,
+                         GLchar*) {
+    return arg == 6 ? bufSize : 0;
+  }
+};
+
+template <std::size_t N>
+struct TraceUniformSizes {
+  template <typename T>
+  static std::size_t get(std::size_t const arg, GLuint, GLint,
+                         GLsizei const count, T const*) {
+    return arg == 3 ? count * N * sizeof(T) : 0;
+  }
+};
+
+template <std::size_t N>
+struct TraceUniformMatrixSizes {
+  static std::size_t get(std::size_t const arg, GLuint, GLint,
+                         GLsizei const count, GLboolean, GLfloat const*) {
+    return arg == 4 ? count * N * sizeof(GLfloat) : 0;
+  }
+};
+
+struct TraceParameterSizes {
+  template <typename T>
+  static std::size_t get(std::size_t const arg, GLuint, GLenum const pname,
+                         T const*) {
+    return arg == 2 ? (pname == GL_TEXTURE_BORDER_COLOR ? 4 : 1) * sizeof(T) : 0;
+  }
+  template <typename T>
+  static std::size_t get(std::size_t const arg, GLuint, GLenum,
+                         GLenum const pname, T const*) {
+    return arg == 3 ? (pname == GL_TEXTURE_BORDER_COLOR ? 4 : 1) * sizeof(T) : 0;
+  }
+};
+
+struct TraceClearBufferSizes {
+  template <typename T>
+  static std::size_t get(std::size_t const arg, GLenum const buffer, GLint,
+                         T const*) {
+    return arg == 2 ? (buffer == GL_COLOR ? 4 : 1) * sizeof(T) : 0;
+  }
+};
+
+#define NDJINN_TRACE_SIZES(NAME, SIZES) \
+  template <> struct TraceSizes<DispatchIndex::NAME> : SIZES {};
+
+NDJINN_TRACE_SIZES(BindImageTextures, TraceBindNamesSizes)
+NDJINN_TRACE_SIZES(BindSamplers, TraceBindNamesSizes)
+NDJINN_TRACE_SIZES(BindTextures, TraceBindNamesSizes)
+NDJINN_TRACE_SIZES(DeleteBuffers, TraceNamesSizes)
+NDJINN_TRACE_SIZES(DeleteFramebuffers, TraceNamesSizes)
+NDJINN_TRACE_SIZES(DeleteQueries, TraceNamesSizes)
+NDJINN_TRACE_SIZES(DeleteRenderbuffers, TraceNamesSizes)
+NDJINN_TRACE_SIZES(DeleteSamplers, TraceNamesSizes)
+NDJINN_TRACE_SIZES(DeleteTextures, TraceNamesSizes)
+NDJINN_TRACE_SIZES(DeleteVertexArrays, TraceNamesSizes)
+NDJINN_TRACE_SIZES(DrawBuffers, TraceNamesSizes)
+NDJINN_TRACE_SIZES(GenBuffers, TraceNamesSizes)
+NDJINN_TRACE_SIZES(GenFramebuffers, TraceNamesSizes)
+NDJINN_TRACE_SIZES(GenQueries, TraceNamesSizes)
+NDJINN_TRACE_SIZES(GenRenderbuffers, TraceNamesSizes)
+NDJINN_TRACE_SIZES(GenSamplers, TraceNamesSizes)
+NDJINN_TRACE_SIZES(GenTextures, TraceNamesSizes)
+NDJINN_TRACE_SIZES(GenVertexArrays, TraceNamesSizes)
+NDJINN_TRACE_SIZES(GetAttribLocation, TraceLocationSizes)
+NDJINN_TRACE_SIZES(GetUniformBlockIndex, TraceLocationSizes)
+NDJINN_TRACE_SIZES(GetUniformLocation, TraceLocationSizes)
+NDJINN_TRACE_SIZES(GetProgramInfoLog, TraceInfoLogSizes)
+NDJINN_TRACE_SIZES(GetShaderInfoLog, TraceInfoLogSizes)
+NDJINN_TRACE_SIZES(GetShaderSource, TraceInfoLogSizes)
+NDJINN_TRACE_SIZES(GetActiveAttrib, TraceActiveVariableSizes)
+NDJINN_TRACE_SIZES(GetActiveUniform, TraceActiveVariableSizes)
+NDJINN_TRACE_SIZES(ProgramUniform1fv, TraceUniformSizes<1>)
+NDJINN_TRACE_SIZES(ProgramUniform1iv, TraceUniformSizes<1>)
+NDJINN_TRACE_SIZES(ProgramUniform2fv, TraceUniformSizes<2>)
+NDJINN_TRACE_SIZES(ProgramUniform2iv, TraceUniformSizes<2>)
+NDJINN_TRACE_SIZES(ProgramUniform3fv, TraceUniformSizes<3>)
+NDJINN_TRACE_SIZES(ProgramUniform3iv, TraceUniformSizes<3>)
+NDJINN_TRACE_SIZES(ProgramUniform4fv, TraceUniformSizes<4>)
+NDJINN_TRACE_SIZES(ProgramUniform4iv, TraceUniformSizes<4>)
+NDJINN_TRACE_SIZES(ProgramUniformMatrix2fv, TraceUniformMatrixSizes<4>)
+NDJINN_TRACE_SIZES(ProgramUniformMatrix2x3fv, TraceUniformMatrixSizes<6>)
+NDJINN_TRACE_SIZES(ProgramUniformMatrix2x4fv, TraceUniformMatrixSizes<8>)
+NDJINN_TRACE_SIZES(ProgramUniformMatrix3fv, TraceUniformMatrixSizes<9>)
+NDJINN_TRACE_SIZES(ProgramUniformMatrix3x2fv, TraceUniformMatrixSizes<6>)
+NDJINN_TRACE_SIZES(ProgramUniformMatrix3x4fv, TraceUniformMatrixSizes<12>)
+NDJINN_TRACE_SIZES(ProgramUniformMatrix4fv, TraceUniformMatrixSizes<16>)
+NDJINN_TRACE_SIZES(ProgramUniformMatrix4x2fv, TraceUniformMatrixSizes<8>)
+NDJINN_TRACE_SIZES(ProgramUniformMatrix4x3fv, TraceUniformMatrixSizes<12>)
+NDJINN_TRACE_SIZES(SamplerParameterfv, TraceParameterSizes)
+NDJINN_TRACE_SIZES(SamplerParameteriv, TraceParameterSizes)
+NDJINN_TRACE_SIZES(TextureParameterIivEXT, TraceParameterSizes)
+NDJINN_TRACE_SIZES(TextureParameterIuivEXT, TraceParameterSizes)
+NDJINN_TRACE_SIZES(TextureParameterfvEXT, TraceParameterSizes)
+NDJINN_TRACE_SIZES(TextureParameterivEXT, TraceParameterSizes)
+NDJINN_TRACE_SIZES(ClearBufferfv, TraceClearBufferSizes)
+NDJINN_TRACE_SIZES(ClearBufferiv, TraceClearBufferSizes)
+NDJINN_TRACE_SIZES(ClearBufferuiv, TraceClearBufferSizes)
+
+#undef NDJINN_TRACE_SIZES
+
+template <>
+struct TraceSizes<DispatchIndex::BindBuffersBase> {
+  static std::size_t get(std::size_t const arg, GLenum, GLuint,
+                         GLsizei const count, GLuint const*) {
+    return arg == 3 ? count * sizeof(GLuint) : 0;
+  }
+};
+
+template <>
+struct TraceSizes<DispatchIndex::BindBuffersRange> {
+  static std::size_t get(std::size_t const arg, GLenum, GLuint,
+                         GLsizei const count, GLuint const* buffers,
+                         GLintptr const*, GLsizeiptr const*) {
+    if (buffers == nullptr) {
+      return 0; // Unbinding, offsets and sizes are ignored.
+    }
+    switch (arg) {
+    case 3: return count * sizeof(GLuint);
+    case 4: return count * sizeof(GLintptr);
+    case 5: return count * sizeof(GLsizeiptr);
+    default: return 0;
+    }
+  }
+};
+
+//! The clear value is a single pixel.
+template <>
+struct TraceSizes<DispatchIndex::ClearNamedBufferSubDataEXT> {
+  static std::size_t get(std::size_t const arg, GLuint, GLenum, GLsizeiptr,
+                         GLsizeiptr, GLenum const format, GLenum const type,
+                         void const*) {
+    return arg == 6 ? pixelSize(format, type) : 0;
+  }
+};
+
+template <>
+struct TraceSizes<DispatchIndex::NamedBufferDataEXT> {
+  static std::size_t get(std::size_t const arg, GLuint, GLsizeiptr const size,
+                         void const*, GLenum) {
+    return arg == 2 ? size : 0;
+  }
+};
+
+template <>
+struct TraceSizes<DispatchIndex::NamedBufferStorageEXT> {
+  static std::size_t get(std::size_t const arg, GLuint, GLsizeiptr const size,
+                         void const*, GLbitfield) {
+    return arg == 2 ? size : 0;
+  }
+};
+
+template <>
+struct TraceSizes<DispatchIndex::NamedBufferSubDataEXT> {
+  static std::size_t get(std::size_t const arg, GLuint, GLintptr,
+                         GLsizeiptr const size, void const*) {
+    return arg == 3 ? size : 0;
+  }
+};
+
+template <>
+struct TraceSizes<DispatchIndex::GetNamedBufferSubDataEXT> {
+  static std::size_t get(std::size_t const arg, GLuint, GLintptr,
+                         GLsizeiptr const size, void*) {
+    return arg == 3 ? size : 0;
+  }
+};
+
+template <>
+struct TraceSizes<DispatchIndex::ReadPixels> {
+  static std::size_t get(std::size_t const arg, GLint, GLint,
+                         GLsizei const width, GLsizei const height,
+                         GLenum const format, GLenum const type, void*) {
+    return arg == 6 ? imageSize(width, height, format, type) : 0;
+  }
+};
+
+template <>
+struct TraceSizes<DispatchIndex::GetActiveUniformBlockName> {
+  static std::size_t get(std::size_t const arg, GLuint, GLuint,
+                         GLsizei const bufSize, GLsizei*, GLchar*) {
+    return arg == 4 ? bufSize : 0;
+  }
+};
+
+template <>
+struct TraceSizes<DispatchIndex::GetActiveUniformsiv> {
+  static std::size_t get(std::size_t const arg, GLuint,
+                         GLsizei const uniformCount, GLuint const*, GLenum,
+                         GLint*) {
+    return arg == 2 || arg == 4 ? uniformCount * sizeof(GLint) : 0;
+  }
+};
+
+template <>
+struct TraceSizes<DispatchIndex::GetObjectLabel> {
+  static std::size_t get(std::size_t const arg, GLenum, GLuint,
+                         GLsizei const bufSize, GLsizei*, GLchar*) {
+    return arg == 4 ? bufSize : 0;
+  }
+};
+
+template <>
+struct TraceSizes<DispatchIndex::ObjectLabel> {
+  static std::size_t get(std::size_t const arg, GLenum, GLuint,
+                         GLsizei const length, GLchar const* label) {
+    return arg == 3 ? stringSize(label, length) : 0;
+  }
+};
+
+template <>
+struct TraceSizes<DispatchIndex::PushDebugGroup> {
+  static std::size_t get(std::size_t const arg, GLenum, GLuint,
+                         GLsizei const length, GLchar const* message) {
+    return arg == 3 ? stringSize(message, length) : 0;
+  }
+};
+
+template <>
+struct TraceSizes<DispatchIndex::DebugMessageControl> {
+  static std::size_t get(std::size_t const arg, GLenum, GLenum, GLenum,
+                         GLsizei const count, GLuint const*, GLboolean) {
+    return arg == 4 ? count * sizeof(GLuint) : 0;
+  }
+};
+
+//! Sources are concatenated when traced, see traceShaderSource.
+template <>
+struct TraceSizes<DispatchIndex::ShaderSource> {
+  static std::size_t get(std::size_t const arg, GLuint, GLsizei const count,
+                         GLchar const* const* string, GLint const* length) {
+    return arg == 2 && count == 1 && string != nullptr && length == nullptr
+      ? stringSize(string[0]) : 0;
+  }
+};
+
+// Calls.
+
+template <std::size_t... P>
+struct TraceIndices {};
+
+template <std::size_t N, std::size_t... P>
+struct MakeTraceIndices : MakeTraceIndices<N - 1, N - 1, P...> {};
+
+template <std::size_t... P>
+struct MakeTraceIndices<0, P...> {
+  typedef TraceIndices<P...> type;
+};
+
+template <std::size_t I, typename... A, std::size_t... P> inline
+void writeTraceArgs(TraceData& data, TraceIndices<P...>, A... args)
+{
+  std::size_t const sizes[] = { 0, TraceSizes<I>::get(P, args...)... };
+  int const expand[] = { 0, (TraceArg<A>::write(data, args, sizes[P + 1]), 0)... };
+  (void)sizes;
+  (void)expand;
+}
+
+//! Append a call to entry point I to the trace.
+template <std::size_t I, typename... A> inline
+void writeTraceCall(TraceData& data, A... args)
+{
+  traceWriteValue(data, static_cast<std::uint16_t>(I));
+  writeTraceArgs<I>(data, typename MakeTraceIndices<sizeof...(A)>::type(),
+                    args...);
+}
+
+//! Buffer memory mapped for writing, traced as a glNamedBufferSubDataEXT
+//! call when unmapped, or at every fence if mapped persistently. Explicitly
+//! flushed mappings are traced when flushed instead.
+struct TraceMapping {
+  void const* ptr;
+  GLintptr offset;
+  GLsizeiptr length;
+  bool persistent;
+  bool explicitFlush;
+};
+
+class TraceDispatchBase {
+public:
+  //! The trace table currently receiving calls on the calling thread, see
+  //! TraceDispatch.
+  static TraceDispatchBase*& active() {
+    static thread_local TraceDispatchBase* active = nullptr;
+    return active;
+  }
+
+  template <std::size_t I, typename... A>
+  void write(A... args) {
+    writeTraceCall<I>(_data, args...);
+    ++_callCount;
+  }
+
+  Dispatch const& target() const {
+    return _target;
+  }
+
+  //! Buffers currently mapped for writing.
+  std::map<GLuint, TraceMapping>& mappedBuffers() {
+    return _mappedBuffers;
+  }
+
+  //! Append the current contents of a mapping to the trace.
+  void writeMapping(GLuint const buffer, TraceMapping const& mapping) {
+    write<DispatchIndex::NamedBufferSubDataEXT>(
+      buffer, mapping.offset, mapping.length, mapping.ptr);
+  }
+
+protected:
+  explicit TraceDispatchBase(Dispatch const& target)
+    : _target(target)
+    , _callCount(0)
+  {}
+
+  Dispatch _target;
+  TraceData _data;
+  std::size_t _callCount;
+  std::map<GLuint, TraceMapping> _mappedBuffers;
+};
+
+//! Texture downloads are sized by querying the level, replay needs to
+//! provide enough memory for the image.
+template <>
+struct TraceSizes<DispatchIndex::GetTextureImageEXT> {
+  static std::size_t get(std::size_t const arg, GLuint const texture,
+                         GLenum const target, GLint const level,
+                         GLenum const format, GLenum const type, void*) {
+    if (arg != 5) {
+      return 0;
+    }
+    Dispatch const& d = TraceDispatchBase::active()->target();
+    GLint width = 0;
+    GLint height = 0;
+    d.GetTextureLevelParameterivEXT(texture, target, level, GL_TEXTURE_WIDTH,
+                                    &width);
+    d.GetTextureLevelParameterivEXT(texture, target, level, GL_TEXTURE_HEIGHT,
+                                    &height);
+    return imageSize(width, height, format, type);
+  }
+};
+
+template <>
+struct TraceSizes<DispatchIndex::GetCompressedTextureImageEXT> {
+  static std::size_t get(std::size_t const arg, GLuint const texture,
+                         GLenum const target, GLint const level, void*) {
+    if (arg != 3) {
+      return 0;
+    }
+    GLint size = 0;
+    TraceDispatchBase::active()->target().GetTextureLevelParameterivEXT(
+      texture, target, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+    return size;
+  }
+};
+
+//! True if a buffer is bound to GL_PIXEL_UNPACK_BUFFER, pixel pointers
+//! are then offsets into it and traced as raw values. Asks the current
+//! StateCache, or the target table if the binding is not cached.
+inline bool traceUnpackBufferBound()
+{
+  StateCache const* const cache = StateCache::current();
+  if (cache != nullptr) {
+    auto const iter = cache->bufferBindings.find(GL_PIXEL_UNPACK_BUFFER);
+    if (iter != cache->bufferBindings.end()) {
+      return iter->second != 0;
+    }
+  }
+  GLint buffer = 0;
+  TraceDispatchBase::active()->target().GetIntegerv(
+    GL_PIXEL_UNPACK_BUFFER_BINDING, &buffer);
+  return buffer != 0;
+}
+
+template <>
+struct TraceSizes<DispatchIndex::TextureImage2DEXT> {
+  static std::size_t get(std::size_t const arg, GLuint, GLenum, GLint, GLint,
+                         GLsizei const width, GLsizei const height, GLint,
+                         GLenum const format, GLenum const type, void const*) {
+    return arg == 9 && !traceUnpackBufferBound()
+      ? imageSize(width, height, format, type) : 0;
+  }
+};
+
+template <>
+struct TraceSizes<DispatchIndex::TextureSubImage2DEXT> {
+  static std::size_t get(std::size_t const arg, GLuint, GLenum, GLint, GLint,
+                         GLint, GLsizei const width, GLsizei const height,
+                         GLenum const format, GLenum const type, void const*) {
+    return arg == 9 && !traceUnpackBufferBound()
+      ? imageSize(width, height, format, type) : 0;
+  }
+};
+
+template <>
+struct TraceSizes<DispatchIndex::CompressedTextureImage2DEXT> {
+  static std::size_t get(std::size_t const arg, GLuint, GLenum, GLint, GLenum,
+                         GLsizei, GLsizei, GLint, GLsizei const imageSize,
+                         void const*) {
+    return arg == 8 && !traceUnpackBufferBound() ? imageSize : 0;
+  }
+};
+
+template <>
+struct TraceSizes<DispatchIndex::CompressedTextureSubImage2DEXT> {
+  static std::size_t get(std::size_t const arg, GLuint, GLenum, GLint, GLint,
+                         GLint, GLsizei, GLsizei, GLenum,
+                         GLsizei const imageSize, void const*) {
+    return arg == 9 && !traceUnpackBufferBound() ? imageSize : 0;
+  }
+};
+
+//! Writes the call to the trace and forwards it to the target table.
+template <typename F, F Dispatch::*M, std::size_t I>
+struct TraceStub;
+
+template <typename R, typename... A, R (GLAPIENTRY* Dispatch::*M)(A...),
+          std::size_t I>
+struct TraceStub<R (GLAPIENTRY*)(A...), M, I> {
+  static R GLAPIENTRY call(A... args) {
+    TraceDispatchBase* const tracer = TraceDispatchBase::active();
+    tracer->write<I>(args...);
+    return (tracer->target().*M)(args...);
+  }
+};
+
+//! Forwards the call to the target table without tracing it.
+template <typename F, F Dispatch::*M>
+struct UntracedStub;
+
+template <typename R, typename... A, R (GLAPIENTRY* Dispatch::*M)(A...)>
+struct UntracedStub<R (GLAPIENTRY*)(A...), M> {
+  static R GLAPIENTRY call(A... args) {
+    return (TraceDispatchBase::active()->target().*M)(args...);
+  }
+};
+
+//! Multiple sources are stored as a single string so that only one
+//! payload is needed.
+inline void GLAPIENTRY traceShaderSource(GLuint const shader,
+                                         GLsizei const count,
+                                         GLchar const* const* string,
+                                         GLint const* length)
+{
+  TraceDispatchBase* const tracer = TraceDispatchBase::active();
+  std::string source;
+  for (GLsizei i = 0; i < count; ++i) {
+    if (length != nullptr && length[i] >= 0) {
+      source.append(string[i], length[i]);
+    }
+    else {
+      source.append(string[i]);
+    }
+  }
+  GLchar const* const str = source.c_str();
+  tracer->write<DispatchIndex::ShaderSource>(
+    shader, static_cast<GLsizei>(1), &str, static_cast<GLint const*>(nullptr));
+  tracer->target().ShaderSource(shader, count, string, length);
+}
+
+//! Mapping is not traced, instead the contents of buffers mapped for
+//! writing are traced as a glNamedBufferSubDataEXT call when unmapped.
+inline GLvoid* GLAPIENTRY traceMapNamedBuffer(GLuint const buffer,
+                                              GLenum const access)
+{
+  TraceDispatchBase* const tracer = TraceDispatchBase::active();
+  GLvoid* const ptr = tracer->target().MapNamedBufferEXT(buffer, access);
+  if (ptr != nullptr && access != GL_READ_ONLY) {
+    GLint size = 0;
+    tracer->target().GetNamedBufferParameterivEXT(buffer, GL_BUFFER_SIZE,
+                                                  &size);
+    TraceMapping const mapping = { ptr, 0, size, false, false };
+    tracer->mappedBuffers()[buffer] = mapping;
+  }
+  return ptr;
+}
+
+inline GLvoid* GLAPIENTRY traceMapNamedBufferRange(GLuint const buffer,
+                                                   GLintptr const offset,
+                                                   GLsizeiptr const length,
+                                                   GLbitfield const access)
+{
+  TraceDispatchBase* const tracer = TraceDispatchBase::active();
+  GLvoid* const ptr =
+    tracer->target().MapNamedBufferRangeEXT(buffer, offset, length, access);
+  if (ptr != nullptr && (access & GL_MAP_WRITE_BIT) != 0) {
+    TraceMapping const mapping = { ptr, offset, length,
+      (access & GL_MAP_PERSISTENT_BIT) != 0,
+      (access & GL_MAP_FLUSH_EXPLICIT_BIT) != 0 };
+    tracer->mappedBuffers()[buffer] = mapping;
+  }
+  return ptr;
+}
+
+inline GLboolean GLAPIENTRY traceUnmapNamedBuffer(GLuint const buffer)
+{
+  TraceDispatchBase* const tracer = TraceDispatchBase::active();
+  auto const iter = tracer->mappedBuffers().find(buffer);
+  if (iter != tracer->mappedBuffers().end()) {
+    if (!iter->second.explicitFlush) {
+      tracer->writeMapping(buffer, iter->second);
+    }
+    tracer->mappedBuffers().erase(iter);
+  }
+  return tracer->target().UnmapNamedBufferEXT(buffer);
+}
+
+//! Flushing is not traced, the flushed range is traced as a
+//! glNamedBufferSubDataEXT call instead.
+inline void GLAPIENTRY traceFlushMappedNamedBufferRange(GLuint const buffer,
+                                                        GLintptr const offset,
+                                                        GLsizeiptr const length)
+{
+  TraceDispatchBase* const tracer = TraceDispatchBase::active();
+  auto const iter = tracer->mappedBuffers().find(buffer);
+  if (iter != tracer->mappedBuffers().end()) {
+    TraceMapping const& mapping = iter->second;
+    TraceMapping const flushed = {
+      static_cast<unsigned char const*>(mapping.ptr) + offset,
+      mapping.offset + offset, length, mapping.persistent, true };
+    tracer->writeMapping(buffer, flushed);
+  }
+  tracer->target().FlushMappedNamedBufferRangeEXT(buffer, offset, length);
+}
+
+//! Replay uploads mapped data with glNamedBufferSubDataEXT, which immutable
+//! storage only allows if dynamic.
+inline void GLAPIENTRY traceNamedBufferStorage(GLuint const buffer,
+                                               GLsizeiptr const size,
+                                               GLvoid const* data,
+                                               GLbitfield const flags)
+{
+  TraceDispatchBase* const tracer = TraceDispatchBase::active();
+  tracer->write<DispatchIndex::NamedBufferStorageEXT>(
+    buffer, size, data, flags | GL_DYNAMIC_STORAGE_BIT);
+  tracer->target().NamedBufferStorageEXT(buffer, size, data, flags);
+}
+
+//! Sync objects are not traced, replay is not throttled. Persistently
+//! mapped buffers are never unmapped, so their contents are traced at every
+//! fence instead, which is where streaming code hands data to OpenGL.
+inline GLsync GLAPIENTRY traceFenceSync(GLenum const condition,
+                                        GLbitfield const flags)
+{
+  TraceDispatchBase* const tracer = TraceDispatchBase::active();
+  for (auto iter = tracer->mappedBuffers().begin();
+       iter != tracer->mappedBuffers().end(); ++iter) {
+    if (iter->second.persistent && !iter->second.explicitFlush) {
+      tracer->writeMapping(iter->first, iter->second);
+    }
+  }
+  return tracer->target().FenceSync(condition, flags);
+}
+
+//! Reads a call from the trace, issues it and returns the time spent in
+//! the call in seconds.
+typedef double (*ReplayFunction)(TraceReader&, TraceScratch&,
+                                 Dispatch const&);
+
+template <typename F, F Dispatch::*M>
+struct ReplayStub;
+
+template <typename R, typename... A, R (GLAPIENTRY* Dispatch::*M)(A...)>
+struct ReplayStub<R (GLAPIENTRY*)(A...), M> {
+  static double call(TraceReader& reader, TraceScratch& scratch,
+                     Dispatch const& target) {
+    return call(reader, scratch, target,
+                typename MakeTraceIndices<sizeof...(A)>::type());
+  }
+
+  template <std::size_t... P>
+  static double call(TraceReader& reader, TraceScratch& scratch,
+                     Dispatch const& target, TraceIndices<P...>) {
+    static_assert(sizeof...(A) <= TRACE_MAX_ARGS, "too many arguments");
+    // Braced initialization reads the arguments in order.
+    std::tuple<A...> const args{ TraceArg<A>::read(reader, scratch[P])... };
+    (void)args;
+    (void)scratch;
+    auto const begin = std::chrono::high_resolution_clock::now();
+    (target.*M)(std::get<P>(args)...);
+    auto const end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(end - begin).count();
+  }
+};
+
+} // Namespace: detail.
+
+//! Writes every call, including buffer and texture payloads, to a binary
+//! trace and forwards it to a target table. Install dispatch(), e.g. with
+//! a DispatchScope, then save() the trace and replay it with replayTrace.
+//! Only one trace table may exist at a time per thread, and it must be
+//! used and destroyed on the thread that created it.
+//!
+//! Pixel data sizes assume the default pixel store state. Uploads from a
+//! bound pixel unpack buffer are traced as offsets into the buffer.
+class TraceDispatch : public detail::TraceDispatchBase {
+public:
+  explicit TraceDispatch(Dispatch const& target = detail::dispatch())
+    : detail::TraceDispatchBase(target)
+  {
+    if (active() != nullptr) {
+      NDJINN_THROW("only one TraceDispatch may exist per thread");
+    }
+    active() = this;
+#define NDJINN_DISPATCH_TRACE(FAMILY, NAME) \
+    _dispatch.NAME = &detail::TraceStub< \
+      decltype(Dispatch::NAME), &Dispatch::NAME, DispatchIndex::NAME>::call;
+    NDJINN_GL_FUNCTIONS(NDJINN_DISPATCH_TRACE)
+#undef NDJINN_DISPATCH_TRACE
+    _dispatch.ShaderSource = &detail::traceShaderSource;
+    _dispatch.MapNamedBufferEXT = &detail::traceMapNamedBuffer;
+    _dispatch.MapNamedBufferRangeEXT = &detail::traceMapNamedBufferRange;
+    _dispatch.UnmapNamedBufferEXT = &detail::traceUnmapNamedBuffer;
+    _dispatch.FlushMappedNamedBufferRangeEXT =
+      &detail::traceFlushMappedNamedBufferRange;
+    _dispatch.NamedBufferStorageEXT = &detail::traceNamedBufferStorage;
+    _dispatch.FenceSync = &detail::traceFenceSync;
+    _dispatch.ClientWaitSync = &detail::UntracedStub<
+      decltype(Dispatch::ClientWaitSync), &Dispatch::ClientWaitSync>::call;
+    _dispatch.DeleteSync = &detail::UntracedStub<
+      decltype(Dispatch::DeleteSync), &Dispatch::DeleteSync>::call;
+    clear();
+  }
+
+  ~TraceDispatch() {
+    active() = nullptr;
+  }
+
+  //! Table to install, e.g. with a DispatchScope.
+  Dispatch const& dispatch() const {
+    return _dispatch;
+  }
+
+  //! The trace, including the header.
+  std::vector<unsigned char> const& data() const {
+    return _data;
+  }
+
+  //! Number of calls traced.
+  std::size_t callCount() const {
+    return _callCount;
+  }
+
+  //! Write the trace to a file. May throw.
+  void save(std::string const& path) const {
+    std::ofstream file(path.c_str(), std::ios::binary);
+    file.write(reinterpret_cast<char const*>(&_data[0]),
+               static_cast<std::streamsize>(_data.size()));
+    if (!file) {
+      NDJINN_THROW("could not write trace: " << path);
+    }
+  }
+
+  //! Discard traced calls.
+  void clear() {
+    _data.clear();
+    _callCount = 0;
+    detail::traceWrite(_data, "NDJT", 4);
+    detail::traceWriteValue(_data, detail::TRACE_VERSION);
+    detail::traceWriteValue(_data,
+                            static_cast<std::uint32_t>(DispatchIndex::COUNT));
+    for (std::size_t i = 0; i < DispatchIndex::COUNT; ++i) {
+      std::string const name = dispatchName(i);
+      detail::traceWriteValue(_data, static_cast<std::uint8_t>(name.size()));
+      detail::traceWrite(_data, name.data(), name.size());
+    }
+  }
+
+private:
+  TraceDispatch(TraceDispatch const&); //!< Disabled copy.
+  TraceDispatch& operator=(TraceDispatch const&); //!< Disabled assign.
+
+  Dispatch _dispatch;
+};
+
+//! Per entry point timings collected by replayTrace.
+struct ReplayReport {
+  struct Timing {
+    Timing()
+      : calls(0)
+      , seconds(0.)
+    {}
+
+    std::size_t calls;
+    double seconds; //!< Time spent in calls, excluding trace decoding.
+  };
+
+  ReplayReport()
+    : calls(0)
+    , seconds(0.)
+  {}
+
+  std::map<std::string, Timing> timings; //!< By OpenGL name.
+  std::size_t calls;
+  double seconds;
+};
+
+//! Read a trace file. May throw.
+inline std::vector<unsigned char> loadTrace(std::string const& path)
+{
+  std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+  if (!file) {
+    NDJINN_THROW("could not open trace: " << path);
+  }
+  std::vector<unsigned char> data(static_cast<std::size_t>(file.tellg()));
+  file.seekg(0);
+  if (!data.empty()) {
+    file.read(reinterpret_cast<char*>(&data[0]),
+              static_cast<std::streamsize>(data.size()));
+  }
+  if (!file) {
+    NDJINN_THROW("could not read trace: " << path);
+  }
+  return data;
+}
+
+//! Issue the calls in a trace against a table, typically the real table of
+//! a fresh context. Traces written by other versions
+//! of nDjinn can be replayed as long as the entry points they use still
+//! exist. Object names are not remapped, they are assumed to be generated
+//! in the same order as when the trace was written. May throw.
+inline ReplayReport replayTrace(std::vector<unsigned char> const& trace,
+                                Dispatch const& target = detail::dispatch())
+{
+  static detail::ReplayFunction const replay[] = {
+#define NDJINN_DISPATCH_REPLAY(FAMILY, NAME) \
+    &detail::ReplayStub<decltype(Dispatch::NAME), &Dispatch::NAME>::call,
+    NDJINN_GL_FUNCTIONS(NDJINN_DISPATCH_REPLAY)
+#undef NDJINN_DISPATCH_REPLAY
+  };
+
+  unsigned char const* const begin = trace.empty() ? nullptr : &trace[0];
+  detail::TraceReader reader(begin, begin + trace.size());
+  if (trace.size() < 4 || std::memcmp(reader.skip(4), "NDJT", 4) != 0) {
+    NDJINN_THROW("not a trace");
+  }
+  std::uint32_t const version = reader.value<std::uint32_t>();
+  if (version != detail::TRACE_VERSION) {
+    NDJINN_THROW("unsupported trace version: " << version);
+  }
+
+  // Map trace indices to local indices by name.
+  std::map<std::string, std::size_t> local;
+  for (std::size_t i = 0; i < DispatchIndex::COUNT; ++i) {
+    local[dispatchName(i)] = i;
+  }
+  std::vector<std::string> names(reader.value<std::uint32_t>());
+  std::vector<std::size_t> indices(names.size(), DispatchIndex::COUNT);
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    std::size_t const length = reader.value<std::uint8_t>();
+    names[i].assign(reinterpret_cast<char const*>(reader.skip(length)),
+                    length);
+    auto const iter = local.find(names[i]);
+    if (iter != local.end()) {
+      indices[i] = iter->second;
+    }
+  }
+
+  std::vector<ReplayReport::Timing> timings(DispatchIndex::COUNT);
+  detail::TraceScratch scratch(detail::TRACE_MAX_ARGS);
+  while (!reader.atEnd()) {
+    std::size_t const index = reader.value<std::uint16_t>();
+    if (index >= indices.size()) {
+      NDJINN_THROW("invalid trace call index: " << index);
+    }
+    if (indices[index] == DispatchIndex::COUNT) {
+      NDJINN_THROW("unsupported trace call: " << names[index]);
+    }
+    ReplayReport::Timing& timing = timings[indices[index]];
+    ++timing.calls;
+    timing.seconds += replay[indices[index]](reader, scratch, target);
+  }
+
+  ReplayReport report;
+  for (std::size_t i = 0; i < timings.size(); ++i) {
+    if (timings[i].calls > 0) {
+      report.timings[dispatchName(i)] = timings[i];
+      report.calls += timings[i].calls;
+      report.seconds += timings[i].seconds;
+    }
+  }
+  return report;
+}
+
+NDJINN_END_NAMESPACE
+
+namespace std {
+
+inline
+ostream& operator<<(ostream& os, ndj::ReplayReport const& report)
+{
+  os << "ReplayReport" << endl
+     << "  Calls: " << report.calls << endl
+     << "  Seconds: " << report.seconds << endl;
+  for (auto iter = report.timings.begin(); iter != report.timings.end();
+       ++iter) {
+    os << "    " << iter->first
+       << ": " << iter->second.calls << " calls, "
+       << iter->second.seconds << " s" << endl;
+  }
+  return os;
+}
+
+} // Namespace: std.
+
+#endif // NDJINN_TRACE_HPP_INCLUDED
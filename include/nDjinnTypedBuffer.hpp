@@ -0,0 +1,340 @@
+//------------------------------------------------------------------------------
+//
+// Contributors:
+//             1) Tommy Hinks
+//
+//------------------------------------------------------------------------------
+
+#ifndef NDJINN_TYPED_BUFFER_HPP_INCLUDED
+#define NDJINN_TYPED_BUFFER_HPP_INCLUDED
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "nDjinnBuffer.hpp"
+#include "nDjinnException.hpp"
+#include "nDjinnFunctions.hpp"
+#include "nDjinnGL.hpp"
+#include "nDjinnGLTypeEnum.hpp"
+#include "nDjinnNamespace.hpp"
+
+NDJINN_BEGIN_NAMESPACE
+
+//! Non-owning view of @a size contiguous elements, e.g. mapped buffer
+//! memory.
+template <typename E>
+class ElementSpan {
+public:
+  typedef E Element;
+  typedef E* iterator;
+
+  ElementSpan()
+    : _data(nullptr)
+    , _size(0)
+  {}
+
+  ElementSpan(E* const data, std::size_t const size)
+    : _data(data)
+    , _size(size)
+  {}
+
+  E* data() const {
+    return _data;
+  }
+
+  std::size_t size() const {
+    return _size;
+  }
+
+  bool empty() const {
+    return _size == 0;
+  }
+
+  E& operator[](std::size_t const i) const {
+    return _data[i];
+  }
+
+  E* begin() const {
+    return _data;
+  }
+
+  E* end() const {
+    return _data + _size;
+  }
+
+private:
+  E* _data;
+  std::size_t _size;
+};
+
+//! A buffer of elements of type E, e.g. vertices or indices. The element
+//! count is kept on the client side and all offsets and sizes are in
+//! elements, so no size queries or byte arithmetic are needed. Ranges are
+//! checked and throw if out of bounds.
+template <GLenum TargetT, typename E>
+class TypedBuffer {
+public:
+  static GLenum const TARGET = TargetT;
+  typedef E Element;
+
+  static_assert(std::is_trivially_copyable<E>::value,
+                "buffer elements must be trivially copyable");
+  // Mapped pointers are aligned to GL_MIN_MAP_BUFFER_ALIGNMENT, at least
+  // 64, and element offsets are multiples of sizeof(E).
+  static_assert(alignof(E) <= 64, "buffer elements must be at most "
+                "64-byte aligned");
+
+  //! CTOR. Allocate @a count elements, copied from @a elements unless
+  //! null. May throw.
+  explicit TypedBuffer(std::size_t const count,
+                       E const* const elements = nullptr,
+                       GLenum const usage = GL_STATIC_DRAW)
+    : _buffer(bytes(count), elements, usage)
+    , _count(count)
+  {}
+
+  //! CTOR. Allocate immutable storage for @a count elements, see
+  //! ImmutableStorage. May throw.
+  TypedBuffer(std::size_t const count,
+              E const* const elements,
+              ImmutableStorage const& storage)
+    : _buffer(bytes(count), elements, storage)
+    , _count(count)
+  {}
+
+  //! CTOR. Copy @a elements. May throw.
+  explicit TypedBuffer(std::vector<E> const& elements,
+                       GLenum const usage = GL_STATIC_DRAW)
+    : _buffer(bytes(elements.size()),
+              elements.empty() ? nullptr : &elements[0], usage)
+    , _count(elements.size())
+  {}
+
+  //! Move CTOR, @a rhs is left empty, i.e. with a zero handle.
+  TypedBuffer(TypedBuffer&& rhs) noexcept
+    : _buffer(std::move(rhs._buffer))
+    , _count(rhs._count)
+  {
+    rhs._count = 0;
+  }
+
+  //! Move assign, the current buffer is deleted and @a rhs left empty.
+  TypedBuffer& operator=(TypedBuffer&& rhs) noexcept {
+    if (this != &rhs) {
+      _buffer = std::move(rhs._buffer);
+      _count = rhs._count;
+      rhs._count = 0;
+    }
+    return *this;
+  }
+
+  //! Expose resource handle.
+  GLuint handle() const {
+    return _buffer.handle();
+  }
+
+  //! Untyped access, e.g. for copies between buffers.
+  Buffer<TargetT>& buffer() {
+    return _buffer;
+  }
+
+  Buffer<TargetT> const& buffer() const {
+    return _buffer;
+  }
+
+  //! Number of elements.
+  std::size_t count() const {
+    return _count;
+  }
+
+  GLsizeiptr sizeInBytes() const {
+    return _buffer.sizeInBytes();
+  }
+
+  //! Bind buffer.
+  void bind() const {
+    _buffer.bind();
+  }
+
+  //! Bind @a count elements starting at @a first to an indexed binding
+  //! point. May throw.
+  void bindRange(GLuint const index,
+                 std::size_t const first,
+                 std::size_t const count) const {
+    checkRange(first, count);
+    _buffer.bindRange(index, offset(first), bytes(count));
+  }
+
+  //! Release buffer.
+  void release() const {
+    _buffer.release();
+  }
+
+  //! Reallocate for @a count elements, copied from @a elements unless
+  //! null. Throws if storage is immutable.
+  void setElements(std::size_t const count,
+                   E const* const elements,
+                   GLenum const usage = GL_STATIC_DRAW) {
+    _buffer.setData(bytes(count), elements, usage);
+    _count = count;
+  }
+
+  //! Replace @a count elements starting at @a first. May throw.
+  void setSubElements(std::size_t const first,
+                      std::size_t const count,
+                      E const* const elements) {
+    checkRange(first, count);
+    _buffer.setSubData(offset(first), bytes(count), elements);
+  }
+
+  //! Replace @a count elements starting at @a first using @a strategy,
+  //! see BufferUpdate. May throw.
+  void update(std::size_t const first,
+              std::size_t const count,
+              E const* const elements,
+              BufferUpdate const strategy = BUFFER_UPDATE_SUB_DATA) {
+    checkRange(first, count);
+    _buffer.update(offset(first), bytes(count), elements, strategy);
+  }
+
+  //! Copy @a count elements starting at @a first to @a elements. May
+  //! throw.
+  void getSubElements(std::size_t const first,
+                      std::size_t const count,
+                      E* const elements) const {
+    checkRange(first, count);
+    _buffer.getSubData(offset(first), bytes(count), elements);
+  }
+
+  //! Convenience. Read back all elements. May throw.
+  std::vector<E> elements() const {
+    std::vector<E> elements(_count);
+    if (_count > 0) {
+      getSubElements(0, _count, &elements[0]);
+    }
+    return elements;
+  }
+
+  //! Map all elements, @a access is a combination of GL_MAP_*_BIT flags.
+  //! The view is valid until unmap(). May throw.
+  ElementSpan<E> map(GLbitfield const access) {
+    return mapRange(0, _count, access);
+  }
+
+  //! Map @a count elements starting at @a first. May throw.
+  ElementSpan<E> mapRange(std::size_t const first,
+                          std::size_t const count,
+                          GLbitfield const access) {
+    checkRange(first, count);
+    E* const data =
+      _buffer.template mapRange<E>(offset(first), bytes(count), access);
+    if (data == nullptr) {
+      NDJINN_THROW("could not map buffer: " << _buffer.handle());
+    }
+    return ElementSpan<E>(data, count);
+  }
+
+  //! Make writes to @a count elements starting at @a first of a range
+  //! mapped with GL_MAP_FLUSH_EXPLICIT_BIT visible to OpenGL, @a first is
+  //! relative to the mapped range. May throw.
+  void flushMappedRange(std::size_t const first, std::size_t const count) {
+    _buffer.flushMappedRange(offset(first), bytes(count));
+  }
+
+  //! Returns false if the contents were corrupted while mapped.
+  bool unmap() {
+    return _buffer.unmap();
+  }
+
+  //! Byte offset of element @a i.
+  static GLintptr offset(std::size_t const i) {
+    return static_cast<GLintptr>(i * sizeof(E));
+  }
+
+  //! Size of @a count elements in bytes.
+  static GLsizeiptr bytes(std::size_t const count) {
+    return static_cast<GLsizeiptr>(count * sizeof(E));
+  }
+
+private:
+  TypedBuffer(TypedBuffer const&); //!< Disabled copy.
+  TypedBuffer& operator=(TypedBuffer const&); //!< Disabled assign.
+
+  void checkRange(std::size_t const first, std::size_t const count) const {
+    if (first > _count || count > _count - first) {
+      NDJINN_THROW("elements [" << first << ", " << first + count
+                   << ") out of range: " << _count << " elements");
+    }
+  }
+
+  Buffer<TargetT> _buffer;
+  std::size_t _count;
+};
+
+//! Index buffer, the index type is passed to draws through GLTypeEnum.
+template <typename E>
+using IndexBuffer = TypedBuffer<GL_ELEMENT_ARRAY_BUFFER, E>;
+
+namespace detail {
+
+//! Index type of @a E, only unsigned bytes, shorts and ints are valid.
+template <typename E>
+struct IndexTypeEnum {
+  static_assert(std::is_same<E, GLubyte>::value ||
+                std::is_same<E, GLushort>::value ||
+                std::is_same<E, GLuint>::value,
+                "index type must be GLubyte, GLushort or GLuint");
+  static GLenum const value = GLTypeEnum<E>::value;
+};
+
+//! Number of indices to draw, see drawElements(). Throws if out of range.
+template <typename E> inline
+std::size_t indexCount(IndexBuffer<E> const& indices,
+                       std::size_t const first,
+                       std::size_t const count) {
+  if (first <= indices.count()) {
+    std::size_t const n = count == 0 ? indices.count() - first : count;
+    if (n <= indices.count() - first) {
+      return n;
+    }
+  }
+  NDJINN_THROW("indices [" << first << ", " << first + count
+               << ") out of range: " << indices.count() << " indices");
+}
+
+} // Namespace: detail.
+
+//! Draw @a count indices of @a indices starting at @a first, all if
+//! @a count is zero. The index type follows from the element type.
+//! @a indices must be the element array buffer of the bound vertex array.
+//! May throw.
+template <typename E> inline
+void drawElements(GLenum const mode,
+                  IndexBuffer<E> const& indices,
+                  std::size_t const first = 0,
+                  std::size_t const count = 0) {
+  std::size_t const n = detail::indexCount(indices, first, count);
+  drawElements(mode, static_cast<GLsizei>(n),
+               detail::IndexTypeEnum<E>::value,
+               reinterpret_cast<GLvoid const*>(IndexBuffer<E>::offset(first)));
+}
+
+//! Instanced version of drawElements() above. May throw.
+template <typename E> inline
+void drawElementsInstanced(GLenum const mode,
+                           IndexBuffer<E> const& indices,
+                           GLsizei const instanceCount,
+                           std::size_t const first = 0,
+                           std::size_t const count = 0) {
+  std::size_t const n = detail::indexCount(indices, first, count);
+  drawElementsInstanced(
+    mode, static_cast<GLsizei>(n), detail::IndexTypeEnum<E>::value,
+    reinterpret_cast<GLvoid const*>(IndexBuffer<E>::offset(first)),
+    instanceCount);
+}
+
+NDJINN_END_NAMESPACE
+
+#endif // NDJINN_TYPED_BUFFER_HPP_INCLUDED
@@ -8,10 +8,15 @@
 #ifndef NDJINN_VERTEXARRAY_HPP_INCLUDED
 #define NDJINN_VERTEXARRAY_HPP_INCLUDED
 
+#include <algorithm>
 #include <iostream>
 
+#include "nDjinnDeletionQueue.hpp"
+#include "nDjinnDispatch.hpp"
 #include "nDjinnError.hpp"
+#include "nDjinnHandlePool.hpp"
 #include "nDjinnNamespace.hpp"
+#include "nDjinnStateCache.hpp"
 
 NDJINN_BEGIN_NAMESPACE
 
@@ -19,31 +24,63 @@ namespace detail {
 
 //! glGenVertexArrays wrapper. May throw.
 inline void genVertexArrays(GLsizei const n, GLuint *vertexArrays) {
-  glGenVertexArrays(n, vertexArrays);
+  NDJINN_GL(GenVertexArrays)(n, vertexArrays);
   checkError("glGenVertexArrays");
+  StateCache* const cache = StateCache::current();
+  if (cache != nullptr) {
+    // New vertex arrays have no element array buffer.
+    for (GLsizei i = 0; i < n; ++i) {
+      cache->elementArrayBuffers[vertexArrays[i]] = 0;
+    }
+  }
 }
 
 //! glDeleteVertexArrays wrapper. May throw.
 inline void deleteVertexArrays(GLsizei const n, const GLuint *vertexArrays) {
-  glDeleteVertexArrays(n, vertexArrays);
+  NDJINN_GL(DeleteVertexArrays)(n, vertexArrays);
   checkError("glDeleteVertexArrays");
+  StateCache* const cache = StateCache::current();
+  if (cache != nullptr) {
+    for (GLsizei i = 0; i < n; ++i) {
+      if (vertexArrays[i] != 0) {
+        cache->elementArrayBuffers.erase(vertexArrays[i]);
+      }
+    }
+    if (cache->vertexArray.valid() &&
+        cache->vertexArray.value() != 0 &&
+        std::find(vertexArrays, vertexArrays + n,
+                  cache->vertexArray.value()) != vertexArrays + n) {
+      cache->vertexArray.set(0);
+      restoreElementArrayBuffer(0);
+    }
+  }
 }
 
 //! glIsArray wrapper. May throw.
 inline GLboolean isVertexArray(GLuint const vertexArray) {
-  GLboolean const isVertexArray = glIsVertexArray(vertexArray);
+  GLboolean const isVertexArray = NDJINN_GL(IsVertexArray)(vertexArray);
   checkError("glIsVertexArray");
   return isVertexArray;
 }
 
 //! glBindVertexArray wrapper. May throw.
 inline void bindVertexArray(GLuint const vertexArray) {
-  glBindVertexArray(vertexArray);
+  if (skipState(&StateCache::vertexArray, vertexArray,
+                DispatchIndex::BindVertexArray)) {
+    return;
+  }
+  NDJINN_GL(BindVertexArray)(vertexArray);
   checkError("glBindVertexArray");
+  cacheState(&StateCache::vertexArray, vertexArray);
+  restoreElementArrayBuffer(vertexArray);
 }
 
 //! Convenience.
 inline GLuint genVertexArray() {
+  HandlePools* const pools = HandlePools::current();
+  if (pools != nullptr) {
+    return pools->vertexArrays.acquire(&genVertexArrays, &deleteVertexArrays);
+  }
   GLuint handle = 0;
   genVertexArrays(1, &handle);
   return handle;
@@ -51,6 +88,16 @@ inline GLuint genVertexArray() {
 
 //! Convenience.
 inline void deleteVertexArray(GLuint const handle) {
+  HandlePools* const pools = HandlePools::current();
+  if (pools != nullptr) {
+    pools->vertexArrays.release(handle, &deleteVertexArrays);
+    return;
+  }
+  DeletionQueue* const queue = DeletionQueue::current();
+  if (queue != nullptr) {
+    queue->push(&deleteVertexArrays, handle);
+    return;
+  }
   deleteVertexArrays(1, &handle);
 }
 
@@ -68,7 +115,28 @@ public:
   }
 
   ~VertexArray() {
-    detail::deleteVertexArray(_handle);
+    if (_handle != 0) {
+      detail::deleteVertexArray(_handle);
+    }
+  }
+
+  //! Move CTOR, @a rhs is left empty, i.e. with a zero handle.
+  VertexArray(VertexArray&& rhs) noexcept
+    : _handle(rhs._handle)
+  {
+    rhs._handle = 0;
+  }
+
+  //! Move assign, the current resource is deleted and @a rhs left empty.
+  VertexArray& operator=(VertexArray&& rhs) noexcept {
+    if (this != &rhs) {
+      if (_handle != 0) {
+        detail::releaseNoThrow(&detail::deleteVertexArray, _handle);
+      }
+      _handle = rhs._handle;
+      rhs._handle = 0;
+    }
+    return *this;
   }
 
   GLuint handle() const {
@@ -87,7 +155,7 @@ private: // Member variables.
   VertexArray(VertexArray const&); //!< Disabled copy.
   VertexArray& operator=(VertexArray const&); //!< Disabled assign.
 
-  GLuint const _handle;
+  GLuint _handle;
 };
 
 NDJINN_END_NAMESPACE
@@ -8,19 +8,21 @@
 #ifndef NDJINN_VERTEX_ARRAY_ATTRIB_ENABLER_HPP_INCLUDED
 #define NDJINN_VERTEX_ARRAY_ATTRIB_ENABLER_HPP_INCLUDED
 
+#include "nDjinnDispatch.hpp"
+#include "nDjinnError.hpp"
 #include "nDjinnNamespace.hpp"
 
 NDJINN_BEGIN_NAMESPACE
 
 //! glEnableVertexAttribArray wrapper. May throw.
 inline void enableVertexAttribArray(GLuint const index) {
-  glEnableVertexAttribArray(index);
+  NDJINN_GL(EnableVertexAttribArray)(index);
   checkError("glEnableVertexAttribArray");
 }
 
 //! glDisableVertexAttribArray wrapper. May throw.
 inline void disableVertexAttribArray(GLuint const index) {
-  glDisableVertexAttribArray(index);
+  NDJINN_GL(DisableVertexAttribArray)(index);
   checkError("glDisableVertexAttribArray");
 }
 